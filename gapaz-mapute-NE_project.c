@@ -2,27 +2,22 @@
 This is a non-exhaustive algorithm that finds a spanning tree with the maximum number of leaves
 in a given graph. It uses the 2-approximation algorithm by Solis-Oba and a greedy approach to find the maximum leaf spanning tree.
 
-Key Functions:
-- createGraph: Initializes a graph with a given number of vertices.
-- addEdge: Adds an undirected edge between two vertices.
-- DFS: Performs a depth-first search to create an initial spanning tree.
-- computeDegrees: Computes the degree of each vertex in the graph.
-- countLeaves: Counts the number of leaf nodes in the graph.
-- dsu_init: Initializes the disjoint set union data structure.
-- dsu_find: Finds the root of a node in the disjoint set union.
-- dsu_union: Merges two nodes in the disjoint set union.
-- applyExpansion: Applies the 4 expansion rules to find the maximum leaf spanning tree.
+The algorithm lives in libmlst (mlst_approx.c, see mlst.h); this file is its command-line front end:
+it reads the graph, calls mlst_solve_approx and prints the matrices, the forest and local search
+counters and the number of leaves.
 
 Algorithm:
-- The program starts by creating a graph and adding edges to it.
-- It then performs a depth-first search to create an initial spanning tree.
-- The degrees of each vertex are computed.
-- The disjoint set union is initialized to keep track of connected components.
-- The program applies the expansion rules to find the maximum leaf spanning tree.
+- The program starts by building the graph from its edge list.
+- It then grows a maximally leafy forest: trees start at vertices with >= 3 uncovered neighbours
+  and grow by the expansion rules, with bucket queues picking the next vertex in O(1).
+- The disjoint set union joins the forest trees and the remaining vertices in three tiers of edges.
+- The degrees and leaves of the resulting spanning tree are computed. Total time O(E α(V)).
 
 Usage:
 - Edit the test cases in the main function to try different graphs.
 - Run the program to see all valid spanning trees and the one with the most leaves.
+- --updates FILE then applies edge changes ("+ u v", "- u v", batches separated by blank lines) to the
+  tree and repairs it locally after each one (mlst_dynamic_update), printing the leaves after each batch.
 
 Note:
     A 2-approximation algorithm guarantees that the solution will be at most half of the optimal solution.
@@ -38,175 +33,187 @@ Cons:
     - The algorithm is not exhaustive, so it may miss some valid spanning trees.
 */
 
-
-/*
-2-approximation algorithm for the maximum leaf spanning tree problem (Solis-Oba)
-*/
-
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <time.h> 
-
-#define MAX_NODES 100
-
-typedef struct Node {
-    int vertex;
-    struct Node* next;
-} Node;
-
-typedef struct {
-    Node* head;
-} AdjList;
-
-typedef struct {
-    int V;
-    AdjList* array;
-} Graph;
-
-typedef struct {
-    int u, v;
-} Edge;
-
-bool visited[MAX_NODES];
-int parent[MAX_NODES];
-int degree[MAX_NODES];
-int dsu_parent[MAX_NODES];
-Graph* dfsTree;
-
-//creates a graph with V vertices and initializes the adjacency list with NULL values
-//Time: O(V)
-Graph* createGraph(int V) {
-    Graph* graph = malloc(sizeof(Graph));
-    graph->V = V;
-    graph->array = malloc(V * sizeof(AdjList));
-    for (int i = 0; i < V; i++)
-        graph->array[i].head = NULL;
-    return graph;
-}
+#include <string.h>
+#include <unistd.h>
 
-//adds an undirected edge between vertices u and v
-//Time: O(1)
-void addEdge(Graph* graph, int u, int v) {
-    Node* node = malloc(sizeof(Node));
-    node->vertex = v;
-    node->next = graph->array[u].head;
-    graph->array[u].head = node;
-
-    node = malloc(sizeof(Node));
-    node->vertex = u;
-    node->next = graph->array[v].head;
-    graph->array[v].head = node;
-}
+#include "mlst.h"
 
+#define MATRIX_PRINT_LIMIT 100 //adjacency matrices are only printed up to this many vertices
 
-// perform DFS for creating the initial spanning tree
-//Time: O(V + E)
-void DFS(Graph* graph, int u) {
-    visited[u] = true;
-    Node* temp = graph->array[u].head;
-    while (temp != NULL) {
-        int v = temp->vertex;
-        if (!visited[v]) {
-            parent[v] = u;
-            addEdge(dfsTree, u, v);
-            DFS(graph, v);
-        }
-        temp = temp->next;
-    }
-}
-
+//O(V * E) - this was disregarded in the analysis of the time complexity since these are just additional functions for the presentation 
+//only called for small graphs (V <= MATRIX_PRINT_LIMIT); one row is built at a time
+void printAdjMatrix(const Edge* edges, int m, int V, const char* label) {
+    int* row = malloc(V * sizeof(int));
+    if (!row)
+        return;
 
-//compute the degree of each vertex in the graph
-// O(V + E)
-void computeDegrees(Graph* g, int V) {
+    printf("\n%s\n", label);
+    printf("   ");
+    for (int i = 0; i < V; i++) printf("%d ", i);
+    printf("\n");
     for (int i = 0; i < V; i++) {
-        degree[i] = 0;
-        Node* cur = g->array[i].head;
-        while (cur) {
-            degree[i]++;
-            cur = cur->next;
+        memset(row, 0, V * sizeof(int));
+        for (int j = 0; j < m; j++) {
+            if (edges[j].u == i)
+                row[edges[j].v] = 1;
+            if (edges[j].v == i)
+                row[edges[j].u] = 1;
         }
+        printf("%d: ", i);
+        for (int j = 0; j < V; j++)
+            printf("%d ", row[j]);
+        printf("\n");
     }
+    free(row);
 }
 
-//count the number of leaf nodes (degree 1) in the graph
-// O(V)
-int countLeaves(Graph* g, int V) {
-    int count = 0;
-    for (int i = 0; i < V; i++)
-        if (degree[i] == 1)
-            count++;
-    return count;
-}
-
-//initializes an instance of the disjoint set union data struc
-void dsu_init(int V) {
-    for (int i = 0; i < V; i++)
-        dsu_parent[i] = i;
-}
-
-//find the a direct connection from a root to a leaf
-int dsu_find(int u) {
-    if (dsu_parent[u] != u)
-        dsu_parent[u] = dsu_find(dsu_parent[u]);
-    return dsu_parent[u];
-}
-
-//merges a root to leaf edge while maintaining connectivity
-void dsu_union(int u, int v) {
-    int ru = dsu_find(u);
-    int rv = dsu_find(v);
-    if (ru != rv)
-        dsu_parent[rv] = ru;
-}
+//applies the edge changes in the file at path to the tree of graph, a batch at a time: "+ u v" adds an edge,
+//"- u v" removes one, and a blank line (or the end of the file) ends a batch; lines starting with # are skipped
+//the tree is repaired locally after every change, and the leaves are printed after every batch
+//returns 0 on success, 1 if the file cannot be read or a change cannot be applied
+static int applyUpdates(const MlstGraph* graph, const Edge* tree, int treeEdges, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    MlstDynamic* dynamic = NULL;
+    int status = mlst_dynamic_create(graph, tree, treeEdges, &dynamic);
+    if (status != MLST_OK) {
+        fprintf(stderr, "Cannot keep the tree up to date: %s\n", mlst_error_string(status));
+        fclose(f);
+        return 1;
+    }
 
-//application of the 4 expansion rules
-//O(V + E)
-void applyExpansion(Graph* original, Graph* tree, int V) {
-    for (int u = 0; u < V; u++) {
-        if (degree[u] >= 3) { //priority is degree >= 3 nodes
-            Node* temp = original->array[u].head;
-            while (temp) {
-                int v = temp->vertex;
-                if (dsu_find(u) != dsu_find(v)) { //makes sure that adding u and v do not form a cycle
-                    addEdge(tree, u, v); //makes sure that u and v do not form a cycle
-                    dsu_union(u, v);  //connects u and v
+    MlstEdgeUpdate* batch = NULL;
+    int count = 0, capacity = 0, batches = 0, lineNumber = 0, failed = 0;
+    char line[256];
+    bool more = true;
+    printf("\nUpdates from %s:\n", path);
+    while (more && !failed) {
+        more = fgets(line, sizeof(line), f) != NULL;
+        lineNumber += more;
+        char sign;
+        int u, v;
+        if (more && line[0] == '#')
+            continue;
+        if (more && sscanf(line, " %c %d %d", &sign, &u, &v) == 3 && (sign == '+' || sign == '-')) {
+            if (count == capacity) {
+                capacity = capacity ? 2 * capacity : 64;
+                MlstEdgeUpdate* grown = realloc(batch, capacity * sizeof(MlstEdgeUpdate));
+                if (!grown) {
+                    fprintf(stderr, "Out of memory\n");
+                    failed = 1;
+                    break;
                 }
-                temp = temp->next;
+                batch = grown;
             }
+            batch[count].u = u;
+            batch[count].v = v;
+            batch[count].insert = sign == '+';
+            count++;
+            continue;
+        }
+        if (more && strspn(line, " \t\r\n") != strlen(line)) {
+            fprintf(stderr, "%s:%d: expected \"+ u v\" or \"- u v\"\n", path, lineNumber);
+            failed = 1;
+            break;
+        }
+        if (count == 0)
+            continue;
+
+        //a blank line or the end of the file: apply the batch
+        MlstDynamicStats stats;
+        double batchStart = mlst_seconds();
+        status = mlst_dynamic_update(dynamic, batch, count, &stats);
+        double batchTime = mlst_seconds() - batchStart;
+        batches++;
+        if (status != MLST_OK) {
+            MlstEdgeUpdate* bad = &batch[stats.applied];
+            fprintf(stderr, "Batch %d: change %c %d %d cannot be applied (%s: no such edge or vertex)\n", batches,
+                    bad->insert ? '+' : '-', bad->u, bad->v, mlst_error_string(status));
+            failed = 1;
+            break;
         }
+        printf("Batch %d: %d changes, %d leaves, %d tree edges (%d reconnected across a cut, %d cuts left open, "
+               "%d trees joined, %d swaps, %lld vertices searched) in %f seconds\n",
+               batches, count, mlst_dynamic_leaves(dynamic), mlst_dynamic_tree(dynamic, NULL), stats.replaced,
+               stats.split, stats.joined, stats.swaps, stats.visited, batchTime);
+        count = 0;
     }
+    free(batch);
+    fclose(f);
+    mlst_dynamic_destroy(dynamic);
+    return failed;
 }
 
-//O(V^2) - this was disregarded in the analysis of the time complexity since these are just additional functions for the presentation 
-void printAdjMatrix(Graph* g, int V, const char* label) {
-    int mat[MAX_NODES][MAX_NODES] = {0};
-    for (int i = 0; i < V; i++) {
-        Node* temp = g->array[i].head;
-        while (temp) {
-            mat[i][temp->vertex] = 1;
-            temp = temp->next;
+int main(int argc, char *argv[]) {
+    double start, loaded, built, solved, end; //monotonic clock: input, build, solve and output phases
+    const char *input_path = NULL;
+    const char *cachePath = NULL;
+    const char *updatesPath = NULL;
+    GraphReadOptions read_options = {GRAPH_FORMAT_AUTO, 0, 0, 0};
+    bool verify = false;
+    int statsMode = 0; //0 = off, 1 = text, 2 = JSON
+    MlstApproxOptions options;
+    mlst_approx_options_init(&options);
+
+    //read the command-line options (a graph file replaces the test case below)
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc && graph_format_from_name(argv[i + 1]) >= 0) {
+            read_options.format = graph_format_from_name(argv[++i]);
+        } else if (strcmp(argv[i], "--drop-self-loops") == 0) {
+            read_options.drop_self_loops = true;
+        } else if (strcmp(argv[i], "--dedupe") == 0) {
+            read_options.drop_duplicates = true;
+        } else if (strcmp(argv[i], "--relabel") == 0) {
+            read_options.relabel = true;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "--improve") == 0) {
+            options.improve = true;
+        } else if (strcmp(argv[i], "--improve-time") == 0 && i + 1 < argc) {
+            options.improve_time = atof(argv[++i]);
+            options.improve = true;
+        } else if (strcmp(argv[i], "--improve-iterations") == 0 && i + 1 < argc) {
+            options.improve_iterations = atoll(argv[++i]);
+            options.improve = true;
+        } else if (strcmp(argv[i], "--starts") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            options.starts = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+            if (options.threads <= 0)
+                options.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+            if (options.threads <= 0)
+                options.threads = 1;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--kernelize") == 0) {
+            options.kernelize = true;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if (strcmp(argv[i], "--updates") == 0 && i + 1 < argc) {
+            updatesPath = argv[++i];
+        } else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0) {
+            statsMode = 1;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            statsMode = 2;
+        } else {
+            printf("Usage: %s [--input FILE [--format auto|edgelist|dimacs|metis] [--dedupe] [--drop-self-loops] [--relabel]]\n"
+                   "          [--verify] [--improve [--improve-time S] [--improve-iterations N]]\n"
+                   "          [--starts N [--threads T] [--seed S]] [--kernelize] [--cache FILE] [--stats[=json]]\n"
+                   "          [--updates FILE]\n",
+                   argv[0]);
+            return 1;
         }
     }
 
-    printf("\n%s\n", label);
-    printf("   ");
-    for (int i = 0; i < V; i++) printf("%d ", i);
-    printf("\n");
-    for (int i = 0; i < V; i++) {
-        printf("%d: ", i);
-        for (int j = 0; j < V; j++)
-            printf("%d ", mat[i][j]);
-        printf("\n");
-    }
-}
-
-int main() {
-    clock_t start, end;
-    double cpu_time_used;
-
-    start = clock();  // Start timing
+    start = mlst_seconds();  // Start timing (reading the input)
 
 
     /* Test Cases*/
@@ -331,39 +338,113 @@ int main() {
         {2,29}
     };
     int m = sizeof(edges)/sizeof(edges[0]);
-
-    Graph* graph = createGraph(N); 
-    dfsTree = createGraph(N); //create an empty spanning tree
-
-    //build the original graph    
-    for (int i = 0; i < m; i++)
-        addEdge(graph, edges[i].u, edges[i].v);
-
-    //create the initial spanning tree using DFS
-    DFS(graph, 0);
-    computeDegrees(dfsTree, N); //get the degree of each vertex in the DFS
-    dsu_init(N);//initialize the disjoint set union data struc
-
-    //combine all the connected components (if there is direct path between root and leaf)
-    for (int i = 0; i < N; i++) {
-        Node* temp = dfsTree->array[i].head;
-        while (temp) {
-            if (i < temp->vertex)
-                dsu_union(i, temp->vertex);
-            temp = temp->next;
+    Edge* edgeList = edges;
+    int V = N;
+
+    GraphInput input = {0};
+    if (input_path) {
+        if (read_graph_file(input_path, &read_options, &input) != 0)
+            return 1;
+        if (input.n < 1) {
+            fprintf(stderr, "%s has no vertices\n", input_path);
+            free_graph_input(&input);
+            return 1;
         }
+        edgeList = input.edges;
+        V = input.n;
+        m = input.m;
     }
 
-    applyExpansion(graph, dfsTree, N);
-    computeDegrees(dfsTree, N);
-    int leaves = countLeaves(dfsTree, N);
+    loaded = mlst_seconds();
+    MlstGraph* graph = mlst_graph_create(V); //build the original graph
+    MlstSolver* solver = mlst_solver_create();
+    Edge* tree = malloc(V * sizeof(Edge));
+    if (!graph || !solver || !tree || mlst_graph_add_edges(graph, edgeList, m) != MLST_OK) {
+        fprintf(stderr, "Cannot build the graph (out of memory or an edge with a vertex outside 0..%d)\n", V - 1);
+        return 1;
+    }
 
-    printAdjMatrix(graph, N, "Original Graph (K5):");
-    printAdjMatrix(dfsTree, N, "Approximate Spanning Tree:");
-    printf("\nNumber of Leaves: %d\n", leaves);
+    //a tree stored for an identical or isomorphic graph is reused instead of solving
+    MlstCache* cache = NULL;
+    if (cachePath && mlst_cache_open(cachePath, &cache) != MLST_OK) {
+        fprintf(stderr, "Cannot open cache %s (not a cache file, or not writable)\n", cachePath);
+        return 1;
+    }
+    options.cache = cache;
+
+    //run every start (one start = the plain approximation) and keep the best tree
+    built = mlst_seconds();
+    MlstResult result;
+    int status = mlst_solve_approx(solver, graph, &options, tree, &result);
+    solved = mlst_seconds();
+    if (status != MLST_OK) {
+        fprintf(stderr, "Approximation failed: %s\n", mlst_error_string(status));
+        return 1;
+    }
+    int leaves = result.leaves;
+
+    if (V <= MATRIX_PRINT_LIMIT) {
+        printAdjMatrix(edgeList, m, V, "Original Graph:");
+        printAdjMatrix(tree, result.tree_edges, V, "Approximate Spanning Tree:");
+    } else {
+        printf("Graph: %d vertices, %d edges (adjacency matrices are only printed up to %d vertices)\n",
+               V, m, MATRIX_PRINT_LIMIT);
+    }
+    if (options.starts > 1)
+        printf("\nBest of %d starts (seed %llu, %d threads): start %d\n", options.starts, options.seed,
+               options.threads < options.starts ? options.threads : options.starts, result.approx.start);
+    if (result.cache.hit) {
+        printf("\nCache: hit in %s, %s tree reused (%f seconds)\n", cachePath,
+               result.optimal ? "proven optimal" : "stored", result.cache.seconds);
+    } else {
+        if (cache)
+            printf("\nCache: miss in %s, result %s%s (%f seconds)\n", cachePath,
+                   result.cache.stored ? "stored" : "not stored",
+                   result.cache.canonical ? "" : ", graph too large or symmetric to label canonically",
+                   result.cache.seconds);
+        if (options.kernelize)
+            printf("\nKernel: %d chain vertices removed, %d vertices and %d edges left\n",
+                   result.kernel.contracted, result.kernel.max_nodes, result.kernel.max_edges);
+        printf("\nLeafy forest: %d vertices, %d edges, %d leaves\n",
+               result.approx.forest_vertices, result.approx.forest_edges, result.approx.forest_leaves);
+    }
+    if (options.improve && !result.cache.hit) {
+        printf("Local search: %d -> %d leaves, %lld swaps out of %lld candidates in %d passes (%s)\n",
+               result.approx.leaves_before, leaves, result.approx.ls_swaps, result.approx.ls_evaluated,
+               result.approx.ls_passes, result.approx.ls_budget_hit ? "budget reached" : "local optimum");
+    }
+    printf("Number of Leaves: %d\n", leaves);
+    //upper bounds on the optimum: a gap of 0 means the approximation is already optimal
+    if (result.tree_edges == V - 1) {
+        printf("Upper bound: %d leaves (star %d, degree %d, domination %d", result.bounds.upper,
+               result.bounds.star, result.bounds.degree, result.bounds.domination);
+        if (result.bounds.approx >= 0)
+            printf(", twice the approximation %d", result.bounds.approx);
+        printf("), gap %d%s\n", result.bounds.upper - leaves,
+               result.bounds.upper == leaves ? ": the tree is optimal" : "");
+    }
+    if (verify && result.cache.hit) {
+        printf("Verify: the tree came from the cache, no leafy forest to check\n");
+    } else if (verify) {
+        if (!mlst_verify_approx(solver, graph, tree, result.tree_edges, stdout))
+            return 2;
+        printf("Verified: spanning tree of the graph, leafy forest is maximal (2-approximation guarantee holds)\n");
+    }
 
-    end = clock();  // End timing
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("Time taken: %f seconds\n", cpu_time_used);
+    end = mlst_seconds();  // End timing (wall clock: the starts may run on several threads)
+    printf("Time taken: %f seconds (solve only, wall clock)\n", solved - built);
+    printf("Phases: input %f, build %f, solve %f, output %f seconds\n", loaded - start, built - loaded, solved - built,
+           end - solved);
+    //phase times and counters of the approximation (zero unless built with make STATS=1)
+    if (statsMode)
+        mlst_write_stats(stdout, &result, built - start, end - solved, statsMode == 2);
+    //keep the tree up to date while the graph changes, without solving again
+    if (updatesPath && applyUpdates(graph, tree, result.tree_edges, updatesPath) != 0)
+        return 1;
+    free(tree);
+    mlst_solver_destroy(solver);
+    mlst_cache_close(cache);
+    mlst_graph_destroy(graph);
+    free_graph_input(&input);
     return 0;
 }
@@ -18,113 +18,44 @@ Main Steps:
 Usage:
 - Edit the test cases in main() to try different graphs
 - Run the program to see all valid spanning trees and the one with the most leaves
+
+The search itself lives in libmlst (mlst_exact.c, see mlst.h): this file only reads the graph,
+prints the trace and the result, and handles the command-line options.
 */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
-
-#define MAX_NODES 30
-#define MAX_EDGES 40
-
-typedef struct {
-    int u, v;
-} Edge;
-
-// These help check if a set of edges forms a connected tree (no cycles, all nodes connected)
-// Each node starts as its own parent. 'find' locates the root of a node's set.
-int find(int x, int parent[]) {
-    // No loop here, just recursion
-    if (parent[x] != x)
-        parent[x] = find(parent[x], parent); // Path compression for efficiency
-    return parent[x];
-}
-
-// 'unite' joins two sets (nodes x and y) together
-void unite(int x, int y, int parent[], int rank[]) {
-    int rootX = find(x, parent);
-    int rootY = find(y, parent);
-    // Only unite if roots are different (to avoid cycles)
-    if (rootX != rootY) {
-        // Attach smaller tree to larger tree for efficiency
-        if (rank[rootX] < rank[rootY])
-            parent[rootX] = rootY;
-        else
-            parent[rootY] = rootX;
-        // If ranks are equal, increase the rank
-        if (rank[rootX] == rank[rootY])
-            rank[rootX]++;
-    }
-}
+#include <limits.h>
+#include <unistd.h>
 
-// Check if the combination of edges forms a connected graph
-// Returns 1 if all nodes are connected (i.e., the edges form a spanning tree), 0 otherwise
-int is_connected(Edge *combo, int k, int n) {
-    int parent[MAX_NODES], rank[MAX_NODES];
-    // Loop to initialize each node's parent and rank
-    for (int i = 0; i < n; i++) {
-        parent[i] = i;
-        rank[i] = 0;
-    }
-
-    // Loop through all edges in the combination to unite their nodes
-    for (int i = 0; i < k; i++) {
-        Edge e = combo[i];
-        unite(e.u, e.v, parent, rank);
-    }
+#include "mlst.h"
 
-    int root = find(0, parent);
-    // Loop to check if all nodes are connected to the same root
-    for (int i = 1; i < n; i++) {
-        if (find(i, parent) != root)
-            return 0; // Found a node not connected to the root
-    }
-    return 1; // All nodes are connected
-}
+#define MAX_NODES MLST_EXACT_MAX_NODES
+#define MAX_EDGES MLST_EXACT_MAX_EDGES
 
-// Count number of leaf nodes (nodes with degree 1) in the current tree
-// Returns the number of leaves
-int count_leaves(Edge *combo, int k, int n) {
-    int degree[MAX_NODES] = {0};
-    // Loop through all edges to count the degree of each node
-    for (int i = 0; i < k; i++) {
-        degree[combo[i].u]++;
-        degree[combo[i].v]++;
-    }
+// Output levels (--verbosity): silent prints nothing on stdout, summary prints the counts,
+// best tree and search time, trace also prints every spanning tree and every improvement
+enum { VERBOSITY_SILENT, VERBOSITY_SUMMARY, VERBOSITY_TRACE };
+int verbosity = VERBOSITY_TRACE;
 
-    int count = 0;
-    // Loop through all nodes to count how many have degree 1 (leaves)
-    for (int i = 0; i < n; i++) {
-        if (degree[i] == 1) // Leaf node has degree 1
-            count++;
-    }
-    return count;
-}
 
 // Print the current combination of edges and its leaf count
-// Also prints the degree of each node in this tree
-void print_combo_and_leaf_count(Edge *combo, int k, int n, int is_best) {
+// Also prints the degree of each node in this tree (degree and leaves are the ones the search
+// already maintains, so nothing is recomputed just for printing)
+void print_combo_and_leaf_count(const Edge *combo, int k, int n, const int *degree, int leaves, int is_best) {
     printf("Combination: ");
     // Loop to print all edges in the current combination
     for (int i = 0; i < k; i++) {
         printf("(%d-%d) ", combo[i].u, combo[i].v);
     }
 
-    int degree[MAX_NODES] = {0};
-    // Loop to count the degree of each node in the current combination
-    for (int i = 0; i < k; i++) {
-        degree[combo[i].u]++;
-        degree[combo[i].v]++;
-    }
-
     printf(" | Degrees: ");
     // Loop to print the degree of each node
     for (int i = 0; i < n; i++) {
         printf("%d:%d ", i, degree[i]);
     }
 
-    int leaves = count_leaves(combo, k, n);
     printf(" | Leaves: %d", leaves);
 
     if (is_best) {
@@ -134,55 +65,24 @@ void print_combo_and_leaf_count(Edge *combo, int k, int n, int is_best) {
     printf("\n");
 }
 
-// Global storage for best tree
-Edge best_tree[MAX_EDGES];
-int best_leaf_count = 0;
-
-// Recursive function to generate all combinations of k edges from the list of edges
-// For each combination, checks if it forms a valid spanning tree and updates the best tree if needed
-/**
- * Generates all possible combinations of k edges from a given set of m edges.
- *
- * @param edges   Pointer to the array of all available edges.
- * @param m       Total number of available edges in the edges array.
- * @param k       Number of edges to select for each combination.
- * @param n       Total number of vertices in the graph (may be used for validation or further processing).
- * @param start   Current starting index in the edges array for combination generation.
- * @param current Pointer to the array holding the current combination of edges being constructed.
- * @param cpos    Current position in the current combination array to insert the next edge.
- */
-void generate_combinations(Edge *edges, int m, int k, int n, int start, Edge *current, int cpos) {
-    // Step 1: Base case - if we've picked k edges, process this combination
-    if (cpos == k) {
-        // Step 2: Check if the current combination forms a valid spanning tree
-        if (is_connected(current, k, n)) {
-            int leaves = count_leaves(current, k, n);
-            static int combo_index = 1;
-            printf("Valid Spanning Tree #%d | Leaves: %d\n", combo_index++, leaves);
-            print_combo_and_leaf_count(current, k, n, 0);
-
-            // Step 3: If this tree has more leaves than the best so far, update the best
-            if (leaves > best_leaf_count) {
-                best_leaf_count = leaves;
-                memcpy(best_tree, current, k * sizeof(Edge));
-                printf("  [New Best Tree Found]\n");
-            }
-        }
-        // Step 4: Return to stop further recursion for this combination
-        return;
-    }
+// Trace callback of the exhaustive search: one line per spanning tree
+void trace_tree(void *user, long long index, const Edge *tree, int k, const int *degree, int leaves) {
+    (void)user;
+    printf("Valid Spanning Tree #%lld | Leaves: %d\n", index, leaves);
+    print_combo_and_leaf_count(tree, k, k + 1, degree, leaves, 0);
+}
 
-    // Step 5: Recursive case - try each possible edge at the current position
-    for (int i = start; i < m; i++) {
-        current[cpos] = edges[i]; // Place edge at current position
-        // Step 6: Recurse to fill the next position in the combination
-        generate_combinations(edges, m, k, n, i + 1, current, cpos + 1);
-    }
+// Trace callback for a new best tree (user points to the search method)
+void trace_improve(void *user, int leaves) {
+    if (*(const MlstExactMethod *)user == MLST_EXACT_ENUMERATE)
+        printf("  [New Best Tree Found]\n");
+    else
+        printf("  [New Best Tree Found] Leaves: %d\n", leaves);
 }
 
 // Print the adjacency matrix of the best spanning tree found
 // Shows which nodes are connected in the best tree
-void print_adjacency_matrix(int n) {
+void print_adjacency_matrix(const Edge *best_tree, int n) {
     int matrix[MAX_NODES][MAX_NODES] = {0};
 
     // Loop through all edges in the best tree to fill the adjacency matrix
@@ -211,7 +111,11 @@ void print_adjacency_matrix(int n) {
 
 // Print the best spanning tree found (with the most leaves)
 // Shows the edges and the degree of each node in the best tree
-void print_best_tree(int n) {
+void print_best_tree(const Edge *best_tree, int best_leaf_count, int n) {
+    if (best_leaf_count < 0) {
+        printf("\nNo spanning tree found.\n");
+        return;
+    }
     printf("\nFinal Best Spanning Tree with %d leaves:\n", best_leaf_count);
     printf("Edges: ");
     // Loop to print all edges in the best tree
@@ -220,7 +124,9 @@ void print_best_tree(int n) {
     }
     printf("\n");
 
-    int degree[MAX_NODES] = {0};
+    int *degree = calloc(n, sizeof(int));
+    if (!degree)
+        return;
     // Loop through all edges in the best tree to count degrees for each node
     for (int i = 0; i < n - 1; i++) {
         degree[best_tree[i].u]++;
@@ -233,9 +139,138 @@ void print_best_tree(int n) {
         printf("%d:%d ", i, degree[i]);
     }
     printf("\n");
+    free(degree);
 }
 
-int main() {
+// Print the command-line options
+void print_usage(const char *prog) {
+    printf("Usage: %s [--gray | --bnb | --cds] [--threads N] [--shard I/N [--out FILE]] [--time-limit S]\n"
+           "          [--checkpoint FILE [--checkpoint-interval S]] [--resume FILE]\n"
+           "          [--verbosity silent|summary|trace] [--input FILE [--format F] [--dedupe]\n"
+           "          [--drop-self-loops] [--relabel]] [--kernelize] [--symmetry] [--stats[=json]]\n"
+           "          [--cache FILE] [--merge FILE...]\n", prog);
+    printf("  --gray                  exhaustive search in revolving-door order (one edge swapped per step)\n");
+    printf("  --bnb                   exact branch-and-bound search (prunes cycles, dead ends and hopeless branches)\n");
+    printf("  --cds                   exact search for a minimum connected dominating set (node sets, no edge limit)\n");
+    printf("  --threads N             run the branch-and-bound search on N threads (0 = all cores, implies --bnb)\n");
+    printf("  --shard I/N             search only the I-th of N equal rank ranges (I = 0..N-1, implies --bnb)\n");
+    printf("  --out FILE              where --shard writes its result (default shard-I-of-N.txt)\n");
+    printf("  --time-limit S          stop after S seconds with the best tree so far (implies --bnb unless --cds)\n");
+    printf("  --checkpoint FILE       save the search position and best tree to FILE (implies --bnb)\n");
+    printf("  --checkpoint-interval S seconds between checkpoints (default 60)\n");
+    printf("  --resume FILE           continue the search saved in checkpoint FILE (keeps checkpointing to it)\n");
+    printf("  --verbosity LEVEL       silent, summary (counts, best tree, search time) or trace (default, every tree)\n");
+    printf("  --input FILE            read the graph from FILE (\"-\" = stdin) instead of the built-in test case\n");
+    printf("  --format F              auto (default), edgelist (0-based \"u v\" lines), dimacs or metis\n");
+    printf("  --dedupe                drop repeated edges (in either direction)\n");
+    printf("  --drop-self-loops       drop edges from a node to itself\n");
+    printf("  --relabel               renumber the nodes that occur in edges to 0..n-1\n");
+    printf("  --kernelize             solve each biconnected block separately after shortening degree-2 chains\n"
+           "                          (lifts the node/edge limits to each block; no per-tree trace, shards or checkpoints)\n");
+    printf("  --symmetry              exhaustive search: skip trees that swapping two twin nodes maps to an earlier\n"
+           "                          tree (same best tree; --bnb always does this)\n");
+    printf("  --stats[=json]          report phase times and search counters after the result (text or one JSON\n"
+           "                          object; the counters are only filled in a build made with make STATS=1)\n");
+    printf("  --cache FILE            reuse the proven-optimal tree of an identical or isomorphic graph stored in\n"
+           "                          FILE, or store this search's result there (created if missing)\n");
+    printf("  --merge FILE...         combine shard result files into the final answer\n");
+}
+
+int main(int argc, char *argv[]) {
+    int use_bnb = 0;
+    int use_gray = 0;
+    int use_cds = 0;
+    int num_threads = 1;
+    int shard = -1, num_shards = 0;
+    const char *shard_out = NULL;
+    int merge_first = 0;
+    double time_limit = 0, checkpoint_interval = 60;
+    const char *checkpoint_path = NULL;
+    const char *resume_path = NULL;
+    const char *input_path = NULL;
+    const char *cache_path = NULL;
+    int kernelize = 0;
+    int symmetry = 0;
+    int stats_mode = 0; // 0 = off, 1 = text, 2 = JSON
+    GraphReadOptions read_options = {GRAPH_FORMAT_AUTO, 0, 0, 0};
+    // Loop through the command-line options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bnb") == 0) {
+            use_bnb = 1;
+        } else if (strcmp(argv[i], "--gray") == 0) {
+            use_gray = 1;
+        } else if (strcmp(argv[i], "--cds") == 0) {
+            use_cds = 1;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+            if (num_threads <= 0)
+                num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+            if (num_threads <= 0)
+                num_threads = 1;
+            use_bnb = 1;
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc &&
+                   sscanf(argv[i + 1], "%d/%d", &shard, &num_shards) == 2 &&
+                   num_shards > 0 && shard >= 0 && shard < num_shards) {
+            i++;
+            use_bnb = 1;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            shard_out = argv[++i];
+        } else if (strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc && (time_limit = atof(argv[i + 1])) > 0) {
+            i++;
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint_path = argv[++i];
+            use_bnb = 1;
+        } else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc &&
+                   (checkpoint_interval = atof(argv[i + 1])) > 0) {
+            i++;
+        } else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            resume_path = argv[++i];
+            use_bnb = 1;
+        } else if (strcmp(argv[i], "--verbosity") == 0 && i + 1 < argc) {
+            const char *level = argv[++i];
+            if (strcmp(level, "silent") == 0) {
+                verbosity = VERBOSITY_SILENT;
+            } else if (strcmp(level, "summary") == 0) {
+                verbosity = VERBOSITY_SUMMARY;
+            } else if (strcmp(level, "trace") == 0) {
+                verbosity = VERBOSITY_TRACE;
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc && graph_format_from_name(argv[i + 1]) >= 0) {
+            read_options.format = graph_format_from_name(argv[++i]);
+        } else if (strcmp(argv[i], "--drop-self-loops") == 0) {
+            read_options.drop_self_loops = 1;
+        } else if (strcmp(argv[i], "--dedupe") == 0) {
+            read_options.drop_duplicates = 1;
+        } else if (strcmp(argv[i], "--relabel") == 0) {
+            read_options.relabel = 1;
+        } else if (strcmp(argv[i], "--kernelize") == 0) {
+            kernelize = 1;
+        } else if (strcmp(argv[i], "--symmetry") == 0) {
+            symmetry = 1;
+        } else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0) {
+            stats_mode = 1;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            stats_mode = 2;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_path = argv[++i];
+        } else if (strcmp(argv[i], "--merge") == 0 && i + 1 < argc) {
+            merge_first = i + 1; // Everything after --merge is a shard file
+            break;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // A time limit belongs to the branch-and-bound search unless the dominating set search was asked for
+    if (time_limit > 0 && !use_cds)
+        use_bnb = 1;
+
     // Test cases for different types of graphs are provided below.
     // Uncomment the test case you want to run, or add your own.
     // Each test case shows the expected maximum number of leaves for that graph.
@@ -362,26 +397,324 @@ int main() {
     };
     int m = sizeof(edges)/sizeof(edges[0]);
 
-    Edge current_combo[MAX_NODES];  // Temporary array to store current combination of edges
 
-    printf("Exhaustive Search: Evaluating All Possible Spanning Trees\n");
-    printf("----------------------------------------------------------\n");
 
-    // add start timer
-    clock_t start_time = clock();
-    // Try all possible combinations of N-1 edges
-    generate_combinations(edges, m, N - 1, N, 0, current_combo, 0);
-    clock_t end_time = clock();
+    // A graph file given with --input replaces the test case above
+    double load_start = mlst_seconds(); // Reading and building the graph, reported by --stats
+    Edge *edge_list = edges;
+    int n = N;
+    GraphInput input = {0};
+    if (input_path) {
+        if (read_graph_file(input_path, &read_options, &input) != 0)
+            return 1;
+        if (input.n < 1) {
+            fprintf(stderr, "%s has no nodes\n", input_path);
+            free_graph_input(&input);
+            return 1;
+        }
+        if (!kernelize && (input.n > MAX_NODES || (input.m > MAX_EDGES && !use_cds))) {
+            fprintf(stderr, "%s has %d nodes and %d edges: the exact search handles at most %d nodes and %d edges\n",
+                    input_path, input.n, input.m, MAX_NODES, MAX_EDGES);
+            free_graph_input(&input);
+            return 1;
+        }
+        edge_list = input.edges;
+        n = input.n;
+        m = input.m;
+        if (verbosity >= VERBOSITY_SUMMARY) {
+            printf("Read %s: %d nodes, %d edges", input_path, n, m);
+            if (input.self_loops_dropped || input.duplicates_dropped)
+                printf(" (dropped %lld self-loops, %lld duplicate edges)",
+                       input.self_loops_dropped, input.duplicates_dropped);
+            printf("\n");
+        }
+        if (input.labels && verbosity >= VERBOSITY_TRACE) {
+            printf("Relabeled nodes (new:original): ");
+            // Loop to print the original id of every node
+            for (int i = 0; i < n; i++)
+                printf("%d:%lld ", i, input.labels[i]);
+            printf("\n");
+        }
+    }
+
+    MlstGraph *graph = mlst_graph_create(n);
+    if (!graph || mlst_graph_add_edges(graph, edge_list, m) != MLST_OK) {
+        fprintf(stderr, "Cannot build the graph: edge with a node outside 0..%d\n", n - 1);
+        return 1;
+    }
+    Edge *best_tree = malloc((n > 1 ? n - 1 : 1) * sizeof(Edge)); // Best spanning tree found
+    if (!best_tree) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    int best_leaf_count = -1;
+    double load_time = mlst_seconds() - load_start;
+
+    // Trace output is one line per tree: write it through a large buffer instead of line by line
+    static char stdout_buffer[1 << 20];
+    setvbuf(stdout, stdout_buffer, _IOFBF, sizeof(stdout_buffer));
+
+    if (merge_first > 0) {
+        // Combine the results of a sharded run instead of searching
+        long long trees = 0;
+        if (mlst_merge_shards(argv + merge_first, argc - merge_first, graph, best_tree, &best_leaf_count, &trees) != 0)
+            return 1;
+        if (verbosity >= VERBOSITY_SUMMARY) {
+            printf("Merged %d shard results: %lld spanning trees reached.\n", argc - merge_first, trees);
+            print_best_tree(best_tree, best_leaf_count, n);
+        }
+        if (verbosity >= VERBOSITY_TRACE && best_leaf_count >= 0 && n <= MAX_NODES)
+            print_adjacency_matrix(best_tree, n);
+        return 0;
+    }
+
+    if (use_gray + use_bnb + use_cds > 1 || (kernelize && (shard >= 0 || checkpoint_path || resume_path))) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Everything the search needs besides the graph: the method, run control and trace callbacks
+    MlstExactOptions options;
+    mlst_exact_options_init(&options);
+    options.method = use_gray ? MLST_EXACT_GRAY
+                   : use_cds  ? MLST_EXACT_CDS
+                   : use_bnb  ? MLST_EXACT_BNB
+                              : MLST_EXACT_ENUMERATE;
+    options.kernelize = kernelize;
+    options.symmetry = symmetry;
+    MlstCache *cache = NULL;
+    if (cache_path && mlst_cache_open(cache_path, &cache) != MLST_OK) {
+        fprintf(stderr, "Cannot open cache %s (not a cache file, or not writable)\n", cache_path);
+        return 1;
+    }
+    options.cache = cache;
+    options.user = &options.method;
+    if (verbosity >= VERBOSITY_TRACE) {
+        options.on_improve = trace_improve;
+        if (options.method == MLST_EXACT_ENUMERATE)
+            options.on_tree = trace_tree;
+    }
+
+    int summary = verbosity >= VERBOSITY_SUMMARY;
+    MlstSolver *solver = mlst_solver_create();
+    MlstResult result;
+    int status = MLST_OK;
+    double start_time = 0, end_time = 0; // monotonic clock, taken around the search itself only
+    if (use_gray) {
+        if (summary) {
+            printf("Exhaustive Search in Revolving-Door Order: One Edge Swapped per Combination\n");
+            printf("----------------------------------------------------------\n");
+        }
+
+        start_time = mlst_seconds();
+        status = mlst_solve_exact(solver, graph, &options, best_tree, &result);
+        end_time = mlst_seconds();
+
+        if (summary && status == MLST_OK && !result.cache.hit) {
+            printf("----------------------------------------------------------\n");
+            printf("Exhaustive Search Complete: %lld combinations, %lld connectivity checks, %lld spanning trees.\n\n",
+                   result.exact.combinations, result.exact.checks, result.exact.trees);
+        }
+    } else if (use_cds) {
+        if (summary) {
+            printf("Connected Dominating Set Search: Leaves = Nodes - Minimum Connected Dominating Set\n");
+            printf("----------------------------------------------------------\n");
+        }
+
+        options.time_limit = time_limit;
+        start_time = mlst_seconds();
+        status = mlst_solve_exact(solver, graph, &options, best_tree, &result);
+        end_time = mlst_seconds();
+
+        if (summary && status == MLST_OK && !result.cache.hit) {
+            printf("----------------------------------------------------------\n");
+            if (result.exact.timed_out)
+                printf("Time Limit Reached after %.1f seconds: %lld nodes expanded; optimality is NOT proven.\n\n",
+                       time_limit, result.exact.nodes);
+            else
+                printf("Dominating Set Search Complete: %lld nodes expanded, %lld branches pruned.\n\n",
+                       result.exact.nodes, result.exact.pruned);
+        }
+    } else if (use_bnb) {
+        if (summary) {
+            printf("Branch-and-Bound Search: Pruning Cycles and Hopeless Branches (%d thread%s)\n",
+                   num_threads, num_threads == 1 ? "" : "s");
+            printf("----------------------------------------------------------\n");
+        }
 
-    printf("----------------------------------------------------------\n");
-    printf("Exhaustive Search Complete: All combinations have been checked.\n\n");
+        unsigned long long combinations = mlst_count_combinations(m, n - 1);
+        MlstCheckpoint c;
+        if (resume_path) {
+            // Pick up where the checkpointed run stopped (including its shard, if any)
+            if (mlst_read_checkpoint(resume_path, &c) != 0) {
+                fprintf(stderr, "Cannot read checkpoint %s\n", resume_path);
+                return 1;
+            }
+            if (c.fingerprint != mlst_graph_fingerprint(graph) || c.n != n || c.m != m) {
+                fprintf(stderr, "Checkpoint %s was written for a different graph\n", resume_path);
+                return 1;
+            }
+            if (shard < 0) {
+                shard = c.shard;
+                num_shards = c.num_shards;
+            }
+            options.resume = &c;
+            if (!checkpoint_path)
+                checkpoint_path = resume_path;
+            if (summary)
+                printf("Resuming from %s: ranks [%llu, %llu) left, best so far %d leaves\n",
+                       resume_path, c.position, c.range_hi, c.best_leaves);
+        } else if (shard >= 0) {
+            if (combinations == ULLONG_MAX) {
+                fprintf(stderr, "C(%d, %d) does not fit in 64 bits: this graph cannot be sharded.\n", m, n - 1);
+                return 1;
+            }
+            unsigned long long lo, hi;
+            mlst_shard_range(combinations, shard, num_shards, &lo, &hi);
+            if (summary)
+                printf("Shard %d/%d: combinations with rank in [%llu, %llu)\n", shard, num_shards, lo, hi);
+        }
+        if (checkpoint_path && combinations == ULLONG_MAX) {
+            fprintf(stderr, "C(%d, %d) does not fit in 64 bits: this search cannot be checkpointed.\n", m, n - 1);
+            return 1;
+        }
+        options.threads = num_threads;
+        options.shard = shard;
+        options.num_shards = shard >= 0 ? num_shards : 0;
+        options.time_limit = time_limit;
+        options.checkpoint_path = checkpoint_path;
+        options.checkpoint_interval = checkpoint_interval;
+        int isolated = -1;
+        char *touched = calloc(n, 1);
+        // Loop to mark the nodes with an edge, then find one without (then no spanning tree exists)
+        for (int i = 0; touched && i < m; i++)
+            touched[edge_list[i].u] = touched[edge_list[i].v] = 1;
+        for (int v = 0; touched && v < n && n > 1 && isolated < 0; v++)
+            if (!touched[v])
+                isolated = v;
+        free(touched);
+        start_time = mlst_seconds();
+        status = mlst_solve_exact(solver, graph, &options, best_tree, &result);
+        end_time = mlst_seconds();
+        if (isolated >= 0 && summary)
+            printf("Node %d has no edges: the graph has no spanning tree.\n", isolated);
+
+        if (summary && status == MLST_OK && !result.cache.hit) {
+            printf("----------------------------------------------------------\n");
+            if (result.exact.timed_out) {
+                printf("Time Limit Reached after %.1f seconds: %lld nodes expanded, %lld trees reached.\n",
+                       time_limit, result.exact.nodes, result.exact.trees);
+                printf("NOTE: the tree below is the best found so far; optimality is NOT proven");
+                if (result.leaves >= result.exact.bound)
+                    printf(" by the search (though it reaches the upper bound)");
+                printf(".\n");
+                if (checkpoint_path)
+                    printf("Searched up to rank %llu of %llu; continue with --resume %s\n",
+                           result.exact.position, result.exact.rank_hi, checkpoint_path);
+                printf("\n");
+            } else {
+                printf("Branch-and-Bound Complete: %lld nodes expanded, %lld branches pruned, %lld trees reached%s.\n",
+                       result.exact.nodes, result.exact.pruned, result.exact.trees,
+                       result.leaves >= result.exact.bound ? ", stopped at a provable optimum" : "");
+                if (result.exact.twin_swaps > 0)
+                    printf("Symmetry: %d twin swap%s, %lld mirror-image branches skipped.\n",
+                           result.exact.twin_swaps, result.exact.twin_swaps == 1 ? "" : "s", result.exact.symmetric);
+                printf("\n");
+            }
+        }
 
-    // Print the best tree found and its adjacency matrix
-    print_best_tree(N);
-    print_adjacency_matrix(N);
+        if (status == MLST_OK && shard >= 0 && result.exact.timed_out) {
+            fprintf(stderr, "Shard %d/%d is incomplete: no shard result written.\n", shard, num_shards);
+            return 2;
+        }
+        if (status == MLST_OK && shard >= 0) {
+            // A shard only reports its own part: the final tree comes from --merge
+            char default_out[64];
+            snprintf(default_out, sizeof(default_out), "shard-%d-of-%d.txt", shard, num_shards);
+            MlstShardResult r = {mlst_graph_fingerprint(graph), n, m, shard, num_shards,
+                                 result.exact.rank_lo, result.exact.rank_hi, result.exact.trees,
+                                 result.leaves, result.exact.best_rank};
+            const char *path = shard_out ? shard_out : default_out;
+            if (mlst_write_shard_result(path, &r, best_tree) != 0) {
+                fprintf(stderr, "Cannot write shard result %s\n", path);
+                return 1;
+            }
+            if (summary)
+                printf("Shard result (best leaves %d) written to %s\n", result.leaves, path);
+            return 0;
+        }
+    } else {
+        if (summary) {
+            printf("Exhaustive Search: Evaluating All Possible Spanning Trees\n");
+            printf("----------------------------------------------------------\n");
+        }
 
-    double time_taken = (double)(end_time - start_time) / CLOCKS_PER_SEC;
-    printf("Time taken: %f seconds\n", time_taken);
-    printf("----------------------------------------------------------\n");
+        // add start timer
+        start_time = mlst_seconds();
+        // Try all possible combinations of n-1 edges
+        status = mlst_solve_exact(solver, graph, &options, best_tree, &result);
+        end_time = mlst_seconds();
+
+        if (summary && status == MLST_OK && !result.cache.hit) {
+            // Combinations a twin swap skipped, or that come after a tree reached the upper bound, are not checked
+            printf("----------------------------------------------------------\n");
+            if (result.exact.twin_swaps > 0)
+                printf("Symmetry: %d twin swap%s; only trees no swap maps to an earlier tree were visited.\n",
+                       result.exact.twin_swaps, result.exact.twin_swaps == 1 ? "" : "s");
+            if (result.exact.combinations != LLONG_MAX)
+                printf("Exhaustive Search Complete: %lld combinations checked, %lld spanning trees.\n\n",
+                       result.exact.combinations, result.exact.trees);
+            else
+                printf("Exhaustive Search Complete: over %lld combinations checked, %lld spanning trees.\n\n",
+                       result.exact.combinations, result.exact.trees);
+        }
+    }
+    if (status != MLST_OK) {
+        fprintf(stderr, "Search failed: %s\n", mlst_error_string(status));
+        return 1;
+    }
+    best_leaf_count = result.leaves;
+    double output_start = mlst_seconds();
+    if (summary && cache) {
+        if (result.cache.hit)
+            printf("Cache: hit in %s, proven optimal tree reused (%.6f s)\n", cache_path, result.cache.seconds);
+        else if (checkpoint_path)
+            printf("Cache: not used by checkpointed searches\n");
+        else
+            printf("Cache: miss in %s, %s%s (%.6f s)\n", cache_path,
+                   !result.cache.stored ? "result not stored"
+                   : result.optimal     ? "result stored"
+                                        : "result stored as not proven optimal",
+                   result.cache.canonical ? "" : ", graph too large or symmetric to label canonically",
+                   result.cache.seconds);
+    }
+    if (summary && kernelize && result.kernel.blocks > 0)
+        printf("Kernel: %d blocks (%d bridges), %d chain nodes removed, largest block %d nodes / %d edges\n",
+               result.kernel.blocks, result.kernel.bridges, result.kernel.contracted,
+               result.kernel.max_nodes, result.kernel.max_edges);
+
+    // How far the tree is from the upper bounds (0 once the search has proven it optimal)
+    if (summary && best_leaf_count >= 0)
+        printf("Upper bound: %d leaves (star %d, degree %d, domination %d), gap %d\n", result.bounds.upper,
+               result.bounds.star, result.bounds.degree, result.bounds.domination,
+               result.bounds.upper - best_leaf_count);
+
+    // Print the best tree found and its adjacency matrix (the matrix is part of the trace only)
+    if (summary)
+        print_best_tree(best_tree, best_leaf_count, n);
+    if (verbosity >= VERBOSITY_TRACE && best_leaf_count >= 0 && n <= MAX_NODES)
+        print_adjacency_matrix(best_tree, n);
+
+    if (summary) {
+        printf("Time taken: %f seconds (search only, wall clock)\n", end_time - start_time);
+        printf("----------------------------------------------------------\n");
+    }
+    if (stats_mode)
+        mlst_write_stats(stdout, &result, load_time, mlst_seconds() - output_start, stats_mode == 2);
+    mlst_solver_destroy(solver);
+    mlst_cache_close(cache);
+    mlst_graph_destroy(graph);
+    free(best_tree);
+    free_graph_input(&input);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,711 @@
+/*
+Graph file readers for edge-list, DIMACS and METIS files (see graph_io.h)
+
+The whole file is mapped with mmap (or read into memory when it cannot be mapped, e.g. a pipe)
+and a small scanner walks the bytes in place: it never copies a line or a token, it only
+parses numbers where they sit. Vertex relabelling and duplicate removal use open-addressing
+hash tables, so both stay linear in the number of edges.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "graph_io.h"
+
+// ---------------------------------------------------------------------------------------------
+// Zero-copy scanner over the mapped file
+
+typedef struct {
+    const char *p, *end;    // current position and end of the buffer (not NUL-terminated)
+    long long line;         // current line number, for error messages
+    const char *path;
+} Scanner;
+
+// Skip spaces and tabs (but not the end of the line)
+static void skip_blanks(Scanner *sc) {
+    while (sc->p < sc->end && (*sc->p == ' ' || *sc->p == '\t' || *sc->p == '\r'))
+        sc->p++;
+}
+
+// Returns 1 if only blanks are left on the current line
+static int at_line_end(Scanner *sc) {
+    skip_blanks(sc);
+    return sc->p >= sc->end || *sc->p == '\n';
+}
+
+// Move to the start of the next line
+static void next_line(Scanner *sc) {
+    const char *nl = memchr(sc->p, '\n', sc->end - sc->p);
+    sc->p = nl ? nl + 1 : sc->end;
+    sc->line++;
+}
+
+// Parse a non-negative integer at the current position
+// Returns 1 on success, 0 if there is no number here or it does not fit in a long long
+static int scan_number(Scanner *sc, long long *value) {
+    skip_blanks(sc);
+    if (sc->p >= sc->end || *sc->p < '0' || *sc->p > '9')
+        return 0;
+    long long x = 0;
+    // Loop through the digits, checking for overflow before each step
+    while (sc->p < sc->end && *sc->p >= '0' && *sc->p <= '9') {
+        int d = *sc->p++ - '0';
+        if (x > (LLONG_MAX - d) / 10)
+            return 0;
+        x = x * 10 + d;
+    }
+    *value = x;
+    return 1;
+}
+
+// Report a parse error at the scanner's current line
+static int scan_error(Scanner *sc, const char *what) {
+    fprintf(stderr, "%s:%lld: %s\n", sc->path, sc->line, what);
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Open-addressing hash table from 64-bit keys to ints (used for relabelling and duplicates)
+
+typedef struct {
+    unsigned long long *keys;   // ULLONG_MAX marks an empty slot
+    int *values;
+    size_t cap, size;           // cap is a power of two, kept at most half full
+} HashMap;
+
+static unsigned long long hash_key(unsigned long long x) {
+    // splitmix64 finaliser: spreads sequential ids over the whole table
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static int hashmap_init(HashMap *h, size_t expected) {
+    h->cap = 16;
+    while (h->cap < 2 * expected)
+        h->cap <<= 1;
+    h->size = 0;
+    h->keys = malloc(h->cap * sizeof(*h->keys));
+    h->values = malloc(h->cap * sizeof(*h->values));
+    if (!h->keys || !h->values)
+        return 1;
+    memset(h->keys, 0xff, h->cap * sizeof(*h->keys));
+    return 0;
+}
+
+static void hashmap_free(HashMap *h) {
+    free(h->keys);
+    free(h->values);
+}
+
+static int hashmap_grow(HashMap *h) {
+    HashMap bigger;
+    if (hashmap_init(&bigger, h->cap) != 0) {
+        hashmap_free(&bigger);
+        return 1;
+    }
+    // Loop through the old slots and re-insert every key
+    for (size_t i = 0; i < h->cap; i++) {
+        if (h->keys[i] == ULLONG_MAX)
+            continue;
+        size_t j = hash_key(h->keys[i]) & (bigger.cap - 1);
+        while (bigger.keys[j] != ULLONG_MAX)
+            j = (j + 1) & (bigger.cap - 1);
+        bigger.keys[j] = h->keys[i];
+        bigger.values[j] = h->values[i];
+    }
+    bigger.size = h->size;
+    hashmap_free(h);
+    *h = bigger;
+    return 0;
+}
+
+// Look key up; if it is missing, insert it with value. Returns the value stored for key,
+// or -1 if memory ran out. *inserted tells whether key was new.
+static int hashmap_get_or_insert(HashMap *h, unsigned long long key, int value, int *inserted) {
+    if (2 * (h->size + 1) > h->cap && hashmap_grow(h) != 0)
+        return -1;
+    size_t j = hash_key(key) & (h->cap - 1);
+    // Linear probing until the key or an empty slot is found
+    while (h->keys[j] != ULLONG_MAX) {
+        if (h->keys[j] == key) {
+            *inserted = 0;
+            return h->values[j];
+        }
+        j = (j + 1) & (h->cap - 1);
+    }
+    h->keys[j] = key;
+    h->values[j] = value;
+    h->size++;
+    *inserted = 1;
+    return value;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Edge collection: applies relabelling, self-loop and duplicate removal as edges are read
+
+typedef struct {
+    const GraphReadOptions *opt;
+    GraphInput *g;
+    size_t cap;                 // allocated length of g->edges
+    size_t labels_cap;
+    long long max_id;           // largest vertex id seen (without relabelling)
+    HashMap ids, pairs;
+    Scanner *sc;
+} EdgeSink;
+
+static int sink_init(EdgeSink *s, const GraphReadOptions *opt, GraphInput *g, Scanner *sc, size_t expected) {
+    memset(g, 0, sizeof(*g));
+    s->opt = opt;
+    s->g = g;
+    s->sc = sc;
+    s->max_id = -1;
+    s->cap = expected > 16 ? expected : 16;
+    s->labels_cap = 0;
+    g->edges = malloc(s->cap * sizeof(Edge));
+    memset(&s->ids, 0, sizeof(s->ids));
+    memset(&s->pairs, 0, sizeof(s->pairs));
+    if (!g->edges)
+        return 1;
+    if (opt->relabel && hashmap_init(&s->ids, 1024) != 0)
+        return 1;
+    if (opt->drop_duplicates && hashmap_init(&s->pairs, expected) != 0)
+        return 1;
+    return 0;
+}
+
+static void sink_free_tables(EdgeSink *s) {
+    hashmap_free(&s->ids);
+    hashmap_free(&s->pairs);
+}
+
+// Map a vertex id from the file to the vertex number used in the graph
+// Returns -1 (after printing the reason) if the id cannot be represented
+static int sink_vertex(EdgeSink *s, long long id) {
+    if (!s->opt->relabel) {
+        if (id >= INT_MAX) {
+            scan_error(s->sc, "vertex id too large (use --relabel)");
+            return -1;
+        }
+        if (id > s->max_id)
+            s->max_id = id;
+        return (int)id;
+    }
+
+    GraphInput *g = s->g;
+    int inserted;
+    int v = hashmap_get_or_insert(&s->ids, (unsigned long long)id, g->n, &inserted);
+    if (v < 0) {
+        scan_error(s->sc, "out of memory");
+        return -1;
+    }
+    if (inserted) {
+        if (g->n == INT_MAX - 1) {
+            scan_error(s->sc, "too many vertices");
+            return -1;
+        }
+        if ((size_t)g->n == s->labels_cap) {
+            size_t cap = s->labels_cap ? 2 * s->labels_cap : 1024;
+            long long *labels = realloc(g->labels, cap * sizeof(long long));
+            if (!labels) {
+                scan_error(s->sc, "out of memory");
+                return -1;
+            }
+            g->labels = labels;
+            s->labels_cap = cap;
+        }
+        g->labels[g->n++] = id;
+    }
+    return v;
+}
+
+// Add the edge between the file ids a and b; returns 1 on error
+static int sink_edge(EdgeSink *s, long long a, long long b) {
+    GraphInput *g = s->g;
+    if (a == b && s->opt->drop_self_loops) {
+        // The loop goes, its node stays (it may have no other edge, and then the graph is disconnected)
+        if (sink_vertex(s, a) < 0)
+            return 1;
+        g->self_loops_dropped++;
+        return 0;
+    }
+    int u = sink_vertex(s, a);
+    int v = sink_vertex(s, b);
+    if (u < 0 || v < 0)
+        return 1;
+
+    if (s->opt->drop_duplicates) {
+        unsigned long long key = u < v ? ((unsigned long long)u << 32) | (unsigned)v
+                                       : ((unsigned long long)v << 32) | (unsigned)u;
+        int inserted;
+        if (hashmap_get_or_insert(&s->pairs, key, 0, &inserted) < 0)
+            return scan_error(s->sc, "out of memory");
+        if (!inserted) {
+            g->duplicates_dropped++;
+            return 0;
+        }
+    }
+
+    if ((size_t)g->m == s->cap) {
+        if (g->m == INT_MAX)
+            return scan_error(s->sc, "too many edges");
+        size_t cap = 2 * s->cap;
+        Edge *edges = realloc(g->edges, cap * sizeof(Edge));
+        if (!edges)
+            return scan_error(s->sc, "out of memory");
+        g->edges = edges;
+        s->cap = cap;
+    }
+    g->edges[g->m].u = u;
+    g->edges[g->m].v = v;
+    g->m++;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Format readers
+
+// Edge list: "u v [anything]" per line, '#' and '%' start comments, blank lines are skipped
+static int parse_edge_list(Scanner *sc, EdgeSink *s) {
+    // Loop through the lines
+    while (sc->p < sc->end) {
+        if (at_line_end(sc) || *sc->p == '#' || *sc->p == '%') {
+            next_line(sc);
+            continue;
+        }
+        long long a, b;
+        if (!scan_number(sc, &a) || !scan_number(sc, &b))
+            return scan_error(sc, "expected two vertex ids");
+        if (sink_edge(s, a, b) != 0)
+            return 1;
+        next_line(sc);
+    }
+    if (!s->opt->relabel)
+        s->g->n = (int)(s->max_id + 1);
+    return 0;
+}
+
+// DIMACS: "c" comments, one "p edge N M" header, then "e u v" lines with 1-based ids
+static int parse_dimacs(Scanner *sc, EdgeSink *s) {
+    long long n = -1;
+    // Loop through the lines
+    while (sc->p < sc->end) {
+        if (at_line_end(sc) || *sc->p == 'c') {
+            next_line(sc);
+            continue;
+        }
+        char kind = *sc->p++;
+        if (kind == 'p') {
+            long long m;
+            skip_blanks(sc);
+            // Skip the problem name ("edge", "col", ...)
+            while (sc->p < sc->end && *sc->p != ' ' && *sc->p != '\t' && *sc->p != '\n')
+                sc->p++;
+            if (n >= 0 || !scan_number(sc, &n) || !scan_number(sc, &m))
+                return scan_error(sc, "expected a single \"p edge N M\" line");
+            if (n >= INT_MAX)
+                return scan_error(sc, "too many vertices");
+        } else if (kind == 'e') {
+            long long a, b;
+            if (n < 0)
+                return scan_error(sc, "edge before the \"p\" line");
+            if (!scan_number(sc, &a) || !scan_number(sc, &b))
+                return scan_error(sc, "expected \"e u v\"");
+            if (a < 1 || a > n || b < 1 || b > n)
+                return scan_error(sc, "vertex id out of range 1..N");
+            if (sink_edge(s, a - 1, b - 1) != 0)
+                return 1;
+        } else {
+            return scan_error(sc, "unknown DIMACS line");
+        }
+        next_line(sc);
+    }
+    if (n < 0)
+        return scan_error(sc, "missing \"p edge N M\" line");
+    if (!s->opt->relabel)
+        s->g->n = (int)n;
+    return 0;
+}
+
+// METIS: "n m [fmt [ncon]]" header, then one line per vertex listing its 1-based neighbours
+// (with vertex sizes/weights and edge weights as given by fmt, all skipped)
+static int parse_metis(Scanner *sc, EdgeSink *s) {
+    long long n, m, fmt = 0, ncon = 1;
+    // Loop past the comments to the header
+    while (sc->p < sc->end && (at_line_end(sc) || *sc->p == '%'))
+        next_line(sc);
+    if (!scan_number(sc, &n) || !scan_number(sc, &m))
+        return scan_error(sc, "expected the \"n m [fmt [ncon]]\" header");
+    if (!at_line_end(sc) && (!scan_number(sc, &fmt) || (!at_line_end(sc) && !scan_number(sc, &ncon))))
+        return scan_error(sc, "bad METIS header");
+    if (n >= INT_MAX)
+        return scan_error(sc, "too many vertices");
+    int has_size = (fmt / 100) % 10, has_vweights = (fmt / 10) % 10, has_eweights = fmt % 10;
+    next_line(sc);
+
+    long long u = 0;
+    // Loop through the vertex lines (comment lines do not count as vertices, blank lines do)
+    while (sc->p < sc->end && u < n) {
+        skip_blanks(sc);
+        if (sc->p < sc->end && *sc->p == '%') {
+            next_line(sc);
+            continue;
+        }
+        long long skip, v;
+        for (long long i = 0; i < has_size + (has_vweights ? ncon : 0); i++) {
+            if (!scan_number(sc, &skip))
+                return scan_error(sc, "missing vertex size or weight");
+        }
+        // Loop through the neighbours; each edge is listed at both ends, keep it at the lower one
+        while (!at_line_end(sc)) {
+            if (!scan_number(sc, &v) || v < 1 || v > n)
+                return scan_error(sc, "neighbour out of range 1..n");
+            if (has_eweights && !scan_number(sc, &skip))
+                return scan_error(sc, "missing edge weight");
+            if (u <= v - 1 && sink_edge(s, u, v - 1) != 0)
+                return 1;
+        }
+        u++;
+        next_line(sc);
+    }
+    // Loop past trailing comments and blank lines
+    while (sc->p < sc->end && (at_line_end(sc) || *sc->p == '%'))
+        next_line(sc);
+    if (u < n)
+        return scan_error(sc, "fewer vertex lines than the header says");
+    if (sc->p < sc->end)
+        return scan_error(sc, "more vertex lines than the header says");
+    if (!s->opt->relabel)
+        s->g->n = (int)n;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+int graph_format_from_name(const char *name) {
+    if (strcmp(name, "auto") == 0)
+        return GRAPH_FORMAT_AUTO;
+    if (strcmp(name, "edgelist") == 0)
+        return GRAPH_FORMAT_EDGELIST;
+    if (strcmp(name, "dimacs") == 0)
+        return GRAPH_FORMAT_DIMACS;
+    if (strcmp(name, "metis") == 0)
+        return GRAPH_FORMAT_METIS;
+    return -1;
+}
+
+// Pick a format from the file name, then from the first non-blank line
+static GraphFormat detect_format(const char *path, const char *data, size_t size) {
+    const char *dot = strrchr(path, '.');
+    if (dot && (strcmp(dot, ".graph") == 0 || strcmp(dot, ".metis") == 0))
+        return GRAPH_FORMAT_METIS;
+    if (dot && (strcmp(dot, ".dimacs") == 0 || strcmp(dot, ".col") == 0 || strcmp(dot, ".clq") == 0))
+        return GRAPH_FORMAT_DIMACS;
+    size_t i = 0;
+    while (i < size && (data[i] == ' ' || data[i] == '\t' || data[i] == '\r' || data[i] == '\n'))
+        i++;
+    if (i < size && (data[i] == 'p' || data[i] == 'c'))
+        return GRAPH_FORMAT_DIMACS;
+    return GRAPH_FORMAT_EDGELIST;
+}
+
+// Read a whole stream that cannot be mapped (a pipe or standard input)
+static char *read_stream(int fd, size_t *size) {
+    size_t cap = 1 << 16, len = 0;
+    char *buf = malloc(cap);
+    ssize_t got;
+    while (buf && (got = read(fd, buf + len, cap - len)) > 0) {
+        len += got;
+        if (len == cap) {
+            char *bigger = realloc(buf, cap *= 2);
+            if (!bigger)
+                free(buf);
+            buf = bigger;
+        }
+    }
+    *size = len;
+    return buf;
+}
+
+// Map a regular file read-only; returns NULL if fd is not a regular file, is empty or cannot be
+// mapped (size is the file size either way, 0 when it is not a regular file)
+static char *map_file(int fd, size_t *size, int *regular) {
+    struct stat st;
+    *regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    *size = *regular ? (size_t)st.st_size : 0;
+    if (*size == 0)
+        return NULL;
+    char *data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return NULL;
+    madvise(data, *size, MADV_SEQUENTIAL);
+    return data;
+}
+
+// Parse the bytes of one graph in the given format (auto = detected from the name and first line)
+static int parse_buffer(Scanner *sc, const char *name, const GraphReadOptions *opt, GraphInput *g) {
+    size_t size = sc->end - sc->p;
+    GraphFormat format = opt->format;
+    if (format == GRAPH_FORMAT_AUTO)
+        format = detect_format(name, sc->p, size);
+
+    // Guess the edge count from the size (about 8 bytes per edge line) to avoid most regrowth
+    EdgeSink sink;
+    int status = sink_init(&sink, opt, g, sc, size / 8 + 16);
+    if (status != 0)
+        fprintf(stderr, "Out of memory reading %s\n", sc->path);
+    else if (format == GRAPH_FORMAT_DIMACS)
+        status = parse_dimacs(sc, &sink);
+    else if (format == GRAPH_FORMAT_METIS)
+        status = parse_metis(sc, &sink);
+    else
+        status = parse_edge_list(sc, &sink);
+    sink_free_tables(&sink);
+    if (status != 0)
+        free_graph_input(g);
+    return status;
+}
+
+int read_graph_file(const char *path, const GraphReadOptions *opt, GraphInput *g) {
+    int from_stdin = strcmp(path, "-") == 0;
+    int fd = from_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open graph file %s\n", path);
+        return 1;
+    }
+
+    // Map the file; fall back to reading it when it is not a regular file
+    size_t size;
+    int regular;
+    char *data = map_file(fd, &size, &regular);
+    int mapped = data != NULL;
+    if (!mapped && (size > 0 || !regular)) {
+        data = read_stream(fd, &size);
+        if (!data) {
+            fprintf(stderr, "Cannot read graph file %s\n", path);
+            if (!from_stdin)
+                close(fd);
+            return 1;
+        }
+    }
+    if (!from_stdin)
+        close(fd);
+
+    Scanner sc = {data, data + size, 1, path};
+    int status = parse_buffer(&sc, path, opt, g);
+    if (mapped)
+        munmap(data, size);
+    else
+        free(data);
+    return status;
+}
+
+void free_graph_input(GraphInput *g) {
+    free(g->edges);
+    free(g->labels);
+    g->edges = NULL;
+    g->labels = NULL;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Multi-graph streams: "graph ID" header lines split one file into many graphs
+
+struct GraphStream {
+    const char *path;
+    char *data;                 // mapped file (NULL when reading a pipe or standard input)
+    size_t size;
+    const char *p;              // mapped: start of the next unread line
+    FILE *in;                   // pipe: read one line at a time
+    char *line;                 // pipe: the last line read
+    size_t line_cap;
+    ssize_t line_len;
+    int reread;                 // pipe: hand out the last line again (a header that ended a body)
+    long long line_no;          // number of the next unread line
+    long long index;            // graphs handed out so far
+};
+
+// Next line of the stream with its length (newline included), NULL at the end
+static const char *stream_line(GraphStream *s, size_t *len) {
+    const char *line;
+    if (s->data) {
+        if (s->p >= s->data + s->size)
+            return NULL;
+        const char *nl = memchr(s->p, '\n', s->data + s->size - s->p);
+        line = s->p;
+        s->p = nl ? nl + 1 : s->data + s->size;
+        *len = s->p - line;
+    } else if (s->in) {
+        if (!s->reread && (s->line_len = getline(&s->line, &s->line_cap, s->in)) < 0)
+            return NULL;
+        s->reread = 0;
+        line = s->line;
+        *len = s->line_len;
+    } else {
+        return NULL; // empty file
+    }
+    s->line_no++;
+    return line;
+}
+
+// Give back the line stream_line just returned
+static void stream_unread(GraphStream *s, const char *line) {
+    if (s->data)
+        s->p = line;
+    else
+        s->reread = 1;
+    s->line_no--;
+}
+
+// Returns 1 if the line is a "graph [ID]" header, copying the id (empty if there is none)
+static int section_header(const char *line, size_t len, char *id) {
+    if (len < 5 || memcmp(line, "graph", 5) != 0 || (len > 5 && !strchr(" \t\r\n", line[5])))
+        return 0;
+    size_t i = 5, k = 0;
+    while (i < len && (line[i] == ' ' || line[i] == '\t'))
+        i++;
+    // Loop through the id up to the first blank (longer ids are cut short)
+    while (i < len && !strchr(" \t\r\n", line[i])) {
+        if (k + 1 < GRAPH_ID_MAX)
+            id[k++] = line[i];
+        i++;
+    }
+    id[k] = '\0';
+    return 1;
+}
+
+// Returns 1 if the line is blank or a comment of one of the formats ('#', '%' or a DIMACS "c")
+static int blank_or_comment(const char *line, size_t len) {
+    size_t i = 0;
+    while (i < len && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
+        i++;
+    return i == len || line[i] == '\n' || line[i] == '#' || line[i] == '%' ||
+           (line[i] == 'c' && (i + 1 == len || strchr(" \t\r\n", line[i + 1])));
+}
+
+// Append a line to the section's own buffer (pipes only)
+static int section_append(GraphSection *sec, const char *line, size_t len) {
+    if (sec->size + len > sec->cap) {
+        size_t cap = sec->cap ? sec->cap : 1 << 12;
+        while (cap < sec->size + len)
+            cap *= 2;
+        char *buf = realloc(sec->buf, cap);
+        if (!buf)
+            return 1;
+        sec->buf = buf;
+        sec->cap = cap;
+    }
+    memcpy(sec->buf + sec->size, line, len);
+    sec->size += len;
+    return 0;
+}
+
+GraphStream *graph_stream_open(const char *path) {
+    GraphStream *s = calloc(1, sizeof(*s));
+    if (!s) {
+        fprintf(stderr, "Out of memory opening %s\n", path);
+        return NULL;
+    }
+    s->path = path;
+    s->line_no = 1;
+    int from_stdin = strcmp(path, "-") == 0;
+    int fd = from_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open graph stream %s\n", path);
+        free(s);
+        return NULL;
+    }
+
+    // Map a regular file; read anything else line by line, so graphs can be solved as they arrive
+    int regular;
+    s->data = map_file(fd, &s->size, &regular);
+    s->p = s->data;
+    if (s->data || (regular && s->size == 0)) {
+        if (!from_stdin)
+            close(fd);
+        return s;
+    }
+    s->in = from_stdin ? stdin : fdopen(fd, "r");
+    if (!s->in) {
+        fprintf(stderr, "Cannot read graph stream %s\n", path);
+        close(fd);
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+int graph_stream_next(GraphStream *s, GraphSection *sec) {
+    const char *line;
+    size_t len;
+    sec->id[0] = '\0';
+    // Loop past blank lines and comments to the header (or the first line of a graph without one)
+    while ((line = stream_line(s, &len)) != NULL) {
+        if (section_header(line, len, sec->id))
+            break;
+        if (!blank_or_comment(line, len)) {
+            stream_unread(s, line);
+            break;
+        }
+    }
+    if (!line)
+        return s->in && ferror(s->in) ? -1 : 0;
+
+    // The body runs up to the next header
+    sec->index = s->index++;
+    if (sec->id[0] == '\0')
+        snprintf(sec->id, GRAPH_ID_MAX, "%lld", sec->index);
+    sec->line = s->line_no;
+    sec->size = 0;
+    const char *start = s->p;
+    while ((line = stream_line(s, &len)) != NULL) {
+        char id[GRAPH_ID_MAX];
+        if (section_header(line, len, id)) {
+            stream_unread(s, line);
+            break;
+        }
+        if (!s->data && section_append(sec, line, len) != 0) {
+            fprintf(stderr, "%s:%lld: out of memory\n", s->path, s->line_no - 1);
+            return -1;
+        }
+    }
+    if (s->data) {
+        sec->data = start;
+        sec->size = s->p - start;
+    } else {
+        sec->data = sec->buf;
+    }
+    return s->in && ferror(s->in) ? -1 : 1;
+}
+
+void graph_stream_close(GraphStream *s) {
+    if (!s)
+        return;
+    if (s->data)
+        munmap(s->data, s->size);
+    if (s->in && s->in != stdin)
+        fclose(s->in);
+    free(s->line);
+    free(s);
+}
+
+int read_graph_section(const GraphStream *s, const GraphSection *sec, const GraphReadOptions *opt,
+                       GraphInput *g) {
+    // The format is detected from the body alone: the stream's file name says nothing about one graph
+    Scanner sc = {sec->data, sec->data + sec->size, sec->line, s->path};
+    return parse_buffer(&sc, "", opt, g);
+}
+
+void graph_section_free(GraphSection *sec) {
+    free(sec->buf);
+    sec->buf = NULL;
+    sec->cap = 0;
+}
@@ -0,0 +1,111 @@
+/*
+Graph file input shared by the exhaustive and the approximation programs
+
+Supported formats:
+- Edge list: one edge "u v" per line (0-based vertex ids, anything after the two ids is ignored,
+  lines starting with '#' or '%' are comments)
+- DIMACS: "p edge N M" header and "e u v" edge lines (1-based), "c" lines are comments
+- METIS: "n m [fmt [ncon]]" header, then line i lists the neighbours of vertex i (1-based),
+  '%' lines are comments; every undirected edge is listed twice and read once
+
+The file is memory-mapped and scanned in place: vertex ids are parsed straight out of the
+mapping without copying lines, so multi-million-edge files cost one pass and the edge array.
+*/
+
+#ifndef GRAPH_IO_H
+#define GRAPH_IO_H
+
+typedef struct {
+    int u, v;
+} Edge;
+
+typedef enum {
+    GRAPH_FORMAT_AUTO,      // METIS for .graph/.metis, DIMACS for .dimacs/.col/.clq or a "p"/"c" first line, else edge list
+    GRAPH_FORMAT_EDGELIST,
+    GRAPH_FORMAT_DIMACS,
+    GRAPH_FORMAT_METIS
+} GraphFormat;
+
+typedef struct {
+    GraphFormat format;
+    int drop_self_loops;    // skip edges (u, u)
+    int drop_duplicates;    // keep only the first copy of an edge (in either direction)
+    int relabel;            // renumber the vertices that occur in edges to 0..n-1 in order of appearance
+} GraphReadOptions;
+
+typedef struct {
+    int n, m;               // number of vertices and edges
+    Edge *edges;            // the m edges in file order
+    long long *labels;      // with relabel: labels[i] is the id vertex i had in the file (NULL otherwise)
+    long long self_loops_dropped;
+    long long duplicates_dropped;
+} GraphInput;
+
+// Parse a format name (auto, edgelist, dimacs, metis); returns -1 for an unknown name
+int graph_format_from_name(const char *name);
+
+/**
+ * Reads a graph file into an edge array.
+ *
+ * @param path  File to read ("-" reads standard input).
+ * @param opt   Format and clean-up options.
+ * @param g     Receives the graph; release it with free_graph_input.
+ * @return 0 on success, 1 on error (the reason and line are printed to stderr).
+ */
+int read_graph_file(const char *path, const GraphReadOptions *opt, GraphInput *g);
+
+// Release the arrays of a graph read by read_graph_file
+void free_graph_input(GraphInput *g);
+
+/*
+Multi-graph streams (used by the batch program)
+
+A stream is one file, pipe or standard input holding many graphs. Every graph starts with a
+"graph ID" line and its body follows in any of the formats above, up to the next such line.
+Lines before the first header that are not blank or comments form a graph of their own, so a
+plain graph file is a stream of one graph. A mapped file is split in place without copying; a
+pipe is read one graph at a time, so the first graphs can be solved while later ones arrive.
+*/
+
+#define GRAPH_ID_MAX 64
+
+typedef struct GraphStream GraphStream;
+
+typedef struct {
+    char id[GRAPH_ID_MAX];  // from the header (the graph's position in the stream if it has none)
+    long long index;        // 0-based position of the graph in the stream
+    long long line;         // line of the stream the body starts on, for error messages
+    const char *data;       // the body: inside the mapped file, or buf for a pipe
+    size_t size;
+    char *buf;              // copy of the body read from a pipe, reused by the next call
+    size_t cap;
+} GraphSection;
+
+// Open a stream ("-" = standard input); NULL if it cannot be opened (the reason is printed)
+GraphStream *graph_stream_open(const char *path);
+
+/**
+ * Moves to the next graph of a stream. Callers sharing a stream must take turns (a lock).
+ *
+ * @param sec  Receives the id and body; keep passing the same section to reuse its buffer, and
+ *             release it with graph_section_free.
+ * @return 1 if there is a graph, 0 at the end of the stream, -1 on a read error.
+ */
+int graph_stream_next(GraphStream *s, GraphSection *sec);
+
+void graph_stream_close(GraphStream *s);
+
+/**
+ * Parses the body of one graph of a stream like read_graph_file (any number of threads may
+ * parse different sections at once). With GRAPH_FORMAT_AUTO the format is picked from the
+ * body's first line, so METIS bodies need GRAPH_FORMAT_METIS.
+ *
+ * @return 0 on success, 1 on error (the reason and line are printed to stderr).
+ */
+int read_graph_section(const GraphStream *s, const GraphSection *sec, const GraphReadOptions *opt,
+                       GraphInput *g);
+
+// Release the buffer of a section filled by graph_stream_next
+void graph_section_free(GraphSection *sec);
+
+#endif
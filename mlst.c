@@ -0,0 +1,190 @@
+/*
+Graph building and solver contexts of libmlst (the solvers are in mlst_exact.c and mlst_approx.c,
+the kernelization in mlst_kernel.c)
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+#include "mlst_internal.h"
+
+const char *mlst_error_string(int code) {
+    switch (code) {
+    case MLST_OK:
+        return "ok";
+    case MLST_ERROR_ARGUMENT:
+        return "invalid argument";
+    case MLST_ERROR_NO_MEMORY:
+        return "out of memory";
+    case MLST_ERROR_TOO_LARGE:
+        return "graph too large";
+    case MLST_ERROR_NOT_RANKABLE:
+        return "too many edge combinations to rank in 64 bits";
+    case MLST_ERROR_IO:
+        return "cannot read or write file";
+    case MLST_ERROR_INTERNAL:
+        return "internal error: inconsistent result";
+    }
+    return "unknown error";
+}
+
+int mlst_reserve(void **p, int *capacity, size_t count, size_t size) {
+    if (count <= (size_t)*capacity)
+        return 0;
+    if (count > INT_MAX)
+        return -1;
+    // Grow geometrically so a run of slightly larger graphs does not reallocate every time
+    size_t grown = (size_t)*capacity * 2;
+    if (grown < count)
+        grown = count;
+    if (grown > INT_MAX)
+        grown = INT_MAX;
+    void *q = realloc(*p, grown * size);
+    if (!q)
+        return -1;
+    *p = q;
+    *capacity = (int)grown;
+    return 0;
+}
+
+struct ArenaBlock {
+    ArenaBlock *prev;
+    size_t size, used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+#define ARENA_ALIGN alignof(max_align_t)
+#define ARENA_MIN_BLOCK 4096
+
+void *arena_alloc(Arena *a, size_t size) {
+    if (size > SIZE_MAX - ARENA_ALIGN - sizeof(ArenaBlock))
+        return NULL;
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    ArenaBlock *b = a->block;
+    if (!b || b->size - b->used < size) {
+        // A new block at least twice the last one keeps the number of blocks logarithmic
+        size_t block_size = b && b->size <= (SIZE_MAX - sizeof(ArenaBlock)) / 2 ? 2 * b->size : ARENA_MIN_BLOCK;
+        if (block_size < size)
+            block_size = size;
+        ArenaBlock *nb = malloc(sizeof(ArenaBlock) + block_size);
+        if (!nb)
+            return NULL;
+        nb->prev = b;
+        nb->size = block_size;
+        nb->used = 0;
+        a->block = b = nb;
+    }
+    void *p = b->data + b->used;
+    b->used += size;
+    return p;
+}
+
+void arena_reset(Arena *a) {
+    ArenaBlock *b = a->block;
+    if (!b)
+        return;
+    if (!b->prev) {
+        b->used = 0;
+        return;
+    }
+    size_t total = 0;
+    while (b) {
+        ArenaBlock *prev = b->prev;
+        total += b->size;
+        free(b);
+        b = prev;
+    }
+    // If the combined block cannot be had the arena simply starts empty again
+    a->block = malloc(sizeof(ArenaBlock) + total);
+    if (a->block) {
+        a->block->prev = NULL;
+        a->block->size = total;
+        a->block->used = 0;
+    }
+}
+
+void arena_free(Arena *a) {
+    ArenaBlock *b = a->block;
+    while (b) {
+        ArenaBlock *prev = b->prev;
+        free(b);
+        b = prev;
+    }
+    a->block = NULL;
+}
+
+MlstGraph *mlst_graph_create(int n) {
+    if (n < 0)
+        return NULL;
+    MlstGraph *g = calloc(1, sizeof(MlstGraph));
+    if (g)
+        g->n = n;
+    return g;
+}
+
+int mlst_graph_reset(MlstGraph *g, int n) {
+    if (!g || n < 0)
+        return MLST_ERROR_ARGUMENT;
+    g->n = n;
+    g->m = 0;
+    return MLST_OK;
+}
+
+int mlst_graph_add_edge(MlstGraph *g, int u, int v) {
+    Edge e = {u, v};
+    return mlst_graph_add_edges(g, &e, 1);
+}
+
+int mlst_graph_add_edges(MlstGraph *g, const Edge *edges, int m) {
+    if (!g || m < 0 || (m > 0 && !edges))
+        return MLST_ERROR_ARGUMENT;
+    // Loop to check every vertex id before anything is added
+    for (int i = 0; i < m; i++) {
+        if (edges[i].u < 0 || edges[i].u >= g->n || edges[i].v < 0 || edges[i].v >= g->n)
+            return MLST_ERROR_ARGUMENT;
+    }
+    if (m > INT_MAX - g->m)
+        return MLST_ERROR_TOO_LARGE;
+    if (mlst_reserve((void **)&g->edges, &g->capacity, (size_t)g->m + m, sizeof(Edge)) != 0)
+        return MLST_ERROR_NO_MEMORY;
+    if (m > 0)
+        memcpy(g->edges + g->m, edges, m * sizeof(Edge));
+    g->m += m;
+    return MLST_OK;
+}
+
+int mlst_graph_nodes(const MlstGraph *g) {
+    return g->n;
+}
+
+int mlst_graph_edge_count(const MlstGraph *g) {
+    return g->m;
+}
+
+const Edge *mlst_graph_edges(const MlstGraph *g) {
+    return g->edges;
+}
+
+void mlst_graph_destroy(MlstGraph *g) {
+    if (!g)
+        return;
+    free(g->edges);
+    free(g);
+}
+
+MlstSolver *mlst_solver_create(void) {
+    return calloc(1, sizeof(MlstSolver));
+}
+
+void mlst_solver_destroy(MlstSolver *s) {
+    if (!s)
+        return;
+    approx_context_free(s->approx);
+    exact_context_free(s->exact);
+    kernel_context_free(s->kernel);
+    cache_context_free(s->cache);
+    free(s);
+}
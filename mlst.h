@@ -0,0 +1,486 @@
+/*
+libmlst: maximum leaf spanning tree solvers as a library
+
+The exact search (branch and bound, plain enumeration, revolving-door order or a minimum
+connected dominating set search) and the Solis-Oba 2-approximation behind the two command-line
+programs, without global state:
+
+- An MlstGraph holds the edge list of one graph. It can be reset and refilled, so a caller
+  that solves many graphs keeps one graph object and its edge buffer.
+- An MlstSolver holds every scratch buffer the solvers need (union-find, bucket queues,
+  link-cut tree, search tasks, ...). The buffers grow to the largest graph seen and are
+  reused by later calls, so solving many small graphs does not allocate after the first.
+- A solve call writes the tree into a caller-supplied edge array and fills an MlstResult.
+
+Thread safety: nothing is shared between solvers. Any number of threads may solve at the same
+time as long as each uses its own MlstSolver (graphs are only read by a solve and may be shared).
+A solver asked for several threads (MlstExactOptions.threads, MlstApproxOptions.threads) starts
+and joins them inside the call.
+
+Typical use:
+    MlstGraph *g = mlst_graph_create(4);
+    mlst_graph_add_edge(g, 0, 1); ...
+    MlstSolver *s = mlst_solver_create();
+    Edge tree[3];
+    MlstResult r;
+    if (mlst_solve_approx(s, g, NULL, tree, &r) == MLST_OK)
+        printf("%d leaves\n", r.leaves);
+    mlst_solver_destroy(s);
+    mlst_graph_destroy(g);
+*/
+
+#ifndef MLST_H
+#define MLST_H
+
+#include <stdio.h>
+
+#include "graph_io.h"
+
+// Largest graph the exact search accepts (node sets are machine words, ranks use a binomial table)
+#define MLST_EXACT_MAX_NODES 64
+#define MLST_EXACT_MAX_EDGES 128
+
+// Return codes of the library calls
+enum {
+    MLST_OK = 0,
+    MLST_ERROR_ARGUMENT,        // NULL object, vertex id out of range or invalid option
+    MLST_ERROR_NO_MEMORY,
+    MLST_ERROR_TOO_LARGE,       // the graph is above the exact search limits (or 32-bit vertex/edge counts)
+    MLST_ERROR_NOT_RANKABLE,    // sharding/checkpointing needs C(m, n-1) to fit in 64 bits
+    MLST_ERROR_IO,              // a checkpoint could not be read or does not belong to the graph
+    MLST_ERROR_INTERNAL         // a result failed a consistency check (a bug in the library)
+};
+
+// Short description of a return code
+const char *mlst_error_string(int code);
+
+typedef struct MlstGraph MlstGraph;
+typedef struct MlstSolver MlstSolver;
+typedef struct MlstCache MlstCache;
+
+// Graph with n nodes (0..n-1) and no edges; NULL if out of memory
+MlstGraph *mlst_graph_create(int n);
+
+// Remove every edge and change the node count to n (the edge buffer is kept for the next graph)
+int mlst_graph_reset(MlstGraph *g, int n);
+
+// Add the undirected edge u-v (parallel edges and self-loops are kept as given)
+int mlst_graph_add_edge(MlstGraph *g, int u, int v);
+
+// Add m edges at once
+int mlst_graph_add_edges(MlstGraph *g, const Edge *edges, int m);
+
+int mlst_graph_nodes(const MlstGraph *g);
+int mlst_graph_edge_count(const MlstGraph *g);
+
+// The edges in the order they were added
+const Edge *mlst_graph_edges(const MlstGraph *g);
+
+void mlst_graph_destroy(MlstGraph *g);
+
+// Solver context with empty scratch buffers; NULL if out of memory
+MlstSolver *mlst_solver_create(void);
+
+void mlst_solver_destroy(MlstSolver *s);
+
+// Counters of an exact search (which ones are filled depends on the method)
+typedef struct {
+    long long nodes;            // branch and bound, dominating sets: search nodes expanded
+    long long pruned;           // branch and bound, dominating sets: branches cut by a bound
+    long long symmetric;        // branch and bound: branches cut by twin symmetry breaking
+    int twin_swaps;             // swaps of twin nodes used for symmetry breaking (see MlstExactOptions.symmetry)
+    long long trees;            // spanning trees reached
+    long long combinations;     // enumeration, revolving door: combinations checked (saturated at LLONG_MAX)
+    long long checks;           // revolving door: connectivity checks
+    int bound;                  // leaf count the search stops at as soon as it reaches it (bounds.upper)
+    int timed_out;              // the time limit stopped the search before it finished
+    unsigned long long rank_lo, rank_hi; // branch and bound: rank range that was searched
+    unsigned long long position; // branch and bound: every rank below this one has been searched
+    unsigned long long best_rank; // lexicographic rank of the tree found (if the graph is rankable)
+} MlstExactStats;
+
+// Counters of the approximation (of the winning start)
+typedef struct {
+    int start;                  // start that produced the tree (0 = the plain deterministic run)
+    int leaves_before;          // leaves before the local search
+    int forest_vertices, forest_edges, forest_leaves; // the maximally leafy forest
+    long long ls_evaluated;     // local search: candidate swaps scored
+    long long ls_swaps;         // local search: swaps kept
+    int ls_passes;
+    int ls_budget_hit;          // the local search stopped on its budget, not at a local optimum
+} MlstApproxStats;
+
+// What the kernelization did (all zero when it was not asked for)
+typedef struct {
+    int blocks;                 // pieces solved separately (biconnected blocks for the exact search, 1 for the approximation)
+    int bridges;                // blocks that are a single forced edge (solved without a search)
+    int contracted;             // degree-2 nodes removed by shortening chains
+    int max_nodes, max_edges;   // largest piece handed to the solver
+} MlstKernelStats;
+
+// Upper bounds on the leaves of any spanning tree (the optimality gap of a result is upper - leaves)
+typedef struct {
+    int star;                   // n-1, less the nodes that are never leaves (pinned, or next to a pendant node)
+    int degree;                 // the internal nodes' degrees must add up to the tree's degree sum
+    int domination;             // n minus a lower bound on the domination number (dual of its LP relaxation)
+    int approx;                 // twice the approximation's leaves (-1 unless an approximation built a spanning tree)
+    int upper;                  // the smallest of the above (the leaves themselves once the exact search proved them optimal)
+} MlstBounds;
+
+/*
+Instrumentation (MlstResult.stats)
+
+The hot-path counters and phase timers are only compiled in when the library is built with
+MLST_STATS defined (`make STATS=1`); otherwise every field stays zero, enabled is 0 and the
+searches run exactly as before. Counters of a multi-start or multi-threaded solve are summed over
+all starts/threads, and so are the phase timers (they add up thread time, not wall-clock time).
+*/
+
+// Phases timed by the instrumentation (indices into MlstStats.phase)
+typedef enum {
+    MLST_PHASE_GRAPH,           // approximation: CSR graph built from the edge list
+    MLST_PHASE_FOREST,          // approximation: maximally leafy forest (expansion rules)
+    MLST_PHASE_DSU_INIT,        // approximation: union-find set up with the forest edges
+    MLST_PHASE_CONNECT,         // approximation: forest joined into a spanning tree in tiers
+    MLST_PHASE_LEAF_COUNT,      // approximation: leaves of the tree counted
+    MLST_PHASE_LOCAL_SEARCH,    // approximation: edge-swap local search
+    MLST_PHASE_BOUNDS,          // both: upper bounds on the leaves
+    MLST_PHASE_SETUP,           // exact: search tables, symmetry detection, greedy start
+    MLST_PHASE_SEARCH,          // exact: the search itself (branch and bound: with the task split)
+    MLST_PHASE_COUNT
+} MlstPhase;
+
+// Short name of a phase ("graph", "forest", ...)
+const char *mlst_phase_name(int phase);
+
+#define MLST_STATS_MAX_IMPROVEMENTS 32
+
+// A new best tree: when the exact search found it and its leaves
+typedef struct {
+    double seconds;             // since the search started
+    int leaves;
+} MlstImprovement;
+
+typedef struct {
+    int enabled;                // 1 if the library was built with MLST_STATS
+    // Exact search (enumeration and branch and bound: every edge pick is a union-find connectivity check)
+    long long edges_tried;      // edges tried at some position of a combination
+    long long cycles;           // of those, edges rejected because they close a cycle
+    long long improvements;     // new best trees (incumbent updates)
+    MlstImprovement improvement[MLST_STATS_MAX_IMPROVEMENTS]; // the first ones (not for kernelized solves)
+    // Approximation
+    long long dsu_finds;        // union-find lookups
+    long long dsu_steps;        // parent links followed by them (total path length)
+    int dsu_longest;            // longest path followed by one lookup
+    long long expand_considered; // neighbours looked at by the expansion rules
+    long long expand_accepted;  // of those, taken into the forest as children
+    int forest_depth;           // deepest node of the leafy forest below its root (largest over the starts)
+    double phase[MLST_PHASE_COUNT]; // seconds per phase
+} MlstStats;
+
+// What the result cache did (all zero when no cache was given)
+typedef struct {
+    int hit;                    // the tree came from the cache, without a solve
+    int stored;                 // the result was added to the cache (or replaced a worse one)
+    int canonical;              // the graph got a canonical labelling: isomorphic graphs share its entry
+                                // (0: too large or symmetric to label in the budget, only this node order finds it)
+    double seconds;             // spent labelling the graph and in the cache file
+} MlstCacheStats;
+
+typedef struct {
+    int leaves;                 // leaves of the tree (-1 if the exact search found no spanning tree)
+    int tree_edges;             // edges written to the tree array
+    int optimal;                // 1 if the tree is proven optimal (by the exact search, or stored as such in a cache)
+    MlstBounds bounds;          // upper bounds on the leaves, filled by both solvers
+    MlstExactStats exact;
+    MlstApproxStats approx;
+    MlstKernelStats kernel;
+    MlstStats stats;            // instrumentation (see above; all zero unless built with MLST_STATS)
+    MlstCacheStats cache;
+} MlstResult;
+
+// 1 if the library was built with the instrumentation (MLST_STATS)
+int mlst_stats_enabled(void);
+
+// Seconds on the monotonic clock (not affected by wall-clock changes): the clock of the library's
+// phase timers and time limits, for timing calls from outside the library the same way
+double mlst_seconds(void);
+
+/**
+ * Writes the instrumentation of a result as one JSON object or as indented text, together with
+ * the counters every build keeps (MlstExactStats, MlstApproxStats).
+ *
+ * @param load    Seconds the caller spent reading and building the graph (< 0 = not reported).
+ * @param output  Seconds the caller spent printing the result (< 0 = not reported).
+ * @param json    1 for JSON, 0 for text.
+ */
+void mlst_write_stats(FILE *f, const MlstResult *r, double load, double output, int json);
+
+typedef enum {
+    MLST_EXACT_BNB,             // branch and bound (the default)
+    MLST_EXACT_ENUMERATE,       // every spanning tree in lexicographic order
+    MLST_EXACT_GRAY,            // every combination in revolving-door order
+    MLST_EXACT_CDS              // minimum connected dominating set over node sets (no edge limit)
+} MlstExactMethod;
+
+// Resume point of an interrupted branch-and-bound search, as stored in a checkpoint file
+typedef struct {
+    unsigned long long fingerprint;
+    int n, m;
+    int shard, num_shards;
+    unsigned long long range_lo, range_hi;
+    unsigned long long position;
+    long long trees;
+    int best_leaves;
+    unsigned long long best_rank;
+} MlstCheckpoint;
+
+typedef struct {
+    MlstExactMethod method;
+    int threads;                // branch and bound: worker threads (1 = only the calling thread)
+    double time_limit;          // branch and bound, dominating sets: seconds before stopping early (0 = no limit)
+    const char *checkpoint_path; // branch and bound: where to save progress (NULL = nowhere)
+    double checkpoint_interval; // seconds between two checkpoints
+    int shard, num_shards;      // branch and bound: search only the shard-th of num_shards rank ranges
+    const MlstCheckpoint *resume; // branch and bound: continue this checkpoint (NULL = start fresh)
+    int kernelize;              // split the graph into blocks and shorten degree-2 chains first (see below)
+    int symmetry;               // enumerate: skip trees that swapping two twin nodes maps to an earlier tree
+                                // (branch and bound always does; the best tree stays the same)
+    MlstCache *cache;           // look proven-optimal trees up here first and store new ones (NULL = no cache;
+                                // not used with shards, checkpoints or resume)
+
+    // Optional trace callbacks (user is passed back); with threads > 1 on_improve runs on the worker threads
+    void (*on_tree)(void *user, long long index, const Edge *tree, int k, const int *degree, int leaves); // enumerate
+    void (*on_improve)(void *user, int leaves);
+    void *user;
+} MlstExactOptions;
+
+// Defaults: branch and bound on the calling thread, no limits, no checkpoints, no callbacks
+void mlst_exact_options_init(MlstExactOptions *opt);
+
+/*
+Kernelization (MlstExactOptions.kernelize, MlstApproxOptions.kernelize)
+
+- Every spanning tree is the union of one spanning tree per biconnected block, and a cut vertex
+  is never a leaf. The exact search therefore solves each block on its own, with its cut vertices
+  pinned as internal, and adds up the leaves. Bridges, which include the edges of pendant nodes,
+  are forced into the tree without a search.
+- A spanning tree leaves out at most one edge of a chain of degree-2 nodes. Leaving out an inner
+  edge is never worse than leaving out an end edge, and every inner edge gives the same leaves.
+  A chain of k >= 3 nodes is therefore shortened to its two end nodes joined by one edge, and the
+  tree of the shorter graph is lifted back with the same leaf count.
+
+With kernelize the exact limits (MLST_EXACT_MAX_NODES/EDGES) apply to each reduced block, not to
+the whole graph. Sharding, checkpoints and resume cannot be combined with it (they rank the
+combinations of the whole graph). A time limit covers all blocks together, and the trace
+callbacks are not called. The approximation only shortens chains, so its 2-approximation
+guarantee still holds for the original graph. Ties may be broken differently than without it.
+*/
+
+/**
+ * Finds a spanning tree with the most leaves (ties go to the lexicographically first edge set,
+ * except with MLST_EXACT_CDS, which builds its tree from the first minimum dominating set it finds,
+ * and MLST_EXACT_GRAY, which keeps the first tree in its order that reaches the upper bound).
+ * Every method stops as soon as a tree reaches the upper bound (r->exact.bound), so the trace may
+ * end early. A proven-optimal result lowers r->bounds.upper to r->leaves, so its gap is 0.
+ *
+ * @param s     Solver context (scratch buffers are reused between calls).
+ * @param g     Graph with at most MLST_EXACT_MAX_NODES nodes and MLST_EXACT_MAX_EDGES edges
+ *              (any number of edges for MLST_EXACT_CDS).
+ * @param opt   Method and run control (NULL = defaults).
+ * @param tree  Receives the n-1 tree edges (may be NULL when only the counts are needed).
+ * @param r     Receives the leaf count and the search counters.
+ * @return MLST_OK, also when the graph has no spanning tree (r->leaves is then -1), or an error code.
+ */
+int mlst_solve_exact(MlstSolver *s, const MlstGraph *g, const MlstExactOptions *opt, Edge *tree, MlstResult *r);
+
+typedef struct {
+    int improve;                // run the edge-swap local search after the approximation
+    double improve_time;        // local search budget per start (seconds, 0 = none)
+    long long improve_iterations; // local search budget per start (candidates, 0 = none)
+    int starts;                 // runs to keep the best of (start 0 is deterministic, the others randomized)
+    int threads;                // threads sharing the starts
+    unsigned long long seed;    // seed of the randomized starts
+    int kernelize;              // shorten degree-2 chains first (see Kernelization above)
+    MlstCache *cache;           // look any stored tree up here first and store new ones (NULL = no cache)
+} MlstApproxOptions;
+
+// Defaults: one deterministic start, no local search
+void mlst_approx_options_init(MlstApproxOptions *opt);
+
+/**
+ * Solis-Oba 2-approximation: a maximally leafy forest connected in tiers, optionally improved by
+ * local search and repeated from several randomized starts. On a disconnected graph the result
+ * is a spanning forest.
+ *
+ * @param s     Solver context (scratch buffers are reused between calls).
+ * @param g     Graph to solve.
+ * @param opt   Local search and multi-start options (NULL = defaults).
+ * @param tree  Receives the tree edges, at most n-1 (may be NULL).
+ * @param r     Receives the leaf count and the forest/local search counters.
+ * @return MLST_OK or an error code.
+ */
+int mlst_solve_approx(MlstSolver *s, const MlstGraph *g, const MlstApproxOptions *opt, Edge *tree, MlstResult *r);
+
+/**
+ * Checks the result of the last mlst_solve_approx on s: the tree must be a spanning tree (forest)
+ * of g, and the leafy forest it was built from must be maximal, which the 2-approximation rests on.
+ * After a kernelized solve the checks run on the reduced graph and its tree, since that is
+ * what the approximation built.
+ *
+ * @param report  Each failed check is described here (NULL = quiet).
+ * @return 1 if every check passed, 0 otherwise.
+ */
+int mlst_verify_approx(MlstSolver *s, const MlstGraph *g, const Edge *tree, int tree_edges, FILE *report);
+
+/**
+ * Upper bounds on the leaves of any spanning tree of g in O(n + m), without solving anything
+ * (both solvers also fill MlstResult.bounds). If an approximation's leaves reach b->upper, the
+ * approximation is optimal and no exact run is needed.
+ *
+ * @return MLST_OK or an error code.
+ */
+int mlst_upper_bounds(const MlstGraph *g, MlstBounds *b);
+
+/*
+Result cache (MlstExactOptions.cache, MlstApproxOptions.cache)
+
+A cache file keeps solved graphs under a canonical labelling, so a graph identical or isomorphic
+to one solved before gets the stored tree back, relabelled to its own node ids, without a search.
+A solve with a cache labels the graph first (individualization-refinement, usually a small part
+of even an approximation's time), looks it up and on a miss solves and stores the spanning tree
+it found, marked proven optimal or not. The exact search only takes proven-optimal trees from the
+cache; the approximation takes the best tree stored, whichever solver found it.
+
+- A hit fills the leaves, the tree and the bounds (MlstResult.cache.hit); the search counters
+  stay zero, the trace callbacks are not called and mlst_verify_approx has nothing to check.
+  Among several optimal trees the stored one is returned, not necessarily the one a search of
+  this graph would pick.
+- Graphs too large or too symmetric to label within a work budget proportional to their size
+  are stored under the labelling reached; only the same graph in the same node order finds them
+  (MlstResult.cache.canonical is 0).
+- Any number of threads and processes may share a cache file; each thread passes the MlstCache
+  it opened or one shared handle. The file is in the machine's byte order.
+*/
+
+// Open the cache file at path, creating it if it does not exist
+// @return MLST_OK, MLST_ERROR_IO if it cannot be opened or is not a cache file, or MLST_ERROR_NO_MEMORY
+int mlst_cache_open(const char *path, MlstCache **cache);
+
+void mlst_cache_close(MlstCache *cache);
+
+/*
+Dynamic graphs (MlstDynamic)
+
+An MlstDynamic keeps a spanning tree of a graph that changes a few edges at a time, so the tree
+stays fresh without rebuilding the graph and solving again. It starts from a tree of any solver
+and keeps the tree in the link-cut tree of the approximation's local search:
+
+- Removing a tree edge splits its tree in two. Both sides are searched at once until the
+  smaller one is known, and the graph edge leaving it that loses the fewest leaves is linked
+  in. Only if no edge crosses does the tree stay split, into a spanning forest.
+- An inserted edge joins two trees of the forest, or else it closes a cycle and is tried as a
+  leaf-improving swap against the best edge on that cycle, in O(log n).
+- Removing an edge outside the tree or adding a self-loop leaves the tree as it is.
+
+An update costs O(log n) amortized, plus the smaller degree of its two nodes to find an edge to
+remove and, when that is a tree edge, the nodes and edges of the smaller side of the cut; it does
+not depend on the size of the rest of the graph. The repairs are local, so after
+many updates the tree may have fewer leaves than a fresh solve of the same graph would find
+(mlst_dynamic_graph gives the graph for one). The node count is fixed; an MlstDynamic is used by
+one thread at a time.
+*/
+
+typedef struct MlstDynamic MlstDynamic;
+
+// One change of a dynamic graph
+typedef struct {
+    int u, v;
+    int insert;                 // 1 = add the edge u-v, 0 = remove one copy of it (one outside the tree if any)
+} MlstEdgeUpdate;
+
+// What a batch of updates did to the tree
+typedef struct {
+    int applied;                // updates applied (all of them, unless one was invalid)
+    int replaced;               // tree edges removed and replaced by an edge across the cut
+    int split;                  // tree edges removed with no edge across the cut (the tree became a forest)
+    int joined;                 // inserted edges that joined two trees of the forest
+    int swaps;                  // inserted edges swapped into the tree for more leaves
+    long long visited;          // nodes searched to find the smaller side of the cuts
+} MlstDynamicStats;
+
+/**
+ * Starts keeping a spanning tree of g under edge updates (g itself is not changed or kept).
+ *
+ * @param tree        Edges of g forming a forest, typically the tree a solver returned for g. Edges
+ *                    of g that join two of its trees are added, so it becomes a spanning forest.
+ * @param tree_edges  Number of tree edges (0 = let the edges of g build a spanning forest).
+ * @return MLST_OK, MLST_ERROR_ARGUMENT if the tree is not a forest of edges of g, or MLST_ERROR_NO_MEMORY.
+ */
+int mlst_dynamic_create(const MlstGraph *g, const Edge *tree, int tree_edges, MlstDynamic **dynamic);
+
+/**
+ * Applies a batch of edge insertions and removals in order, repairing the tree after each one.
+ *
+ * @param stats  Receives what the updates did (may be NULL).
+ * @return MLST_OK, or MLST_ERROR_ARGUMENT at the first update with a node out of range or removing
+ *         an edge the graph does not have (the updates before it stay applied; see stats->applied).
+ */
+int mlst_dynamic_update(MlstDynamic *dynamic, const MlstEdgeUpdate *updates, int count, MlstDynamicStats *stats);
+
+// Leaves of the current tree
+int mlst_dynamic_leaves(const MlstDynamic *dynamic);
+
+// Write the current tree edges (at most n-1, fewer if the graph is disconnected) into tree (may be NULL)
+// @return The number of tree edges.
+int mlst_dynamic_tree(const MlstDynamic *dynamic, Edge *tree);
+
+// Put the current graph into g (reset first; the edges are in no particular order)
+int mlst_dynamic_graph(const MlstDynamic *dynamic, MlstGraph *g);
+
+void mlst_dynamic_destroy(MlstDynamic *dynamic);
+
+// Sharding and checkpoints of the exact branch-and-bound search
+// Combinations of n-1 edges are numbered in lexicographic order (combinatorial number system).
+
+// C(m, k), saturated at ULLONG_MAX
+unsigned long long mlst_count_combinations(int m, int k);
+
+// Rank range [lo, hi) of shard i out of num_shards of total combinations
+void mlst_shard_range(unsigned long long total, int i, int num_shards, unsigned long long *lo, unsigned long long *hi);
+
+// Fingerprint of a graph, stored in shard and checkpoint files so files of another graph are rejected
+unsigned long long mlst_graph_fingerprint(const MlstGraph *g);
+
+// Read a checkpoint written by a search with checkpoint_path set
+int mlst_read_checkpoint(const char *path, MlstCheckpoint *c);
+
+// Result of one shard of the search, as stored in a shard file
+typedef struct {
+    unsigned long long fingerprint;
+    int n, m;
+    int shard, num_shards;
+    unsigned long long rank_lo, rank_hi;
+    long long trees;            // spanning trees reached in this shard
+    int best_leaves;            // -1 if the shard holds no spanning tree
+    unsigned long long best_rank;
+} MlstShardResult;
+
+// Write a shard result (plus the best tree's edges, for people reading the file)
+int mlst_write_shard_result(const char *path, const MlstShardResult *r, const Edge *tree);
+
+int mlst_read_shard_result(const char *path, MlstShardResult *r);
+
+/**
+ * Combines the result files of a sharded search of g into the final answer.
+ * Every shard must be present; problems (and the missing shards, so they can be re-run) are
+ * listed on stderr. The best tree has the most leaves, ties going to the lowest rank.
+ *
+ * @param tree    Receives the n-1 edges of the best tree.
+ * @param leaves  Receives its leaves (-1 if no shard held a spanning tree).
+ * @param trees   Receives the number of spanning trees reached over all shards.
+ * @return 0 if the shards covered the whole search, 1 otherwise.
+ */
+int mlst_merge_shards(char **paths, int count, const MlstGraph *g, Edge *tree, int *leaves, long long *trees);
+
+#endif
@@ -0,0 +1,1549 @@
+/*
+2-approximation algorithm for the maximum leaf spanning tree problem (Solis-Oba), as a library
+
+Key Functions:
+- buildGraph: Builds a compressed sparse row (CSR) graph from an edge list in one pass.
+- addTreeEdge: Adds an edge to the spanning tree under construction.
+- countLeaves: Counts the number of leaf nodes in the tree.
+- dsu_init: Initializes the disjoint set union data structure.
+- dsu_find: Finds the root of a node in the disjoint set union.
+- dsu_union: Merges two nodes in the disjoint set union.
+- bq_*: Bucket queues of vertices keyed on their number of uncovered neighbours.
+- buildLeafyForest: Builds a maximally leafy forest with the expansion rules.
+- connectForest: Joins the forest into a spanning tree (internal-internal, internal-leaf, then leaf-leaf edges).
+- verifyResult: Checks the tree and the maximality of the forest (mlst_verify_approx).
+- improveTree: Optional local search by edge swaps, scored on a link-cut tree.
+- solveOnce / multiStart: One run of the pipeline in its own Workspace; many randomized runs on threads.
+- mlst_dynamic_*: Keeps a tree under edge insertions and removals on the local search's link-cut tree
+  (reconnect repairs a cut tree edge, trySwap tries an inserted edge).
+
+Algorithm:
+- The graph is built from its edge list.
+- A maximally leafy forest is grown: trees start at vertices with >= 3 uncovered neighbours
+  and grow by the expansion rules, with bucket queues picking the next vertex in O(1).
+- The disjoint set union joins the forest trees and the remaining vertices in three tiers of edges.
+- The degrees and leaves of the resulting spanning tree are computed. Total time O(E α(V)).
+
+Every array is carved from an arena of the solver's ApproxContext: the CSR graph and the
+verification buffers from the context's arena, each multi-start thread's Workspace from that
+thread's own arena (so threads never contend on the heap). A solve resets the arenas instead of
+freeing arrays one by one, and once an arena has held the largest graph seen, later solves
+allocate nothing.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "mlst_internal.h"
+
+//compressed sparse row graph: the neighbours of u are adj[offset[u]] .. adj[offset[u + 1] - 1]
+typedef struct {
+    int V;
+    int* offset;    //V + 1 entries
+    int* adj;       //2 * E entries, one per edge endpoint
+    int* next;      //scratch for buildGraph: next free slot of each vertex
+} Graph;
+
+//bucket queue of vertices keyed on their number of uncovered neighbours (neighbours not in the forest)
+//bucket k is a doubly linked list threaded through bucketNext/bucketPrev; a vertex is in at most one queue
+typedef struct {
+    int* head;      //head[k]: first vertex with key k, -1 if none
+    int maxKey;     //no vertex in the queue has a larger key
+    int size;
+} BucketQueue;
+
+//everything one run of the solver writes: each worker of the multi-start has its own
+typedef struct {
+    int V;
+    //per-vertex arrays
+    int* degree;
+    int* dsu_parent;
+    int* dsu_rank;
+    int* uncovered;         //number of neighbours not (yet) in the leafy forest
+    bool* inForest;
+    int* forestDegree;      //degree in the leafy forest
+    int* bucketNext;
+    int* bucketPrev;
+    BucketQueue** queueOf;  //queue the vertex is in (NULL if none)
+    int* newLeaves;         //children added by the last expansion
+    Edge* treeEdges;        //edges of the spanning tree, collected while it is built
+    int treeSize;
+    int* rootHead;          //bucket heads of the root and leaf queues (keys 0..max degree)
+    int* leafHead;
+
+    //randomized runs: vertex and edge orders drawn from the run's seed (identity orders when not randomized)
+    bool randomize;
+    unsigned long long rng;
+    int* vertexOrder;
+    int* edgeOrder;
+
+    //link-cut tree over the spanning tree, used by the local search to find the best edge on a tree path
+    //nodes 0..V-1 are the vertices, node V + s is tree edge slot s (treeEdges[s]); a tree edge u-v is
+    //stored as the two links u - (V + s) - v, so a path aggregate over nodes is an aggregate over edges
+    //each edge node holds its gain (how many of its endpoints have tree degree 2, i.e. become leaves if
+    //it is removed); vertex nodes hold -1 so they never win a maximum
+    int (*lctChild)[2];
+    int* lctParent;
+    bool* lctFlip;          //pending reversal of the subtree (for makeRoot)
+    int* lctValue;
+    int* lctMax;            //largest value in the splay subtree
+    int* lctMaxNode;        //node holding it
+    int* lctStack;
+    int* treeDegree;        //degree of each vertex in the current tree
+    int* incidentHead;      //per vertex: first incidence (2 * slot + side), -1 if none
+    int* incidentNext;      //per incidence: next / previous incidence of the same vertex
+    int* incidentPrev;
+
+    MlstStats stats;        //instrumentation of every start run in this workspace (STAT_ macros)
+} Workspace;
+
+//options shared by every start of the solver
+typedef struct {
+    bool improve;               //run the local search after the approximation
+    double improveTime;         //local search budget per start (seconds, 0 = none)
+    long long improveIterations; //local search budget per start (candidates, 0 = none)
+} SolveOptions;
+
+//counters reported by the local search
+typedef struct {
+    long long evaluated;    //candidate swaps scored
+    long long swaps;        //swaps kept
+    int passes;             //passes over the edge list
+    bool budgetHit;         //stopped by the time or iteration budget (not at a local optimum)
+} LocalSearchStats;
+
+//what one start produced
+typedef struct {
+    int start;
+    int leaves;
+    int leavesBefore;           //leaves before the local search
+    int forestVertices, forestEdges, forestLeaves;
+    LocalSearchStats ls;
+} RunResult;
+
+//starts handed out to the threads of a multi-start run
+typedef struct {
+    Graph* g;
+    const Edge* edges;
+    int m;
+    unsigned long long seed;
+    int starts;
+    const SolveOptions* opt;
+    atomic_int nextStart;
+} MultiStart;
+
+//one thread of a multi-start run, with its own workspace and its own best tree
+typedef struct {
+    MultiStart* ms;
+    Workspace w;
+    Arena arena;                //holds the workspace and the best tree, reset by every solve
+    pthread_t thread;
+    bool started;               //thread was created (worker 0 runs on the calling thread)
+    RunResult best;             //best.start < 0 until the first start is done
+    Edge* bestTree;
+    int bestTreeSize;
+    bool* bestInForest;         //forest of the best run (for verification)
+    int* bestForestDegree;
+} StartWorker;
+
+//the approximation's share of a solver context
+struct ApproxContext {
+    Arena arena;                //holds graph, tree and stamp, reset by every solve and verification
+    Graph graph;                //CSR form of the graph being solved
+    Graph tree;                 //CSR form of a tree being verified
+    StartWorker* workers;
+    int workerCount;            //workers with initialized workspaces
+    int workerCapacity;
+    int last;                   //worker holding the forest of the last solve (-1 if none)
+    int lastV;
+    int* stamp;                 //verification scratch
+};
+
+//count items of size bytes from the arena into *p; false if out of memory
+static bool carve(Arena* a, void* p, size_t count, size_t size) {
+    *(void**)p = arena_alloc(a, count * size);
+    return *(void**)p != NULL;
+}
+
+//carves the arrays of a workspace for a graph with V vertices, m edges and vertex degrees up to maxKey
+//Time: O(1)
+static bool workspaceCarve(Workspace* w, Arena* a, int V, int m, int maxKey) {
+    size_t n = (size_t)V;
+    size_t nodes = 2 * n; //link-cut tree nodes: the vertices plus up to V - 1 tree edges
+    if (!carve(a, &w->degree, n, sizeof(int)) ||
+        !carve(a, &w->dsu_parent, n, sizeof(int)) ||
+        !carve(a, &w->dsu_rank, n, sizeof(int)) ||
+        !carve(a, &w->uncovered, n, sizeof(int)) ||
+        !carve(a, &w->inForest, n, sizeof(bool)) ||
+        !carve(a, &w->forestDegree, n, sizeof(int)) ||
+        !carve(a, &w->bucketNext, n, sizeof(int)) ||
+        !carve(a, &w->bucketPrev, n, sizeof(int)) ||
+        !carve(a, &w->queueOf, n, sizeof(BucketQueue*)) ||
+        !carve(a, &w->newLeaves, n, sizeof(int)) ||
+        !carve(a, &w->treeEdges, n, sizeof(Edge)) || //a spanning tree has at most V - 1 edges
+        !carve(a, &w->vertexOrder, n, sizeof(int)) ||
+        !carve(a, &w->edgeOrder, (size_t)m, sizeof(int)) ||
+        !carve(a, &w->lctChild, nodes, sizeof(*w->lctChild)) ||
+        !carve(a, &w->lctParent, nodes, sizeof(int)) ||
+        !carve(a, &w->lctFlip, nodes, sizeof(bool)) ||
+        !carve(a, &w->lctValue, nodes, sizeof(int)) ||
+        !carve(a, &w->lctMax, nodes, sizeof(int)) ||
+        !carve(a, &w->lctMaxNode, nodes, sizeof(int)) ||
+        !carve(a, &w->lctStack, nodes, sizeof(int)) ||
+        !carve(a, &w->treeDegree, n, sizeof(int)) ||
+        !carve(a, &w->incidentHead, n, sizeof(int)) ||
+        !carve(a, &w->incidentNext, nodes, sizeof(int)) ||
+        !carve(a, &w->incidentPrev, nodes, sizeof(int)) ||
+        !carve(a, &w->rootHead, (size_t)maxKey + 1, sizeof(int)) ||
+        !carve(a, &w->leafHead, (size_t)maxKey + 1, sizeof(int)))
+        return false;
+    w->V = V;
+    return true;
+}
+
+//splitmix64: the random number generator of randomized runs (one state per workspace)
+static unsigned long long rngNext(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+//shuffles a[0..n-1] (Fisher-Yates)
+static void shuffle(unsigned long long* state, int* a, int n) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(rngNext(state) % (unsigned long long)(i + 1));
+        int t = a[i];
+        a[i] = a[j];
+        a[j] = t;
+    }
+}
+
+//prepares a workspace for one run; seed 0 is the plain deterministic run, any other seed
+//randomizes the order in which roots, leaves and edges are considered
+//Time: O(V + E)
+static void workspaceReset(Workspace* w, int m, unsigned long long seed) {
+    int V = w->V;
+    memset(w->inForest, 0, V * sizeof(bool));
+    memset(w->forestDegree, 0, V * sizeof(int));
+    memset(w->queueOf, 0, V * sizeof(BucketQueue*));
+    w->treeSize = 0;
+    w->randomize = seed != 0;
+    w->rng = seed;
+    for (int v = 0; v < V; v++)
+        w->vertexOrder[v] = v;
+    for (int i = 0; i < m; i++)
+        w->edgeOrder[i] = i;
+    if (w->randomize) {
+        shuffle(&w->rng, w->vertexOrder, V);
+        shuffle(&w->rng, w->edgeOrder, m);
+    }
+}
+
+//builds the CSR form of a graph with V vertices and m undirected edges into graph (arrays from the arena)
+//counts the degrees, turns them into offsets, then places every neighbour in one pass over the edges
+//(in reverse edge order, the order in which prepending to linked lists used to visit them)
+//Time: O(V + E)
+//vertex ids and offsets are 32-bit: the graph may have at most INT_MAX / 2 edges
+static int buildGraph(Graph* graph, Arena* a, int V, const Edge* edges, int m) {
+    if (m > INT_MAX / 2 || V > INT_MAX - 1)
+        return MLST_ERROR_TOO_LARGE;
+    if (!carve(a, &graph->offset, (size_t)V + 1, sizeof(int)) ||
+        !carve(a, &graph->next, (size_t)V + 1, sizeof(int)) ||
+        !carve(a, &graph->adj, 2 * (size_t)m, sizeof(int)))
+        return MLST_ERROR_NO_MEMORY;
+    graph->V = V;
+    memset(graph->offset, 0, ((size_t)V + 1) * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        graph->offset[edges[i].u + 1]++;
+        graph->offset[edges[i].v + 1]++;
+    }
+    for (int i = 0; i < V; i++)
+        graph->offset[i + 1] += graph->offset[i];
+
+    int* next = graph->next;
+    memcpy(next, graph->offset, V * sizeof(int));
+    for (int i = m - 1; i >= 0; i--) {
+        graph->adj[next[edges[i].u]++] = edges[i].v;
+        graph->adj[next[edges[i].v]++] = edges[i].u;
+    }
+    return MLST_OK;
+}
+
+//adds the edge u-v to the spanning tree under construction
+//Time: O(1)
+static void addTreeEdge(Workspace* w, int u, int v) {
+    w->treeEdges[w->treeSize].u = u;
+    w->treeEdges[w->treeSize].v = v;
+    w->treeSize++;
+}
+
+//count the number of leaf nodes (degree 1) in w->degree
+// O(V)
+static int countLeaves(Workspace* w, int V) {
+    int count = 0;
+    for (int i = 0; i < V; i++)
+        if (w->degree[i] == 1)
+            count++;
+    return count;
+}
+
+//initializes an instance of the disjoint set union data struc
+static void dsu_init(Workspace* w, int V) {
+    for (int i = 0; i < V; i++) {
+        w->dsu_parent[i] = i;
+        w->dsu_rank[i] = 0;
+    }
+}
+
+//find the a direct connection from a root to a leaf
+//iterative, with path halving (every visited node skips to its grandparent)
+static int dsu_find(Workspace* w, int u) {
+#ifdef MLST_STATS
+    int steps = 0;
+    for (int x = u; w->dsu_parent[x] != x; x = w->dsu_parent[x])
+        steps++; //path length before halving shortens it
+    w->stats.dsu_finds++;
+    w->stats.dsu_steps += steps;
+    STAT_MAX(w->stats.dsu_longest, steps);
+#endif
+    while (w->dsu_parent[u] != u) {
+        w->dsu_parent[u] = w->dsu_parent[w->dsu_parent[u]];
+        u = w->dsu_parent[u];
+    }
+    return u;
+}
+
+//merges a root to leaf edge while maintaining connectivity
+//union by rank keeps the trees O(log V) deep
+static void dsu_union(Workspace* w, int u, int v) {
+    int ru = dsu_find(w, u);
+    int rv = dsu_find(w, v);
+    if (ru == rv)
+        return;
+    if (w->dsu_rank[ru] < w->dsu_rank[rv]) {
+        int t = ru;
+        ru = rv;
+        rv = t;
+    }
+    w->dsu_parent[rv] = ru;
+    if (w->dsu_rank[ru] == w->dsu_rank[rv])
+        w->dsu_rank[ru]++;
+}
+
+//creates an empty bucket queue for keys 0..maxKey on the bucket heads in head
+//Time: O(maxKey)
+static void bq_init(BucketQueue* q, int* head, int maxKey) {
+    q->head = head;
+    for (int k = 0; k <= maxKey; k++)
+        q->head[k] = -1;
+    q->maxKey = 0;
+    q->size = 0;
+}
+
+//adds v with key uncovered[v]
+//Time: O(1)
+static void bq_insert(Workspace* w, BucketQueue* q, int v) {
+    int k = w->uncovered[v];
+    w->bucketPrev[v] = -1;
+    w->bucketNext[v] = q->head[k];
+    if (q->head[k] >= 0)
+        w->bucketPrev[q->head[k]] = v;
+    q->head[k] = v;
+    if (k > q->maxKey)
+        q->maxKey = k;
+    w->queueOf[v] = q;
+    q->size++;
+}
+
+//removes v from bucket k of its queue
+//Time: O(1)
+static void bq_unlink(Workspace* w, int v, int k) {
+    BucketQueue* q = w->queueOf[v];
+    if (w->bucketPrev[v] >= 0)
+        w->bucketNext[w->bucketPrev[v]] = w->bucketNext[v];
+    else
+        q->head[k] = w->bucketNext[v];
+    if (w->bucketNext[v] >= 0)
+        w->bucketPrev[w->bucketNext[v]] = w->bucketPrev[v];
+    w->queueOf[v] = NULL;
+    q->size--;
+}
+
+//removes v from whatever queue it is in
+//Time: O(1)
+static void bq_remove(Workspace* w, int v) {
+    if (w->queueOf[v])
+        bq_unlink(w, v, w->uncovered[v]);
+}
+
+//returns a vertex with the largest key (without removing it), -1 if the queue is empty
+//the max pointer only moves down here and only moves up on insert, so this is O(1) amortized
+static int bq_max(BucketQueue* q) {
+    if (q->size == 0)
+        return -1;
+    while (q->head[q->maxKey] < 0)
+        q->maxKey--;
+    return q->head[q->maxKey];
+}
+
+//returns a vertex with key exactly k (without removing it), -1 if there is none
+static int bq_any(BucketQueue* q, int k) {
+    return k <= q->maxKey ? q->head[k] : -1;
+}
+
+//puts v in the forest: every neighbour loses one uncovered neighbour (and moves down a bucket)
+//Time: O(deg v)
+static void cover(Workspace* w, Graph* g, int v) {
+    bq_remove(w, v);
+    w->inForest[v] = true;
+    for (int i = g->offset[v]; i < g->offset[v + 1]; i++) {
+        int z = g->adj[i];
+        if (w->queueOf[z]) {
+            BucketQueue* q = w->queueOf[z];
+            bq_unlink(w, z, w->uncovered[z]);
+            w->uncovered[z]--;
+            bq_insert(w, q, z);
+        } else {
+            w->uncovered[z]--;
+        }
+    }
+}
+
+//adds the forest edge parent-child
+//Time: O(1)
+static void attach(Workspace* w, int parentVertex, int child) {
+    addTreeEdge(w, parentVertex, child);
+    w->forestDegree[parentVertex]++;
+    w->forestDegree[child]++;
+}
+
+//makes every uncovered neighbour of x a child of x; the children are the new leaves of the tree
+//returns the number of children (stored in newLeaves)
+//Time: O(deg x + sum of the children's degrees)
+static int expandVertex(Workspace* w, Graph* g, int x) {
+    int count = 0;
+    for (int i = g->offset[x]; i < g->offset[x + 1]; i++) {
+        int z = g->adj[i];
+        if (!w->inForest[z]) {
+            cover(w, g, z);
+            attach(w, x, z);
+            w->newLeaves[count++] = z;
+        }
+    }
+    STAT_ADD(w->stats.expand_considered, g->offset[x + 1] - g->offset[x]);
+    STAT_ADD(w->stats.expand_accepted, count);
+    if (w->randomize)
+        shuffle(&w->rng, w->newLeaves, count); //random order among leaves with the same key
+    return count;
+}
+
+//builds a maximally leafy forest (Solis-Oba):
+//- a new tree starts at an uncovered vertex with >= 3 uncovered neighbours (the largest such count first),
+//  which takes all of them as children
+//- the tree then grows by the expansion rules, rule 1 always before rule 2:
+//  rule 1: a leaf x with >= 2 uncovered neighbours takes all of them as children
+//  rule 2: a leaf x with exactly 1 uncovered neighbour y, where y has >= 2 uncovered neighbours,
+//          takes y as child and y takes all of its uncovered neighbours as children
+//- when no rule applies the tree is done and the next one starts
+//every vertex enters each queue at most once and every cover walks its adjacency once
+//Time: O(V + E)
+static void buildLeafyForest(Workspace* w, Graph* g, int V) {
+    int maxDegree = 0;
+    for (int v = 0; v < V; v++) {
+        w->uncovered[v] = g->offset[v + 1] - g->offset[v];
+        if (w->uncovered[v] > maxDegree)
+            maxDegree = w->uncovered[v];
+    }
+    BucketQueue roots, leaves;
+    bq_init(&roots, w->rootHead, maxDegree);
+    bq_init(&leaves, w->leafHead, maxDegree);
+    for (int i = V - 1; i >= 0; i--)
+        bq_insert(w, &roots, w->vertexOrder[i]); //inserted backwards so equal keys come out in vertexOrder
+
+    int root;
+    while ((root = bq_max(&roots)) >= 0 && w->uncovered[root] >= 3) {
+        cover(w, g, root);
+        int count = expandVertex(w, g, root);
+        for (int i = 0; i < count; i++)
+            bq_insert(w, &leaves, w->newLeaves[i]);
+
+        //grow this tree until no expansion rule applies to any of its leaves
+        while (leaves.size > 0) {
+            int x = bq_max(&leaves);
+            if (w->uncovered[x] >= 2) {
+                //rule 1
+                bq_remove(w, x);
+                count = expandVertex(w, g, x);
+            } else if ((x = bq_any(&leaves, 1)) >= 0) {
+                //rule 2 (if it fails now it never applies later: uncovered counts only go down)
+                bq_remove(w, x);
+                int y = -1;
+                for (int i = g->offset[x]; i < g->offset[x + 1] && y < 0; i++)
+                    if (!w->inForest[g->adj[i]])
+                        y = g->adj[i];
+                STAT_ADD(w->stats.expand_considered, g->offset[x + 1] - g->offset[x]);
+                if (y < 0 || w->uncovered[y] < 2)
+                    continue;
+                cover(w, g, y);
+                attach(w, x, y);
+                STAT_INC(w->stats.expand_accepted);
+                count = expandVertex(w, g, y);
+            } else {
+                //only leaves without uncovered neighbours are left
+                while ((x = bq_max(&leaves)) >= 0)
+                    bq_remove(w, x);
+                continue;
+            }
+            for (int i = 0; i < count; i++)
+                bq_insert(w, &leaves, w->newLeaves[i]);
+        }
+    }
+    while ((root = bq_max(&roots)) >= 0)
+        bq_remove(w, root); //the rest stay single vertices
+}
+
+//connection tier of an edge: how many of its endpoints are leaves of the forest
+//(internal and uncovered vertices do not lose a leaf when the edge is added)
+static int edgeTier(Workspace* w, int u, int v) {
+    return (w->inForest[u] && w->forestDegree[u] == 1) + (w->inForest[v] && w->forestDegree[v] == 1);
+}
+
+//joins the forest trees and the uncovered vertices into a spanning tree (Kruskal in tiers):
+//internal-internal edges first, then internal-leaf, then leaf-leaf, so as few forest leaves as possible are lost
+//Time: O(E α(V))
+static void connectForest(Workspace* w, int V, const Edge* edges, int m) {
+    STAT_TIMER(t);
+    dsu_init(w, V);
+    for (int i = 0; i < w->treeSize; i++)
+        dsu_union(w, w->treeEdges[i].u, w->treeEdges[i].v);
+    STAT_LAP(&w->stats, MLST_PHASE_DSU_INIT, t);
+    for (int tier = 0; tier <= 2; tier++) {
+        for (int i = 0; i < m; i++) {
+            int u = edges[w->edgeOrder[i]].u, v = edges[w->edgeOrder[i]].v;
+            if (edgeTier(w, u, v) == tier && dsu_find(w, u) != dsu_find(w, v)) {
+                dsu_union(w, u, v);
+                addTreeEdge(w, u, v);
+            }
+        }
+    }
+    STAT_LAP(&w->stats, MLST_PHASE_CONNECT, t);
+}
+
+//checks a result: the tree must be a spanning tree (forest, if the graph is disconnected) of the graph,
+//and the leafy forest in w must be maximal (no new tree can start and no expansion rule applies), which is
+//what the 2-approximation guarantee rests on; describes each failed check on report (if not NULL)
+//Time: O(V + E α(V))
+static bool verifyResult(Workspace* w, Graph* g, Graph* tree, const Edge* treeEdges, int treeSize,
+                         int V, const Edge* edges, int m, int* stamp, FILE* report) {
+    bool ok = true;
+
+    //every tree edge is a graph edge (stamp the graph neighbours of u, then look at u's tree neighbours)
+    for (int u = 0; u < V; u++)
+        stamp[u] = -1;
+    for (int u = 0; u < V && ok; u++) {
+        for (int i = g->offset[u]; i < g->offset[u + 1]; i++)
+            stamp[g->adj[i]] = u;
+        for (int i = tree->offset[u]; i < tree->offset[u + 1]; i++) {
+            if (stamp[tree->adj[i]] != u) {
+                if (report)
+                    fprintf(report, "Verify: tree edge %d-%d is not in the graph\n", u, tree->adj[i]);
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    //no cycles, and as many edges as V minus the number of connected components of the graph
+    dsu_init(w, V);
+    int components = V;
+    for (int i = 0; i < m; i++) {
+        if (dsu_find(w, edges[i].u) != dsu_find(w, edges[i].v)) {
+            dsu_union(w, edges[i].u, edges[i].v);
+            components--;
+        }
+    }
+    dsu_init(w, V);
+    for (int i = 0; i < treeSize; i++) {
+        if (dsu_find(w, treeEdges[i].u) == dsu_find(w, treeEdges[i].v)) {
+            if (report)
+                fprintf(report, "Verify: tree edge %d-%d closes a cycle\n", treeEdges[i].u, treeEdges[i].v);
+            ok = false;
+            break;
+        }
+        dsu_union(w, treeEdges[i].u, treeEdges[i].v);
+    }
+    if (treeSize != V - components) {
+        if (report)
+            fprintf(report, "Verify: the tree has %d edges, a spanning tree needs %d\n", treeSize, V - components);
+        ok = false;
+    }
+
+    //maximality of the leafy forest, recounting the uncovered neighbours from scratch
+    for (int v = 0; v < V; v++) {
+        stamp[v] = 0;
+        for (int i = g->offset[v]; i < g->offset[v + 1]; i++)
+            stamp[v] += !w->inForest[g->adj[i]];
+    }
+    for (int v = 0; v < V && ok; v++) {
+        if (!w->inForest[v] && stamp[v] >= 3) {
+            if (report)
+                fprintf(report, "Verify: vertex %d is outside the forest with %d uncovered neighbours\n", v, stamp[v]);
+            ok = false;
+        } else if (w->inForest[v] && w->forestDegree[v] == 1 && stamp[v] >= 2) {
+            if (report)
+                fprintf(report, "Verify: rule 1 still applies to forest leaf %d\n", v);
+            ok = false;
+        } else if (w->inForest[v] && w->forestDegree[v] == 1 && stamp[v] == 1) {
+            for (int i = g->offset[v]; i < g->offset[v + 1]; i++) {
+                int y = g->adj[i];
+                if (!w->inForest[y] && stamp[y] >= 2) {
+                    if (report)
+                        fprintf(report, "Verify: rule 2 still applies to forest leaf %d (through %d)\n", v, y);
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+//recomputes the subtree maximum of x from its value and its children
+static void lct_pull(Workspace* w, int x) {
+    w->lctMax[x] = w->lctValue[x];
+    w->lctMaxNode[x] = x;
+    for (int i = 0; i < 2; i++) {
+        int c = w->lctChild[x][i];
+        if (c >= 0 && w->lctMax[c] > w->lctMax[x]) {
+            w->lctMax[x] = w->lctMax[c];
+            w->lctMaxNode[x] = w->lctMaxNode[c];
+        }
+    }
+}
+
+//applies a pending reversal of x to its children
+static void lct_push(Workspace* w, int x) {
+    if (w->lctFlip[x]) {
+        int t = w->lctChild[x][0];
+        w->lctChild[x][0] = w->lctChild[x][1];
+        w->lctChild[x][1] = t;
+        for (int i = 0; i < 2; i++)
+            if (w->lctChild[x][i] >= 0)
+                w->lctFlip[w->lctChild[x][i]] ^= 1;
+        w->lctFlip[x] = false;
+    }
+}
+
+//true if x is the root of its splay tree (its parent pointer, if any, is a path-parent link)
+static bool lct_isRoot(Workspace* w, int x) {
+    int p = w->lctParent[x];
+    return p < 0 || (w->lctChild[p][0] != x && w->lctChild[p][1] != x);
+}
+
+static void lct_rotate(Workspace* w, int x) {
+    int p = w->lctParent[x], g = w->lctParent[p];
+    int side = w->lctChild[p][1] == x;
+    if (!lct_isRoot(w, p))
+        w->lctChild[g][w->lctChild[g][1] == p] = x;
+    w->lctParent[x] = g;
+    w->lctChild[p][side] = w->lctChild[x][!side];
+    if (w->lctChild[x][!side] >= 0)
+        w->lctParent[w->lctChild[x][!side]] = p;
+    w->lctChild[x][!side] = p;
+    w->lctParent[p] = x;
+    lct_pull(w, p);
+    lct_pull(w, x);
+}
+
+//moves x to the root of its splay tree
+static void lct_splay(Workspace* w, int x) {
+    int top = 0;
+    w->lctStack[top++] = x;
+    for (int y = x; !lct_isRoot(w, y); y = w->lctParent[y])
+        w->lctStack[top++] = w->lctParent[y];
+    while (top > 0)
+        lct_push(w, w->lctStack[--top]); //push reversals down from the splay root first
+    while (!lct_isRoot(w, x)) {
+        int p = w->lctParent[x];
+        if (!lct_isRoot(w, p))
+            lct_rotate(w, (w->lctChild[p][0] == x) == (w->lctChild[w->lctParent[p]][0] == p) ? p : x);
+        lct_rotate(w, x);
+    }
+}
+
+//makes the path from the tree root to x the preferred path; x ends at the root of its splay tree
+//Time: O(log V) amortized
+static void lct_access(Workspace* w, int x) {
+    for (int last = -1, y = x; y >= 0; last = y, y = w->lctParent[y]) {
+        lct_splay(w, y);
+        w->lctChild[y][1] = last;
+        lct_pull(w, y);
+    }
+    lct_splay(w, x);
+}
+
+//makes x the root of its tree
+static void lct_makeRoot(Workspace* w, int x) {
+    lct_access(w, x);
+    w->lctFlip[x] ^= 1;
+}
+
+static void lct_link(Workspace* w, int x, int y) {
+    lct_makeRoot(w, x);
+    w->lctParent[x] = y;
+}
+
+//removes the tree link x-y (they must be adjacent)
+static void lct_cut(Workspace* w, int x, int y) {
+    lct_makeRoot(w, x);
+    lct_access(w, y);
+    w->lctChild[y][0] = -1;
+    w->lctParent[x] = -1;
+    lct_pull(w, y);
+}
+
+//root of the tree holding x (makeRoot changes it, so only compare roots found one after the other)
+static int lct_findRoot(Workspace* w, int x) {
+    lct_access(w, x);
+    int y = x;
+    lct_push(w, y);
+    while (w->lctChild[y][0] >= 0) {
+        y = w->lctChild[y][0];
+        lct_push(w, y);
+    }
+    lct_splay(w, y);
+    return y;
+}
+
+static void lct_setValue(Workspace* w, int x, int value) {
+    lct_access(w, x);
+    w->lctValue[x] = value;
+    lct_pull(w, x);
+}
+
+//gain of tree edge slot s: endpoints with tree degree 2 become leaves when the edge is removed
+static int edgeGain(Workspace* w, int s) {
+    return (w->treeDegree[w->treeEdges[s].u] == 2) + (w->treeDegree[w->treeEdges[s].v] == 2);
+}
+
+//adds incidence 2 * s + side (the side'th endpoint of slot s) to vertex x
+static void incidentAdd(Workspace* w, int x, int h) {
+    w->incidentPrev[h] = -1;
+    w->incidentNext[h] = w->incidentHead[x];
+    if (w->incidentHead[x] >= 0)
+        w->incidentPrev[w->incidentHead[x]] = h;
+    w->incidentHead[x] = h;
+}
+
+static void incidentRemove(Workspace* w, int x, int h) {
+    if (w->incidentPrev[h] >= 0)
+        w->incidentNext[w->incidentPrev[h]] = w->incidentNext[h];
+    else
+        w->incidentHead[x] = w->incidentNext[h];
+    if (w->incidentNext[h] >= 0)
+        w->incidentPrev[w->incidentNext[h]] = w->incidentPrev[h];
+}
+
+//changes the tree degree of x; only when it moves onto or off 2 do the gains of its edges change,
+//and then x has at most 3 edges, so this is O(log V)
+static void setTreeDegree(Workspace* w, int V, int x, int degreeValue) {
+    bool changed = (w->treeDegree[x] == 2) != (degreeValue == 2);
+    w->treeDegree[x] = degreeValue;
+    if (!changed)
+        return;
+    for (int h = w->incidentHead[x]; h >= 0; h = w->incidentNext[h])
+        lct_setValue(w, V + h / 2, edgeGain(w, h / 2));
+}
+
+//puts the tree in w->treeEdges[0..treeSize-1] into the link-cut tree, with the tree degrees, the incidence
+//lists and the gain of every edge (the nodes of the unused slots are left as single nodes)
+//Time: O(V log V)
+static void lctBuild(Workspace* w, int V) {
+    int nodes = 2 * V;
+    for (int x = 0; x < nodes; x++) {
+        w->lctChild[x][0] = w->lctChild[x][1] = w->lctParent[x] = -1;
+        w->lctFlip[x] = false;
+        w->lctValue[x] = -1;
+        lct_pull(w, x);
+    }
+    for (int x = 0; x < V; x++) {
+        w->treeDegree[x] = 0;
+        w->incidentHead[x] = -1;
+    }
+    for (int s = 0; s < w->treeSize; s++) {
+        w->treeDegree[w->treeEdges[s].u]++;
+        w->treeDegree[w->treeEdges[s].v]++;
+        incidentAdd(w, w->treeEdges[s].u, 2 * s);
+        incidentAdd(w, w->treeEdges[s].v, 2 * s + 1);
+    }
+    for (int s = 0; s < w->treeSize; s++) {
+        w->lctValue[V + s] = edgeGain(w, s);
+        lct_pull(w, V + s);
+        lct_link(w, w->treeEdges[s].u, V + s);
+        lct_link(w, V + s, w->treeEdges[s].v);
+    }
+}
+
+//tries the graph edge a-b (a != b, in the same tree) as a swap: adding it closes a cycle; removing the cycle
+//edge with the largest gain changes the leaf count by gain - [a was a leaf] - [b was a leaf], and the swap is
+//kept if that is positive
+//the degrees of a and b are raised before the path query, so the edges at the ends of the cycle are scored
+//with the degrees they would really have
+//returns the leaves gained (0 if the swap was not kept); *slot receives the tree edge slot now holding a-b
+//Time: O(log V) amortized
+static int trySwap(Workspace* w, int V, int a, int b, int* slot) {
+    int loss = (w->treeDegree[a] == 1) + (w->treeDegree[b] == 1);
+    setTreeDegree(w, V, a, w->treeDegree[a] + 1);
+    setTreeDegree(w, V, b, w->treeDegree[b] + 1);
+    lct_makeRoot(w, a);
+    lct_access(w, b);
+    int best = w->lctMaxNode[b];
+    int gain = w->lctMax[b] - loss;
+    if (gain <= 0) {
+        //no gain (this also rejects tree edges and their parallel copies, which score exactly 0)
+        setTreeDegree(w, V, a, w->treeDegree[a] - 1);
+        setTreeDegree(w, V, b, w->treeDegree[b] - 1);
+        return 0;
+    }
+
+    //keep the swap: cut edge slot s = best - V and reuse the slot for a-b
+    int s = best - V;
+    int c = w->treeEdges[s].u, d = w->treeEdges[s].v;
+    lct_cut(w, c, best);
+    lct_cut(w, best, d);
+    incidentRemove(w, c, 2 * s);
+    incidentRemove(w, d, 2 * s + 1);
+    setTreeDegree(w, V, c, w->treeDegree[c] - 1);
+    setTreeDegree(w, V, d, w->treeDegree[d] - 1);
+    w->treeEdges[s].u = a;
+    w->treeEdges[s].v = b;
+    incidentAdd(w, a, 2 * s);
+    incidentAdd(w, b, 2 * s + 1);
+    w->lctValue[best] = edgeGain(w, s);
+    lct_pull(w, best);
+    lct_link(w, a, best);
+    lct_link(w, best, b);
+    *slot = s;
+    return gain;
+}
+
+//local search on the spanning tree in treeEdges: every graph edge a-b not in the tree is tried as a swap
+//(trySwap), each candidate costing O(log V)
+//passes repeat until one finds no improving swap, or until the time (seconds, 0 = none) or
+//iteration (candidates, 0 = none) budget runs out
+static void improveTree(Workspace* w, int V, const Edge* edges, int m, double timeLimit, long long maxIterations,
+                        LocalSearchStats* stats) {
+    lctBuild(w, V);
+
+    memset(stats, 0, sizeof(*stats));
+    double deadline = timeLimit > 0 ? mlst_seconds() + timeLimit : 0;
+    bool improved = true;
+    while (improved && !stats->budgetHit) {
+        improved = false;
+        stats->passes++;
+        for (int i = 0; i < m; i++) {
+            if ((maxIterations > 0 && stats->evaluated >= maxIterations) ||
+                (deadline > 0 && (stats->evaluated & 1023) == 0 && mlst_seconds() > deadline)) {
+                stats->budgetHit = true;
+                break;
+            }
+            int a = edges[w->edgeOrder[i]].u, b = edges[w->edgeOrder[i]].v;
+            if (a == b)
+                continue;
+            stats->evaluated++;
+            int slot;
+            if (trySwap(w, V, a, b, &slot) > 0) {
+                stats->swaps++;
+                improved = true;
+            }
+        }
+    }
+}
+
+//counts the leaves of the tree in w->treeEdges (degrees left in w->degree)
+//Time: O(V)
+static int treeLeaves(Workspace* w) {
+    memset(w->degree, 0, w->V * sizeof(int));
+    for (int i = 0; i < w->treeSize; i++) {
+        w->degree[w->treeEdges[i].u]++;
+        w->degree[w->treeEdges[i].v]++;
+    }
+    return countLeaves(w, w->V);
+}
+
+//runs the whole pipeline once in w: leafy forest, tiered connection and the optional local search
+//start 0 is the plain deterministic run; start i > 0 is randomized with a seed derived from (seed, i),
+//so every start gives the same tree whichever thread runs it
+//Time: O(E α(V)) plus the local search budget
+static void solveOnce(Workspace* w, Graph* g, const Edge* edges, int m, unsigned long long seed, int start,
+                      const SolveOptions* opt, RunResult* r) {
+    unsigned long long runSeed = 0;
+    if (start > 0) {
+        unsigned long long state = seed ^ ((unsigned long long)start << 32);
+        runSeed = rngNext(&state) | 1; //never 0, which means "not randomized"
+    }
+    workspaceReset(w, m, runSeed);
+
+    //phase 1: maximally leafy forest, phase 2: tiered connection into a spanning tree
+    STAT_TIMER(t);
+    buildLeafyForest(w, g, w->V);
+    STAT_LAP(&w->stats, MLST_PHASE_FOREST, t);
+#ifdef MLST_STATS
+    //forest depth: every forest edge was added parent first, so one pass in order finds every depth
+    //(w->degree is free until treeLeaves)
+    memset(w->degree, 0, w->V * sizeof(int));
+    for (int i = 0; i < w->treeSize; i++) {
+        w->degree[w->treeEdges[i].v] = w->degree[w->treeEdges[i].u] + 1;
+        STAT_MAX(w->stats.forest_depth, w->degree[w->treeEdges[i].v]);
+    }
+#endif
+    r->start = start;
+    r->forestEdges = w->treeSize;
+    r->forestVertices = r->forestLeaves = 0;
+    for (int v = 0; v < w->V; v++) {
+        r->forestVertices += w->inForest[v];
+        r->forestLeaves += w->inForest[v] && w->forestDegree[v] == 1;
+    }
+    connectForest(w, w->V, edges, m);
+    STAT_RESTART(t); //connectForest times its own two phases
+    r->leaves = r->leavesBefore = treeLeaves(w);
+    STAT_LAP(&w->stats, MLST_PHASE_LEAF_COUNT, t);
+
+    //optional phase 3: local search by edge swaps
+    memset(&r->ls, 0, sizeof(r->ls));
+    if (opt->improve) {
+        improveTree(w, w->V, edges, m, opt->improveTime, opt->improveIterations, &r->ls);
+        STAT_LAP(&w->stats, MLST_PHASE_LOCAL_SEARCH, t);
+        r->leaves = treeLeaves(w);
+        STAT_LAP(&w->stats, MLST_PHASE_LEAF_COUNT, t);
+    }
+}
+
+//takes starts until none are left, keeping the best tree (a tie keeps the earlier start,
+//since a thread takes its starts in increasing order)
+static void* startWorkerMain(void* arg) {
+    StartWorker* sw = arg;
+    MultiStart* ms = sw->ms;
+    Workspace* w = &sw->w;
+    RunResult r;
+    int start;
+    while ((start = atomic_fetch_add(&ms->nextStart, 1)) < ms->starts) {
+        solveOnce(w, ms->g, ms->edges, ms->m, ms->seed, start, ms->opt, &r);
+        if (sw->best.start < 0 || r.leaves > sw->best.leaves) {
+            sw->best = r;
+            sw->bestTreeSize = w->treeSize;
+            memcpy(sw->bestTree, w->treeEdges, w->treeSize * sizeof(Edge));
+            memcpy(sw->bestInForest, w->inForest, w->V * sizeof(bool));
+            memcpy(sw->bestForestDegree, w->forestDegree, w->V * sizeof(int));
+        }
+    }
+    return NULL;
+}
+
+//sets up the first numThreads workers: each resets its arena and carves its workspace and
+//best-tree arrays for a graph with V vertices and m edges
+static int reserveWorkers(ApproxContext* c, int numThreads, int V, int m, int maxKey) {
+    if (numThreads > c->workerCapacity) {
+        StartWorker* workers = realloc(c->workers, numThreads * sizeof(StartWorker));
+        if (!workers)
+            return MLST_ERROR_NO_MEMORY;
+        c->workers = workers;
+        c->workerCapacity = numThreads;
+    }
+    for (; c->workerCount < numThreads; c->workerCount++)
+        memset(&c->workers[c->workerCount], 0, sizeof(StartWorker));
+    for (int t = 0; t < numThreads; t++) {
+        StartWorker* sw = &c->workers[t];
+        arena_reset(&sw->arena);
+        memset(&sw->w.stats, 0, sizeof(sw->w.stats));
+        if (!workspaceCarve(&sw->w, &sw->arena, V, m, maxKey) ||
+            !carve(&sw->arena, &sw->bestTree, (size_t)V, sizeof(Edge)) ||
+            !carve(&sw->arena, &sw->bestInForest, (size_t)V, sizeof(bool)) ||
+            !carve(&sw->arena, &sw->bestForestDegree, (size_t)V, sizeof(int)))
+            return MLST_ERROR_NO_MEMORY;
+    }
+    return MLST_OK;
+}
+
+//runs starts 0..starts-1 on numThreads threads and leaves the best tree (most leaves, then lowest
+//start index) in the workspace of the returned worker; the result depends only on the seed
+//and the number of starts, not on the number of threads
+static StartWorker* multiStart(ApproxContext* c, Graph* g, const Edge* edges, int m, int V,
+                               unsigned long long seed, int starts, int numThreads, const SolveOptions* opt) {
+    MultiStart ms = {g, edges, m, seed, starts, opt, 0};
+    StartWorker* workers = c->workers;
+    for (int t = 0; t < numThreads; t++) {
+        workers[t].ms = &ms;
+        workers[t].best.start = -1;
+        workers[t].started = false;
+    }
+    //the calling thread is worker 0; a thread that cannot be started leaves its share to the others
+    for (int t = 1; t < numThreads; t++)
+        workers[t].started = pthread_create(&workers[t].thread, NULL, startWorkerMain, &workers[t]) == 0;
+    startWorkerMain(&workers[0]);
+    for (int t = 1; t < numThreads; t++)
+        if (workers[t].started)
+            pthread_join(workers[t].thread, NULL);
+
+    StartWorker* winner = &workers[0];
+    for (int t = 1; t < numThreads; t++) {
+        RunResult* r = &workers[t].best;
+        if (r->start >= 0 && (r->leaves > winner->best.leaves ||
+                              (r->leaves == winner->best.leaves && r->start < winner->best.start)))
+            winner = &workers[t];
+    }
+    //put the winning tree and forest back into its workspace
+    Workspace* w = &winner->w;
+    w->treeSize = winner->bestTreeSize;
+    memcpy(w->treeEdges, winner->bestTree, w->treeSize * sizeof(Edge));
+    memcpy(w->inForest, winner->bestInForest, V * sizeof(bool));
+    memcpy(w->forestDegree, winner->bestForestDegree, V * sizeof(int));
+    return winner;
+}
+
+void approx_context_free(ApproxContext* c) {
+    if (!c)
+        return;
+    for (int t = 0; t < c->workerCount; t++)
+        arena_free(&c->workers[t].arena);
+    free(c->workers);
+    arena_free(&c->arena);
+    free(c);
+}
+
+void mlst_approx_options_init(MlstApproxOptions* opt) {
+    memset(opt, 0, sizeof(*opt));
+    opt->starts = 1;
+    opt->threads = 1;
+    opt->seed = 1;
+}
+
+//the solver's approximation context, created on first use
+static ApproxContext* approxContext(MlstSolver* s) {
+    if (!s->approx) {
+        s->approx = calloc(1, sizeof(ApproxContext));
+        if (s->approx)
+            s->approx->last = -1;
+    }
+    return s->approx;
+}
+
+int mlst_solve_approx(MlstSolver* s, const MlstGraph* g, const MlstApproxOptions* opt, Edge* tree, MlstResult* r) {
+    MlstApproxOptions defaults;
+    if (!opt) {
+        mlst_approx_options_init(&defaults);
+        opt = &defaults;
+    }
+    if (!s || !g || !r || opt->starts < 1 || opt->threads < 1)
+        return MLST_ERROR_ARGUMENT;
+    if (opt->cache)
+        return cache_solve_approx(s, g, opt, tree, r);
+    if (opt->kernelize)
+        return kernel_solve_approx(s, g, opt, tree, r);
+    kernel_forget(s);
+    return approx_solve(s, g, opt, tree, r);
+}
+
+void approx_forget(MlstSolver* s) {
+    kernel_forget(s);
+    if (s->approx)
+        s->approx->last = -1;
+}
+
+int approx_solve(MlstSolver* s, const MlstGraph* g, const MlstApproxOptions* opt, Edge* tree, MlstResult* r) {
+    ApproxContext* c = approxContext(s);
+    if (!c)
+        return MLST_ERROR_NO_MEMORY;
+    c->last = -1;
+    memset(r, 0, sizeof(*r));
+    int V = g->n, m = g->m;
+
+    STAT_TIMER(t);
+    arena_reset(&c->arena);
+    int status = buildGraph(&c->graph, &c->arena, V, g->edges, m); //build the original graph
+    if (status != MLST_OK)
+        return status;
+    STAT_LAP(&r->stats, MLST_PHASE_GRAPH, t);
+    int maxKey = 0;
+    for (int v = 0; v < V; v++)
+        if (c->graph.offset[v + 1] - c->graph.offset[v] > maxKey)
+            maxKey = c->graph.offset[v + 1] - c->graph.offset[v];
+    int numThreads = opt->threads < opt->starts ? opt->threads : opt->starts;
+    status = reserveWorkers(c, numThreads, V, m, maxKey);
+    if (status != MLST_OK)
+        return status;
+
+    //run every start (one start = the plain approximation) and keep the best tree
+    SolveOptions options = {opt->improve != 0, opt->improve_time, opt->improve_iterations};
+    StartWorker* winner = multiStart(c, &c->graph, g->edges, m, V, opt->seed, opt->starts, numThreads, &options);
+    Workspace* w = &winner->w;
+    RunResult* best = &winner->best;
+    c->last = (int)(winner - c->workers);
+    c->lastV = V;
+
+    if (tree)
+        memcpy(tree, w->treeEdges, w->treeSize * sizeof(Edge));
+    r->leaves = best->leaves;
+    r->tree_edges = w->treeSize;
+    r->approx.start = best->start;
+    r->approx.leaves_before = best->leavesBefore;
+    r->approx.forest_vertices = best->forestVertices;
+    r->approx.forest_edges = best->forestEdges;
+    r->approx.forest_leaves = best->forestLeaves;
+    r->approx.ls_evaluated = best->ls.evaluated;
+    r->approx.ls_swaps = best->ls.swaps;
+    r->approx.ls_passes = best->ls.passes;
+    r->approx.ls_budget_hit = best->ls.budgetHit;
+    r->stats.enabled = STATS_ENABLED;
+    for (int i = 0; i < numThreads; i++)
+        stats_add(&r->stats, &c->workers[i].w.stats);
+    STAT_TIMER(boundsStart);
+
+    //upper bounds for the gap: the graph's own, and twice the leaves of a spanning tree (the 2-approximation guarantee)
+    int* scratch = NULL;
+    if (!carve(&c->arena, &scratch, 3 * (size_t)V, sizeof(int)))
+        return MLST_ERROR_NO_MEMORY;
+    graph_bounds(g, 0, scratch, &r->bounds);
+    if (V >= 3 && w->treeSize == V - 1) {
+        r->bounds.approx = 2 * best->leaves;
+        if (r->bounds.approx < r->bounds.upper)
+            r->bounds.upper = r->bounds.approx;
+    }
+    STAT_LAP(&r->stats, MLST_PHASE_BOUNDS, boundsStart);
+    return MLST_OK;
+}
+
+int mlst_verify_approx(MlstSolver* s, const MlstGraph* g, const Edge* tree, int tree_edges, FILE* report) {
+    //a kernelized solve ran the approximation on the reduced graph: check that one
+    const MlstGraph* reduced = s ? kernel_reduced_approx(s, g, &tree, &tree_edges) : NULL;
+    if (reduced)
+        g = reduced;
+    ApproxContext* c = s ? s->approx : NULL;
+    if (!c || c->last < 0 || !g || g->n != c->lastV) {
+        if (report)
+            fprintf(report, "Verify: no approximation of this graph to check\n");
+        return 0;
+    }
+    int V = g->n;
+    for (int i = 0; i < tree_edges; i++) {
+        if (tree[i].u < 0 || tree[i].u >= V || tree[i].v < 0 || tree[i].v >= V) {
+            if (report)
+                fprintf(report, "Verify: tree edge %d-%d is not in the graph\n", tree[i].u, tree[i].v);
+            return 0;
+        }
+    }
+    //the workspace of the last solve lives in its worker's arena, so the context's arena can be reused
+    arena_reset(&c->arena);
+    if (buildGraph(&c->graph, &c->arena, V, g->edges, g->m) != MLST_OK ||
+        buildGraph(&c->tree, &c->arena, V, tree, tree_edges) != MLST_OK ||
+        !carve(&c->arena, &c->stamp, (size_t)V, sizeof(int))) {
+        if (report)
+            fprintf(report, "Verify: out of memory\n");
+        return 0;
+    }
+    Workspace* w = &c->workers[c->last].w;
+    return verifyResult(w, &c->graph, &c->tree, tree, tree_edges, V, g->edges, g->m, c->stamp, report);
+}
+
+//dynamic graphs (mlst_dynamic_*): the tree (a spanning forest while the graph is disconnected) lives in the
+//local search's link-cut tree and tree slots; the graph lives in incidence lists that take an edge in or out in O(1)
+
+//an edge of a dynamic graph; incidence 2 * e + side is the side'th endpoint of edge e
+typedef struct {
+    int u, v;           //u = -1 for a free entry (next[0] is then the next free entry)
+    int next[2];        //next / previous incidence at the same vertex (-1 at the ends of the list)
+    int prev[2];
+    int slot;           //tree slot holding the edge, -1 if it is not in the tree
+} DynamicEdge;
+
+//one side of a cut tree edge, searched breadth first one tree incidence at a time
+typedef struct {
+    int* queue;         //vertices found, in order; queue[head..tail-1] are still to be expanded
+    int head, tail;
+    int h;              //next tree incidence of the vertex being expanded (-1 = take the next vertex)
+    int mark;           //mark[] value of the vertices found
+} CutSide;
+
+struct MlstDynamic {
+    int V;
+    Workspace w;        //only the link-cut tree, the tree slots, the tree degrees and their incidence lists
+    Arena arena;        //holds the per-vertex arrays of w and of the dynamic graph
+    DynamicEdge* edges;
+    int edgeCount;      //entries in use or free
+    int edgeCapacity;
+    int freeEdge;       //first free entry, -1 if none
+    int* adjHead;       //per vertex: first graph incidence, -1 if none
+    int* adjDegree;     //per vertex: graph degree (a self-loop counts twice)
+    int* slotEdge;      //per tree slot: edge it holds, -1 if the slot is free
+    int* freeSlot;      //stack of the free tree slots
+    int freeSlots;
+    int* mark;          //which side of the last cuts a vertex was found on
+    int stamp;          //mark value of the last search
+    int* queue[2];      //queues of the two sides of a cut
+    int leaves;         //vertices of tree degree 1
+};
+
+//carves the per-vertex arrays of a dynamic graph with V vertices
+static bool dynamicCarve(MlstDynamic* d, int V) {
+    Workspace* w = &d->w;
+    Arena* a = &d->arena;
+    size_t n = (size_t)V;
+    size_t nodes = 2 * n;
+    if (!carve(a, &w->treeEdges, n, sizeof(Edge)) ||
+        !carve(a, &w->lctChild, nodes, sizeof(*w->lctChild)) ||
+        !carve(a, &w->lctParent, nodes, sizeof(int)) ||
+        !carve(a, &w->lctFlip, nodes, sizeof(bool)) ||
+        !carve(a, &w->lctValue, nodes, sizeof(int)) ||
+        !carve(a, &w->lctMax, nodes, sizeof(int)) ||
+        !carve(a, &w->lctMaxNode, nodes, sizeof(int)) ||
+        !carve(a, &w->lctStack, nodes, sizeof(int)) ||
+        !carve(a, &w->treeDegree, n, sizeof(int)) ||
+        !carve(a, &w->incidentHead, n, sizeof(int)) ||
+        !carve(a, &w->incidentNext, nodes, sizeof(int)) ||
+        !carve(a, &w->incidentPrev, nodes, sizeof(int)) ||
+        !carve(a, &d->adjHead, n, sizeof(int)) ||
+        !carve(a, &d->adjDegree, n, sizeof(int)) ||
+        !carve(a, &d->slotEdge, n, sizeof(int)) ||
+        !carve(a, &d->freeSlot, n, sizeof(int)) ||
+        !carve(a, &d->mark, n, sizeof(int)) ||
+        !carve(a, &d->queue[0], n, sizeof(int)) ||
+        !carve(a, &d->queue[1], n, sizeof(int)))
+        return false;
+    w->V = V;
+    return true;
+}
+
+//adds the edge u-v to the graph (not to the tree) and stores its entry in *id
+//Time: O(1) amortized
+static int dynamicAddEdge(MlstDynamic* d, int u, int v, int* id) {
+    int e = d->freeEdge;
+    if (e >= 0) {
+        d->freeEdge = d->edges[e].next[0];
+    } else {
+        if (d->edgeCount >= INT_MAX / 2) //incidences 2 * e + 1 must fit in an int
+            return MLST_ERROR_TOO_LARGE;
+        if (mlst_reserve((void**)&d->edges, &d->edgeCapacity, (size_t)d->edgeCount + 1, sizeof(DynamicEdge)) != 0)
+            return MLST_ERROR_NO_MEMORY;
+        e = d->edgeCount++;
+    }
+    DynamicEdge* edge = &d->edges[e];
+    edge->u = u;
+    edge->v = v;
+    edge->slot = -1;
+    for (int side = 0; side < 2; side++) {
+        int x = side ? v : u, h = 2 * e + side;
+        edge->prev[side] = -1;
+        edge->next[side] = d->adjHead[x];
+        if (d->adjHead[x] >= 0)
+            d->edges[d->adjHead[x] / 2].prev[d->adjHead[x] & 1] = h;
+        d->adjHead[x] = h;
+        d->adjDegree[x]++;
+    }
+    *id = e;
+    return MLST_OK;
+}
+
+//takes edge e out of the graph (it must not be in the tree)
+//Time: O(1)
+static void dynamicRemoveEdge(MlstDynamic* d, int e) {
+    DynamicEdge* edge = &d->edges[e];
+    for (int side = 0; side < 2; side++) {
+        int x = side ? edge->v : edge->u, prev = edge->prev[side], next = edge->next[side];
+        if (prev >= 0)
+            d->edges[prev / 2].next[prev & 1] = next;
+        else
+            d->adjHead[x] = next;
+        if (next >= 0)
+            d->edges[next / 2].prev[next & 1] = prev;
+        d->adjDegree[x]--;
+    }
+    edge->u = -1;
+    edge->next[0] = d->freeEdge;
+    d->freeEdge = e;
+}
+
+//an edge u-v of the graph, preferring a copy outside the tree; -1 if there is none
+//Time: O(min(degree of u, degree of v))
+static int dynamicFindEdge(const MlstDynamic* d, int u, int v) {
+    int x = d->adjDegree[u] <= d->adjDegree[v] ? u : v, y = x == u ? v : u;
+    int found = -1;
+    for (int h = d->adjHead[x]; h >= 0; h = d->edges[h / 2].next[h & 1]) {
+        const DynamicEdge* edge = &d->edges[h / 2];
+        if ((h & 1 ? edge->u : edge->v) != y)
+            continue;
+        if (edge->slot < 0)
+            return h / 2;
+        found = h / 2;
+    }
+    return found;
+}
+
+//changes the tree degree of x, keeping the leaf count
+static void dynamicSetDegree(MlstDynamic* d, int x, int degreeValue) {
+    d->leaves += (degreeValue == 1) - (d->w.treeDegree[x] == 1);
+    setTreeDegree(&d->w, d->V, x, degreeValue);
+}
+
+//puts graph edge e into the tree, in a free slot (its ends must be in different trees)
+//Time: O(log V) amortized
+static void treeLink(MlstDynamic* d, int e) {
+    Workspace* w = &d->w;
+    int V = d->V, s = d->freeSlot[--d->freeSlots];
+    int u = d->edges[e].u, v = d->edges[e].v;
+    w->treeEdges[s].u = u;
+    w->treeEdges[s].v = v;
+    incidentAdd(w, u, 2 * s);
+    incidentAdd(w, v, 2 * s + 1);
+    dynamicSetDegree(d, u, w->treeDegree[u] + 1);
+    dynamicSetDegree(d, v, w->treeDegree[v] + 1);
+    w->lctValue[V + s] = edgeGain(w, s);
+    lct_pull(w, V + s);
+    lct_link(w, u, V + s);
+    lct_link(w, V + s, v);
+    d->edges[e].slot = s;
+    d->slotEdge[s] = e;
+}
+
+//takes tree edge e out of the tree (not out of the graph), splitting its tree in two
+//Time: O(log V) amortized
+static void treeCut(MlstDynamic* d, int e) {
+    Workspace* w = &d->w;
+    int V = d->V, s = d->edges[e].slot;
+    int u = w->treeEdges[s].u, v = w->treeEdges[s].v;
+    lct_cut(w, u, V + s);
+    lct_cut(w, V + s, v);
+    incidentRemove(w, u, 2 * s);
+    incidentRemove(w, v, 2 * s + 1);
+    dynamicSetDegree(d, u, w->treeDegree[u] - 1);
+    dynamicSetDegree(d, v, w->treeDegree[v] - 1);
+    d->edges[e].slot = -1;
+    d->slotEdge[s] = -1;
+    d->freeSlot[d->freeSlots++] = s;
+}
+
+//one step of the search of one side of a cut: looks at the next tree incidence of the vertex being expanded
+//returns false once the side has nothing left to expand (it holds its whole tree)
+static bool cutStep(MlstDynamic* d, CutSide* side) {
+    Workspace* w = &d->w;
+    while (side->h < 0) {
+        if (side->head == side->tail)
+            return false;
+        side->h = w->incidentHead[side->queue[side->head++]];
+    }
+    int h = side->h;
+    side->h = w->incidentNext[h];
+    int y = h & 1 ? w->treeEdges[h / 2].u : w->treeEdges[h / 2].v;
+    if (d->mark[y] != side->mark) {
+        d->mark[y] = side->mark;
+        side->queue[side->tail++] = y;
+    }
+    return true;
+}
+
+//after the tree edge x-y was cut: searches both sides at once, one tree incidence at a time, until one runs
+//out; that side is the smaller tree (up to the work of the other search, which is no larger), and the graph
+//edges leaving it are exactly the edges across the cut, since the forest spans every component of the graph
+//the crossing edge that loses the fewest leaves (or gains the most, at a vertex left without tree edges)
+//is linked in; returns false if no edge crosses and the tree stays split
+//Time: O(vertices and graph edges of the smaller side), plus O(log V) for the link
+static bool reconnect(MlstDynamic* d, int x, int y, MlstDynamicStats* stats) {
+    if (d->stamp > INT_MAX - 2) {
+        memset(d->mark, 0, d->V * sizeof(int));
+        d->stamp = 0;
+    }
+    CutSide sides[2] = {{d->queue[0], 0, 1, -1, d->stamp + 1}, {d->queue[1], 0, 1, -1, d->stamp + 2}};
+    d->stamp += 2;
+    sides[0].queue[0] = x;
+    sides[1].queue[0] = y;
+    d->mark[x] = sides[0].mark;
+    d->mark[y] = sides[1].mark;
+    CutSide* small = NULL;
+    while (!small) {
+        if (!cutStep(d, &sides[0]))
+            small = &sides[0];
+        else if (!cutStep(d, &sides[1]))
+            small = &sides[1];
+    }
+    stats->visited += sides[0].tail + sides[1].tail;
+
+    //loop through the graph edges of the smaller side for the best one leaving it
+    int* treeDegree = d->w.treeDegree;
+    int best = -1, bestDelta = INT_MIN;
+    for (int i = 0; i < small->tail && bestDelta < 2; i++) {
+        int a = small->queue[i];
+        for (int h = d->adjHead[a]; h >= 0; h = d->edges[h / 2].next[h & 1]) {
+            const DynamicEdge* edge = &d->edges[h / 2];
+            int b = h & 1 ? edge->u : edge->v;
+            if (d->mark[b] == small->mark)
+                continue; //a tree edge, chord or self-loop inside the side
+            int delta = (treeDegree[a] == 0) - (treeDegree[a] == 1) + (treeDegree[b] == 0) - (treeDegree[b] == 1);
+            if (delta > bestDelta) {
+                bestDelta = delta;
+                best = h / 2;
+            }
+        }
+    }
+    if (best < 0)
+        return false;
+    treeLink(d, best);
+    return true;
+}
+
+int mlst_dynamic_create(const MlstGraph* g, const Edge* tree, int tree_edges, MlstDynamic** dynamic) {
+    if (!dynamic)
+        return MLST_ERROR_ARGUMENT;
+    *dynamic = NULL;
+    if (!g || tree_edges < 0 || (tree_edges > 0 && (!tree || tree_edges >= g->n)))
+        return MLST_ERROR_ARGUMENT;
+    int V = g->n;
+    if (V > INT_MAX / 2) //link-cut tree nodes: the vertices plus a slot per tree edge
+        return MLST_ERROR_TOO_LARGE;
+    MlstDynamic* d = calloc(1, sizeof(MlstDynamic));
+    if (!d)
+        return MLST_ERROR_NO_MEMORY;
+    d->V = V;
+    d->freeEdge = -1;
+    if (!dynamicCarve(d, V)) {
+        mlst_dynamic_destroy(d);
+        return MLST_ERROR_NO_MEMORY;
+    }
+    for (int x = 0; x < V; x++) {
+        d->adjHead[x] = -1;
+        d->adjDegree[x] = 0;
+        d->slotEdge[x] = -1;
+    }
+
+    //the graph, then the given tree, then any edge joining two of its trees (a spanning forest must
+    //span every component, or a cut could miss the edges that cross it); the union-find borrows the
+    //arrays of the cut searches, and the link-cut tree is built once at the end
+    Workspace* w = &d->w;
+    w->dsu_parent = d->mark;
+    w->dsu_rank = d->queue[0];
+    dsu_init(w, V);
+    w->treeSize = 0;
+    int status = MLST_OK;
+    for (int i = 0; i < g->m && status == MLST_OK; i++) {
+        int e;
+        status = dynamicAddEdge(d, g->edges[i].u, g->edges[i].v, &e);
+    }
+    for (int i = 0; i < tree_edges + d->edgeCount && status == MLST_OK; i++) {
+        int e = i - tree_edges;
+        if (i < tree_edges) {
+            int u = tree[i].u, v = tree[i].v;
+            e = u >= 0 && u < V && v >= 0 && v < V ? dynamicFindEdge(d, u, v) : -1;
+            if (e < 0 || u == v || d->edges[e].slot >= 0 || dsu_find(w, u) == dsu_find(w, v)) {
+                status = MLST_ERROR_ARGUMENT; //not an edge of g, or it closes a cycle
+                break;
+            }
+        } else if (d->edges[e].slot >= 0 || dsu_find(w, d->edges[e].u) == dsu_find(w, d->edges[e].v)) {
+            continue;
+        }
+        dsu_union(w, d->edges[e].u, d->edges[e].v);
+        w->treeEdges[w->treeSize].u = d->edges[e].u;
+        w->treeEdges[w->treeSize].v = d->edges[e].v;
+        d->edges[e].slot = w->treeSize;
+        d->slotEdge[w->treeSize++] = e;
+    }
+    if (status != MLST_OK) {
+        mlst_dynamic_destroy(d);
+        return status;
+    }
+    lctBuild(w, V);
+    for (int x = 0; x < V; x++) {
+        d->leaves += w->treeDegree[x] == 1;
+        d->mark[x] = 0;
+    }
+    d->freeSlots = 0;
+    for (int s = V - 1; s >= w->treeSize; s--)
+        d->freeSlot[d->freeSlots++] = s; //the lowest free slot is taken first
+    *dynamic = d;
+    return MLST_OK;
+}
+
+int mlst_dynamic_update(MlstDynamic* d, const MlstEdgeUpdate* updates, int count, MlstDynamicStats* stats) {
+    MlstDynamicStats unused;
+    if (!stats)
+        stats = &unused;
+    memset(stats, 0, sizeof(*stats));
+    if (!d || count < 0 || (count > 0 && !updates))
+        return MLST_ERROR_ARGUMENT;
+    Workspace* w = &d->w;
+    for (int i = 0; i < count; i++) {
+        int x = updates[i].u, y = updates[i].v;
+        if (x < 0 || x >= d->V || y < 0 || y >= d->V)
+            return MLST_ERROR_ARGUMENT;
+        if (updates[i].insert) {
+            //a new edge joins two trees, or closes a cycle and is tried as a leaf-improving swap
+            int e;
+            int status = dynamicAddEdge(d, x, y, &e);
+            if (status != MLST_OK)
+                return status;
+            if (x != y && lct_findRoot(w, x) != lct_findRoot(w, y)) {
+                treeLink(d, e);
+                stats->joined++;
+            } else if (x != y) {
+                int slot;
+                int gain = trySwap(w, d->V, x, y, &slot);
+                if (gain > 0) {
+                    d->edges[d->slotEdge[slot]].slot = -1;
+                    d->edges[e].slot = slot;
+                    d->slotEdge[slot] = e;
+                    d->leaves += gain;
+                    stats->swaps++;
+                }
+            }
+        } else {
+            //a removed tree edge is replaced by an edge across the cut, if there is one
+            int e = dynamicFindEdge(d, x, y);
+            if (e < 0)
+                return MLST_ERROR_ARGUMENT;
+            bool inTree = d->edges[e].slot >= 0;
+            if (inTree)
+                treeCut(d, e);
+            dynamicRemoveEdge(d, e);
+            if (inTree && reconnect(d, x, y, stats))
+                stats->replaced++;
+            else if (inTree)
+                stats->split++;
+        }
+        stats->applied++;
+    }
+    return MLST_OK;
+}
+
+int mlst_dynamic_leaves(const MlstDynamic* d) {
+    return d->leaves;
+}
+
+int mlst_dynamic_tree(const MlstDynamic* d, Edge* tree) {
+    int count = 0;
+    for (int s = 0; s < d->V; s++) {
+        if (d->slotEdge[s] >= 0) {
+            if (tree)
+                tree[count] = d->w.treeEdges[s];
+            count++;
+        }
+    }
+    return count;
+}
+
+int mlst_dynamic_graph(const MlstDynamic* d, MlstGraph* g) {
+    int status = mlst_graph_reset(g, d->V);
+    for (int e = 0; e < d->edgeCount && status == MLST_OK; e++)
+        if (d->edges[e].u >= 0)
+            status = mlst_graph_add_edge(g, d->edges[e].u, d->edges[e].v);
+    return status;
+}
+
+void mlst_dynamic_destroy(MlstDynamic* d) {
+    if (!d)
+        return;
+    arena_free(&d->arena);
+    free(d->edges);
+    free(d);
+}
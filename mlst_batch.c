@@ -0,0 +1,578 @@
+/*
+Batch mode: solves many graphs in one process on a pool of threads
+
+Reads a stream of graphs (one file, pipe or standard input holding many, see graph_io.h) or a
+directory of graph files, and solves every graph with the exact search or the approximation:
+- Each worker thread takes the next graph from the shared source in turn, parses it and solves it
+  with its own MlstSolver and MlstGraph. Both keep their buffers from one graph to the next, so
+  start-up and allocation are paid once per worker instead of once per graph and process.
+- Every graph gets the approximation first. A graph with at most --exact-nodes nodes and
+  --exact-edges edges then gets the exact search under --exact-time, unless the approximation
+  already reached the upper bound (its tree is then optimal). Graphs the exact search cannot take
+  keep the approximation's tree.
+- With --cache, graphs identical or isomorphic to one solved before (by this or an earlier run)
+  get the stored tree instead of a solve, and new results are stored; the workers share one
+  cache handle.
+- One line per graph, tagged with the graph's id, goes to a single output stream: in input order
+  by default (a result that finishes early waits for the ones before it), or as soon as it is
+  ready with --unordered.
+
+Output: a tab-separated line per graph (id, n, m, method, leaves, upper bound, optimal, solve
+seconds, status and, with --tree, the tree edges), or one JSON object per line with --json.
+The method is approx, cds or bnb, or cache when the tree came from the cache.
+The status is ok, timeout (the exact search ran out of time, the best tree so far is reported),
+disconnected (the tree is a spanning forest) or error (the graph could not be read or solved).
+
+Usage:
+    ./mlst_batch [--threads T] [--exact cds|bnb|none] [--exact-nodes N] [--exact-edges M]
+                 [--exact-time S] [--improve] [--starts N] [--seed S] [--kernelize]
+                 [--cache FILE] [--format F] [--dedupe] [--drop-self-loops] [--relabel]
+                 [--json] [--tree] [--unordered] [--out FILE] SOURCE
+*/
+
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mlst.h"
+
+#define MAX_THREADS 256
+
+typedef struct {
+    int threads;
+    int run_exact;
+    MlstExactMethod exact_method;
+    int exact_nodes, exact_edges;   // largest graph handed to the exact search
+    double exact_time;
+    MlstApproxOptions approx;
+    int kernelize;
+    MlstCache *cache;               // shared by the workers (NULL = none)
+    GraphReadOptions read;
+    int json, print_tree, ordered;
+} BatchOptions;
+
+// Where the graphs come from: a stream of graphs or the files of a directory
+typedef struct {
+    pthread_mutex_t lock;
+    GraphStream *stream;
+    const char *dir;
+    struct dirent **files;
+    int file_count;
+    long long next;                 // directory: index of the next file handed out
+    int failed;                     // the stream could not be read to the end
+} Source;
+
+// The single output stream the workers write their lines to
+typedef struct {
+    pthread_mutex_t lock;
+    FILE *f;
+    int ordered;
+    long long next;                 // ordered: index of the next line to write
+    char **pending;                 // ordered: lines that finished before their turn, by index
+    long long pending_cap;
+    long long graphs, exact, cached, optimal, failed;
+} Output;
+
+typedef struct {
+    const BatchOptions *o;
+    Source *source;
+    Output *out;
+    pthread_t thread;
+    int started;
+    // Buffers kept from one graph to the next
+    MlstSolver *solver;
+    MlstGraph *graph;
+    Edge *tree, *exact_tree;
+    int tree_cap;
+    GraphSection section;
+    char *text;                     // the result line being built
+    size_t text_len, text_cap;
+} Worker;
+
+// One graph taken from the source
+typedef struct {
+    long long index;
+    char id[GRAPH_ID_MAX];
+    char path[PATH_MAX];            // directory: the graph's file
+} Job;
+
+// Appends to the worker's result line; returns 1 if out of memory
+static int append(Worker *w, const char *fmt, ...) {
+    va_list ap;
+    // Loop at most twice: format, and again after growing the buffer if it did not fit
+    for (;;) {
+        va_start(ap, fmt);
+        int len = vsnprintf(w->text + w->text_len, w->text_cap - w->text_len, fmt, ap);
+        va_end(ap);
+        if (len < 0)
+            return 1;
+        if (w->text_len + len < w->text_cap) {
+            w->text_len += len;
+            return 0;
+        }
+        size_t cap = w->text_cap ? w->text_cap : 256;
+        while (cap <= w->text_len + len)
+            cap *= 2;
+        char *text = realloc(w->text, cap);
+        if (!text)
+            return 1;
+        w->text = text;
+        w->text_cap = cap;
+    }
+}
+
+// Appends an id as a JSON string (quotes and backslashes escaped, control characters dropped)
+static void append_json_string(Worker *w, const char *s) {
+    append(w, "\"");
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            append(w, "\\%c", *s);
+        else if ((unsigned char)*s >= 0x20)
+            append(w, "%c", *s);
+    }
+    append(w, "\"");
+}
+
+// Hands out the next graph; returns 0 when the source is exhausted
+static int next_job(Worker *w, Job *job) {
+    Source *src = w->source;
+    int found = 0;
+    pthread_mutex_lock(&src->lock);
+    if (src->stream) {
+        int status = graph_stream_next(src->stream, &w->section);
+        if (status > 0) {
+            job->index = w->section.index;
+            snprintf(job->id, sizeof(job->id), "%s", w->section.id);
+            found = 1;
+        } else if (status < 0) {
+            src->failed = 1;
+        }
+    } else if (src->next < src->file_count) {
+        const char *name = src->files[src->next]->d_name;
+        job->index = src->next++;
+        snprintf(job->id, sizeof(job->id), "%.*s", GRAPH_ID_MAX - 1, name); // long names are cut short
+        snprintf(job->path, sizeof(job->path), "%s/%s", src->dir, name);
+        found = 1;
+    }
+    pthread_mutex_unlock(&src->lock);
+    return found;
+}
+
+// Pending slot of a line that was written out of turn (no memory to hold it): the drain steps over it
+static char written_early[1];
+
+// Hands the finished line of graph index to the output, in order unless --unordered
+static void emit(Output *out, long long index, const char *text, size_t len) {
+    pthread_mutex_lock(&out->lock);
+    if (!out->ordered || index == out->next) {
+        fwrite(text, 1, len, out->f);
+        // Loop through the lines that were waiting for this one
+        for (out->next++; out->ordered && out->next < out->pending_cap && out->pending[out->next]; out->next++) {
+            if (out->pending[out->next] != written_early) {
+                fputs(out->pending[out->next], out->f);
+                free(out->pending[out->next]);
+            }
+            out->pending[out->next] = NULL;
+        }
+    } else {
+        if (index >= out->pending_cap) {
+            long long cap = out->pending_cap ? out->pending_cap : 1024;
+            while (cap <= index)
+                cap *= 2;
+            char **pending = realloc(out->pending, cap * sizeof(char *));
+            if (pending) {
+                memset(pending + out->pending_cap, 0, (cap - out->pending_cap) * sizeof(char *));
+                out->pending = pending;
+                out->pending_cap = cap;
+            }
+        }
+        // Without memory to hold the line it is written out of turn rather than lost
+        char *copy = index < out->pending_cap ? strndup(text, len) : NULL;
+        if (copy) {
+            out->pending[index] = copy;
+        } else {
+            fwrite(text, 1, len, out->f);
+            if (index < out->pending_cap)
+                out->pending[index] = written_early;
+        }
+    }
+    pthread_mutex_unlock(&out->lock);
+}
+
+// Writes the lines still pending at the end, in index order (a line written out of turn without
+// a slot to mark it leaves a gap that the drain in emit never gets past)
+static void flush_pending(Output *out) {
+    for (long long i = out->next; i < out->pending_cap; i++) {
+        if (out->pending[i] && out->pending[i] != written_early) {
+            fputs(out->pending[i], out->f);
+            free(out->pending[i]);
+        }
+        out->pending[i] = NULL;
+    }
+}
+
+// Grows the worker's tree buffers to hold a tree of n nodes
+static int reserve_trees(Worker *w, int n) {
+    if (n - 1 <= w->tree_cap)
+        return 0;
+    int cap = n - 1 > 2 * w->tree_cap ? n - 1 : 2 * w->tree_cap;
+    Edge *tree = realloc(w->tree, cap * sizeof(Edge));
+    if (tree)
+        w->tree = tree;
+    Edge *exact_tree = realloc(w->exact_tree, cap * sizeof(Edge));
+    if (exact_tree)
+        w->exact_tree = exact_tree;
+    if (!tree || !exact_tree)
+        return 1;
+    w->tree_cap = cap;
+    return 0;
+}
+
+/**
+ * Reads and solves one graph and builds its output line in w->text.
+ *
+ * @param cached  Set to 1 if the tree came from the cache.
+ * @return 1 if the graph was solved by the exact search, 0 by the approximation (or the cache), -1 on an error.
+ */
+static int solve_job(Worker *w, const Job *job, int *optimal, int *cached) {
+    const BatchOptions *o = w->o;
+    GraphInput input;
+    const char *method = "approx", *status = "ok", *error = NULL;
+    int leaves = -1, upper = -1, tree_edges = 0, n = 0, m = 0, exact = 0;
+    double seconds = 0;
+    const Edge *tree = NULL;
+    *optimal = 0;
+    *cached = 0;
+
+    // Step 1: Read the graph and load it into the worker's graph object
+    int read = w->source->stream ? read_graph_section(w->source->stream, &w->section, &o->read, &input)
+                                 : read_graph_file(job->path, &o->read, &input);
+    if (read != 0) {
+        error = "cannot read the graph";
+    } else {
+        n = input.n;
+        m = input.m;
+        if (n < 1)
+            error = "the graph has no nodes";
+        else if (reserve_trees(w, n) != 0)
+            error = mlst_error_string(MLST_ERROR_NO_MEMORY);
+        else if (mlst_graph_reset(w->graph, n) != MLST_OK || mlst_graph_add_edges(w->graph, input.edges, m) != MLST_OK)
+            error = mlst_error_string(MLST_ERROR_ARGUMENT);
+    }
+
+    // Step 2: Approximation, then the exact search for small graphs it did not already solve
+    if (!error) {
+        double start = mlst_seconds();
+        MlstResult r;
+        int code = mlst_solve_approx(w->solver, w->graph, &o->approx, w->tree, &r);
+        tree = w->tree;
+        if (code != MLST_OK) {
+            error = mlst_error_string(code);
+        } else {
+            leaves = r.leaves;
+            upper = r.bounds.upper;
+            tree_edges = r.tree_edges;
+            *optimal = tree_edges == n - 1 && leaves == upper;
+            *cached = r.cache.hit;
+            if (*cached)
+                method = "cache";
+            if (tree_edges < n - 1)
+                status = "disconnected";
+        }
+        // Kernelized graphs are only limited by their blocks, which the library checks (MLST_ERROR_TOO_LARGE)
+        int fits = o->kernelize ||
+                   (n <= o->exact_nodes && m <= o->exact_edges && n <= MLST_EXACT_MAX_NODES &&
+                    (o->exact_method == MLST_EXACT_CDS || m <= MLST_EXACT_MAX_EDGES));
+        if (!error && o->run_exact && fits && !*optimal && tree_edges == n - 1) {
+            MlstExactOptions eo;
+            mlst_exact_options_init(&eo);
+            eo.method = o->exact_method;
+            eo.time_limit = o->exact_time;
+            eo.kernelize = o->kernelize;
+            eo.cache = o->cache;
+            MlstResult er;
+            // A graph the exact search turns down (too large after all) keeps the approximation
+            if (mlst_solve_exact(w->solver, w->graph, &eo, w->exact_tree, &er) == MLST_OK && er.leaves >= 0) {
+                exact = !er.cache.hit;
+                *cached = er.cache.hit;
+                method = er.cache.hit ? "cache" : o->exact_method == MLST_EXACT_CDS ? "cds" : "bnb";
+                if (er.leaves >= leaves) {
+                    leaves = er.leaves;
+                    tree = w->exact_tree;
+                    tree_edges = er.tree_edges;
+                }
+                if (er.optimal)
+                    upper = er.bounds.upper; // the proven optimum
+                *optimal = er.optimal || leaves == upper;
+                if (er.exact.timed_out && !*optimal)
+                    status = "timeout";
+            }
+        }
+        seconds = mlst_seconds() - start;
+    }
+    if (error) {
+        status = "error";
+        *optimal = 0;
+    }
+
+    // Step 3: Build the output line (tree edges as the ids of the file when relabelled)
+    const long long *labels = read == 0 ? input.labels : NULL;
+    w->text_len = 0;
+    if (o->json) {
+        append(w, "{\"id\": ");
+        append_json_string(w, job->id);
+        append(w, ", \"index\": %lld, \"n\": %d, \"m\": %d, \"method\": \"%s\", \"leaves\": %d, \"upper_bound\": %d, "
+                  "\"optimal\": %s, \"seconds\": %.6f, \"status\": \"%s\"",
+               job->index, n, m, error ? "none" : method, leaves, upper, *optimal ? "true" : "false", seconds, status);
+        if (error)
+            append(w, ", \"error\": \"%s\"", error);
+        if (o->print_tree && !error) {
+            append(w, ", \"tree\": [");
+            for (int i = 0; i < tree_edges; i++)
+                append(w, "%s[%lld, %lld]", i ? ", " : "", labels ? labels[tree[i].u] : tree[i].u,
+                       labels ? labels[tree[i].v] : tree[i].v);
+            append(w, "]");
+        }
+        append(w, "}\n");
+    } else {
+        append(w, "%s\t%d\t%d\t%s\t%d\t%d\t%d\t%.6f\t%s", job->id, n, m, error ? "none" : method, leaves, upper,
+               *optimal, seconds, status);
+        if (o->print_tree && !error) {
+            append(w, "\t");
+            for (int i = 0; i < tree_edges; i++)
+                append(w, "%s%lld-%lld", i ? " " : "", labels ? labels[tree[i].u] : tree[i].u,
+                       labels ? labels[tree[i].v] : tree[i].v);
+        }
+        append(w, "\n");
+    }
+    if (error)
+        fprintf(stderr, "%s: %s\n", job->id, error);
+    if (read == 0)
+        free_graph_input(&input);
+    return error ? -1 : exact;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    Job job;
+    // Loop through the graphs until the source runs dry
+    while (next_job(w, &job)) {
+        int optimal, cached;
+        int solved = solve_job(w, &job, &optimal, &cached);
+        emit(w->out, job.index, w->text, w->text_len);
+        pthread_mutex_lock(&w->out->lock);
+        w->out->graphs++;
+        w->out->exact += solved > 0;
+        w->out->cached += cached;
+        w->out->optimal += optimal;
+        w->out->failed += solved < 0;
+        pthread_mutex_unlock(&w->out->lock);
+    }
+    return NULL;
+}
+
+// Directory entries that are graph files (hidden files and subdirectories are skipped)
+static const char *scan_dir;
+
+static int graph_file(const struct dirent *e) {
+    char path[PATH_MAX];
+    struct stat st;
+    if (e->d_name[0] == '.')
+        return 0;
+    snprintf(path, sizeof(path), "%s/%s", scan_dir, e->d_name);
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+static int usage(const char *prog) {
+    printf("Usage: %s [--threads T] [--exact cds|bnb|none] [--exact-nodes N] [--exact-edges M] [--exact-time S]\n"
+           "          [--improve] [--starts N] [--seed S] [--kernelize] [--cache FILE] [--format F] [--dedupe]\n"
+           "          [--drop-self-loops] [--relabel] [--json] [--tree] [--unordered] [--out FILE] SOURCE\n", prog);
+    printf("  SOURCE             a file of graphs, each after a \"graph ID\" line (\"-\" = stdin), or a directory of\n"
+           "                     graph files (the file name is the id)\n");
+    printf("  --threads T        worker threads (default 0 = all cores)\n");
+    printf("  --exact M          exact method for small graphs (default cds; none = approximation only)\n");
+    printf("  --exact-nodes N    largest graph the exact search gets, in nodes (default 40) and edges (default\n"
+           "  --exact-edges M    no limit for cds, %d for bnb)\n", MLST_EXACT_MAX_EDGES);
+    printf("  --exact-time S     time limit of one exact search (default 10, 0 = none)\n");
+    printf("  --improve, --starts N, --seed S   local search and multi-start of the approximation (per graph)\n");
+    printf("  --kernelize        kernelize every graph first (every graph then gets the exact search, which\n"
+           "                     turns down a graph with a block above %d nodes, or %d edges for bnb; --exact-nodes\n"
+           "                     and --exact-edges are not used)\n", MLST_EXACT_MAX_NODES, MLST_EXACT_MAX_EDGES);
+    printf("  --cache FILE       reuse the trees stored in FILE for identical or isomorphic graphs, and store\n"
+           "                     new results there (created if missing)\n");
+    printf("  --format F         auto (default), edgelist, dimacs or metis, and the clean-up options of brute_force\n");
+    printf("  --json             one JSON object per graph instead of tab-separated columns\n");
+    printf("  --tree             include the tree edges\n");
+    printf("  --unordered        write each result as soon as it is ready instead of in input order\n");
+    printf("  --out FILE         write the results to FILE instead of stdout\n");
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    BatchOptions o = {0, 1, MLST_EXACT_CDS, 40, -1, 10.0, {0}, 0, NULL, {GRAPH_FORMAT_AUTO, 0, 0, 0}, 0, 0, 1};
+    mlst_approx_options_init(&o.approx);
+    const char *source_path = NULL, *out_path = NULL, *cache_path = NULL;
+
+    // Parse the options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            o.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--exact") == 0 && i + 1 < argc) {
+            i++;
+            o.run_exact = strcmp(argv[i], "none") != 0;
+            if (strcmp(argv[i], "cds") == 0)
+                o.exact_method = MLST_EXACT_CDS;
+            else if (strcmp(argv[i], "bnb") == 0)
+                o.exact_method = MLST_EXACT_BNB;
+            else if (o.run_exact)
+                return usage(argv[0]);
+        } else if (strcmp(argv[i], "--exact-nodes") == 0 && i + 1 < argc) {
+            o.exact_nodes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--exact-edges") == 0 && i + 1 < argc) {
+            o.exact_edges = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--exact-time") == 0 && i + 1 < argc && atof(argv[i + 1]) >= 0) {
+            o.exact_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--improve") == 0) {
+            o.approx.improve = 1;
+        } else if (strcmp(argv[i], "--starts") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            o.approx.starts = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            o.approx.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--kernelize") == 0) {
+            o.kernelize = 1;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_path = argv[++i];
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc && graph_format_from_name(argv[i + 1]) >= 0) {
+            o.read.format = graph_format_from_name(argv[++i]);
+        } else if (strcmp(argv[i], "--dedupe") == 0) {
+            o.read.drop_duplicates = 1;
+        } else if (strcmp(argv[i], "--drop-self-loops") == 0) {
+            o.read.drop_self_loops = 1;
+        } else if (strcmp(argv[i], "--relabel") == 0) {
+            o.read.relabel = 1;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            o.json = 1;
+        } else if (strcmp(argv[i], "--tree") == 0) {
+            o.print_tree = 1;
+        } else if (strcmp(argv[i], "--unordered") == 0) {
+            o.ordered = 0;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            if (source_path)
+                return usage(argv[0]);
+            source_path = argv[i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (!source_path)
+        return usage(argv[0]);
+    if (o.threads <= 0)
+        o.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (o.threads <= 0)
+        o.threads = 1;
+    if (o.threads > MAX_THREADS)
+        o.threads = MAX_THREADS;
+    if (o.exact_edges < 0)
+        o.exact_edges = o.exact_method == MLST_EXACT_CDS ? INT_MAX : MLST_EXACT_MAX_EDGES;
+    o.approx.threads = 1; // the graphs are the unit of parallelism
+    o.approx.kernelize = o.kernelize;
+    if (cache_path && mlst_cache_open(cache_path, &o.cache) != MLST_OK) {
+        fprintf(stderr, "Cannot open cache %s (not a cache file, or not writable)\n", cache_path);
+        return 1;
+    }
+    o.approx.cache = o.cache;
+
+    // Open the source: a directory of graph files or a stream of graphs
+    Source source = {PTHREAD_MUTEX_INITIALIZER, NULL, NULL, NULL, 0, 0, 0};
+    struct stat st;
+    if (strcmp(source_path, "-") != 0 && stat(source_path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        scan_dir = source_path;
+        source.dir = source_path;
+        source.file_count = scandir(source_path, &source.files, graph_file, alphasort);
+        if (source.file_count < 0) {
+            perror(source_path);
+            return 1;
+        }
+    } else if (!(source.stream = graph_stream_open(source_path))) {
+        return 1;
+    }
+    Output out = {PTHREAD_MUTEX_INITIALIZER, stdout, o.ordered, 0, NULL, 0, 0, 0, 0, 0, 0};
+    if (out_path && !(out.f = fopen(out_path, "w"))) {
+        perror(out_path);
+        return 1;
+    }
+    if (!o.json)
+        fprintf(out.f, "# id\tn\tm\tmethod\tleaves\tupper\toptimal\tseconds\tstatus%s\n", o.print_tree ? "\ttree" : "");
+
+    // Start the workers (the calling thread is the first one)
+    static Worker workers[MAX_THREADS];
+    double start = mlst_seconds();
+    int count = 0;
+    for (int t = 0; t < o.threads; t++) {
+        Worker *w = &workers[t];
+        w->o = &o;
+        w->source = &source;
+        w->out = &out;
+        w->solver = mlst_solver_create();
+        w->graph = mlst_graph_create(1);
+        if (!w->solver || !w->graph) {
+            mlst_solver_destroy(w->solver);
+            mlst_graph_destroy(w->graph);
+            break;
+        }
+        count++;
+        if (t > 0)
+            w->started = pthread_create(&w->thread, NULL, worker_main, w) == 0;
+    }
+    if (count == 0) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    worker_main(&workers[0]);
+    int threads = 1;
+    for (int t = 1; t < count; t++) {
+        if (workers[t].started) {
+            pthread_join(workers[t].thread, NULL);
+            threads++;
+        }
+    }
+    double elapsed = mlst_seconds() - start;
+
+    // Release the workers' buffers and the source
+    for (int t = 0; t < count; t++) {
+        mlst_solver_destroy(workers[t].solver);
+        mlst_graph_destroy(workers[t].graph);
+        free(workers[t].tree);
+        free(workers[t].exact_tree);
+        free(workers[t].text);
+        graph_section_free(&workers[t].section);
+    }
+    graph_stream_close(source.stream);
+    for (int i = 0; i < source.file_count; i++)
+        free(source.files[i]);
+    free(source.files);
+    flush_pending(&out);
+    free(out.pending);
+    mlst_cache_close(o.cache);
+    if (out.f != stdout)
+        fclose(out.f);
+    else
+        fflush(stdout);
+
+    char cached[64] = "";
+    if (o.cache)
+        snprintf(cached, sizeof(cached), "%lld from the cache, ", out.cached);
+    fprintf(stderr, "Batch: %lld graphs (%lld exact, %s%lld proven optimal, %lld failed) in %.3f s on %d threads\n",
+            out.graphs, out.exact, cached, out.optimal, out.failed, elapsed, threads);
+    if (source.failed)
+        fprintf(stderr, "%s: read error, the rest of the stream was skipped\n", source_path);
+    return out.failed || source.failed ? 2 : 0;
+}
@@ -0,0 +1,862 @@
+/*
+Benchmark of both solvers over generated graph families
+
+Generates parameterised graph families, solves every graph with the 2-approximation and (where it
+is feasible) the exact search, and writes the timings and leaf counts as JSON and/or CSV:
+- Families: Erdős–Rényi G(n, p) (its largest component), random d-regular (pairing model),
+  grids, wheels, complete graphs and caterpillars (a complete binary tree with pendant nodes on
+  every inner node, like Test Case 11 of the approximation program).
+- Every graph runs in a forked child, so the peak RSS reported (getrusage of the child) is the
+  memory of that graph alone, and a crash only loses one row.
+- Each graph is solved --warmup times untimed, then --reps times. Graph construction, the
+  approximation and the exact search are timed separately on the monotonic clock; the median and
+  the minimum over the repetitions are reported.
+- The exact search (minimum connected dominating set search by default, see mlst_cds.c) runs on
+  graphs with at most MLST_EXACT_MAX_NODES nodes under --exact-time, and is not repeated once the
+  repetitions spent that budget. The approximation ratio (approximation leaves / optimal leaves)
+  is only reported when the exact search proved its tree optimal.
+- --baseline compares the run against a CSV file of an earlier version and lists every graph
+  whose median time grew by more than --threshold percent or whose leaf counts changed.
+
+Usage:
+    ./mlst_bench [--quick] [--family er,grid,...] [--graph FAMILY:A[:B]]... [--max-nodes N]
+                 [--reps R] [--warmup W] [--seed S] [--exact cds|bnb|none] [--exact-time S]
+                 [--json FILE] [--csv FILE] [--baseline FILE] [--threshold PCT]
+*/
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "mlst.h"
+
+#define MAX_INSTANCES 256
+#define MAX_REPS 1000
+#define MAX_NAME 64
+#define CONNECT_ATTEMPTS 1000  // pairings drawn before a random regular graph gives up
+
+typedef enum {
+    FAMILY_ER,          // a = nodes, b = average degree
+    FAMILY_REGULAR,     // a = nodes, b = degree
+    FAMILY_GRID,        // a = rows, b = columns
+    FAMILY_WHEEL,       // a = nodes (hub and a rim of a-1)
+    FAMILY_COMPLETE,    // a = nodes
+    FAMILY_CATERPILLAR, // a = height of the binary tree, b = pendant nodes per inner node
+    FAMILY_COUNT
+} Family;
+
+static const char *family_names[FAMILY_COUNT] = {"er", "regular", "grid", "wheel", "complete", "caterpillar"};
+
+typedef struct {
+    Family family;
+    int a, b;
+} Instance;
+
+// Default sweep: the first sizes of each family are small enough for the exact search
+static const Instance default_suite[] = {
+    {FAMILY_COMPLETE, 8, 0}, {FAMILY_COMPLETE, 16, 0}, {FAMILY_COMPLETE, 32, 0}, {FAMILY_COMPLETE, 64, 0},
+    {FAMILY_COMPLETE, 1024, 0},
+    {FAMILY_WHEEL, 16, 0}, {FAMILY_WHEEL, 64, 0}, {FAMILY_WHEEL, 4096, 0}, {FAMILY_WHEEL, 1 << 20, 0},
+    {FAMILY_GRID, 4, 4}, {FAMILY_GRID, 6, 6}, {FAMILY_GRID, 64, 64}, {FAMILY_GRID, 512, 512},
+    {FAMILY_ER, 24, 4}, {FAMILY_ER, 48, 4}, {FAMILY_ER, 64, 8}, {FAMILY_ER, 4096, 8}, {FAMILY_ER, 262144, 8},
+    {FAMILY_REGULAR, 24, 3}, {FAMILY_REGULAR, 48, 3}, {FAMILY_REGULAR, 32, 4}, {FAMILY_REGULAR, 4096, 3},
+    {FAMILY_REGULAR, 262144, 3},
+    {FAMILY_CATERPILLAR, 3, 2}, {FAMILY_CATERPILLAR, 4, 2}, {FAMILY_CATERPILLAR, 12, 2},
+    {FAMILY_CATERPILLAR, 16, 2},
+};
+
+typedef struct {
+    int reps, warmup;
+    unsigned long long seed;
+    MlstExactMethod exact_method;
+    int run_exact;
+    double exact_time;
+} BenchOptions;
+
+// One row of the results; the child fills everything but peak_rss_kb
+typedef struct {
+    char name[MAX_NAME];
+    Family family;
+    int a, b;
+    int status;                 // 0 = ok, 1 = could not be generated, 2 = out of memory, 3 = crashed
+    int n, m;
+    int reps, exact_reps;
+    double generate;            // seconds
+    double build_median, build_min;
+    double approx_median, approx_min;
+    double exact_median, exact_min;
+    int approx_leaves;
+    int upper;                  // upper bound on the leaves (MlstResult.bounds.upper)
+    int exact_leaves;           // -1 if no spanning tree, -2 if the exact search did not run
+    int exact_optimal;
+    long peak_rss_kb;
+} BenchResult;
+
+// splitmix64, so every graph depends only on its family, size and the seed
+static unsigned long long rng_next(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform double in [0, 1)
+static double rng_unit(unsigned long long *state) {
+    return (rng_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void instance_name(const Instance *in, char *name) {
+    switch (in->family) {
+    case FAMILY_ER:
+    case FAMILY_REGULAR:
+        snprintf(name, MAX_NAME, "%s-n%d-d%d", family_names[in->family], in->a, in->b);
+        break;
+    case FAMILY_GRID:
+        snprintf(name, MAX_NAME, "grid-%dx%d", in->a, in->b);
+        break;
+    case FAMILY_CATERPILLAR:
+        snprintf(name, MAX_NAME, "caterpillar-h%d-p%d", in->a, in->b);
+        break;
+    default:
+        snprintf(name, MAX_NAME, "%s-n%d", family_names[in->family], in->a);
+        break;
+    }
+}
+
+// Nodes of an instance before it is generated (the ER graph may keep fewer), -1 if invalid
+static long long instance_nodes(const Instance *in) {
+    switch (in->family) {
+    case FAMILY_ER:
+        return in->a >= 1 && in->b >= 0 ? in->a : -1;
+    case FAMILY_REGULAR:
+        return in->b >= 1 && in->a > in->b && (long long)in->a * in->b % 2 == 0 ? in->a : -1;
+    case FAMILY_GRID:
+        return in->a >= 1 && in->b >= 1 ? (long long)in->a * in->b : -1;
+    case FAMILY_WHEEL:
+        return in->a >= 4 ? in->a : -1;
+    case FAMILY_COMPLETE:
+        return in->a >= 1 && in->a <= 65536 ? in->a : -1;
+    case FAMILY_CATERPILLAR:
+        if (in->a < 0 || in->a > 24 || in->b < 0)
+            return -1;
+        return ((1LL << (in->a + 1)) - 1) + ((1LL << in->a) - 1) * in->b;
+    default:
+        return -1;
+    }
+}
+
+// Growable edge list
+typedef struct {
+    Edge *edges;
+    long long m, capacity;
+} EdgeList;
+
+static int edge_push(EdgeList *l, int u, int v) {
+    if (l->m == l->capacity) {
+        long long capacity = l->capacity ? 2 * l->capacity : 1024;
+        Edge *grown = realloc(l->edges, capacity * sizeof(Edge));
+        if (!grown)
+            return 0;
+        l->edges = grown;
+        l->capacity = capacity;
+    }
+    l->edges[l->m].u = u;
+    l->edges[l->m].v = v;
+    l->m++;
+    return 1;
+}
+
+static int compare_edges(const void *x, const void *y) {
+    const Edge *a = x, *b = y;
+    if (a->u != b->u)
+        return a->u < b->u ? -1 : 1;
+    return a->v < b->v ? -1 : (a->v > b->v);
+}
+
+// Union-find root with path halving
+static int find_root(int *parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+/**
+ * Keeps the largest connected component of the graph, renumbered to 0..n'-1 in node order.
+ *
+ * @return 1 on success, 0 if out of memory.
+ */
+static int keep_largest_component(EdgeList *l, int *n) {
+    int *parent = malloc(*n * sizeof(int));
+    int *size = calloc(*n, sizeof(int));
+    if (!parent || !size) {
+        free(parent);
+        free(size);
+        return 0;
+    }
+    for (int v = 0; v < *n; v++)
+        parent[v] = v;
+    for (long long i = 0; i < l->m; i++) {
+        int a = find_root(parent, l->edges[i].u), b = find_root(parent, l->edges[i].v);
+        if (a != b)
+            parent[a] = b;
+    }
+    int largest = 0;
+    for (int v = 0; v < *n; v++) {
+        int root = find_root(parent, v);
+        if (++size[root] > size[largest] || (size[root] == size[largest] && root < largest))
+            largest = root;
+    }
+    // Reuse size[] as the new ids
+    int kept = 0;
+    for (int v = 0; v < *n; v++)
+        size[v] = find_root(parent, v) == largest ? kept++ : -1;
+    long long k = 0;
+    for (long long i = 0; i < l->m; i++) {
+        if (size[l->edges[i].u] >= 0) {
+            l->edges[k].u = size[l->edges[i].u];
+            l->edges[k].v = size[l->edges[i].v];
+            k++;
+        }
+    }
+    l->m = k;
+    *n = kept;
+    free(parent);
+    free(size);
+    return 1;
+}
+
+/**
+ * G(n, p) with p = degree / (n - 1), drawn by skipping over the node pairs with geometric gaps
+ * (Batagelj and Brandes), so the cost is O(n + m) instead of O(n^2).
+ */
+static int generate_er(EdgeList *l, int n, int degree, unsigned long long *rng) {
+    double p = n > 1 ? (double)degree / (n - 1) : 0;
+    if (p >= 1) {
+        for (int v = 0; v < n; v++)
+            for (int w = v + 1; w < n; w++)
+                if (!edge_push(l, w, v))
+                    return 0;
+        return 1;
+    }
+    if (p <= 0)
+        return 1;
+    double log_q = log(1 - p);
+    long long v = 1, w = -1;
+    while (v < n) {
+        w += 1 + (long long)floor(log(1 - rng_unit(rng)) / log_q);
+        while (w >= v && v < n) {
+            w -= v;
+            v++;
+        }
+        if (v < n && !edge_push(l, (int)v, (int)w))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Random d-regular graph from the pairing model: the n*d edge ends are shuffled and paired up,
+ * and the pairing is drawn again until it has no self-loop or parallel edge.
+ *
+ * @return 1 on success, 0 if out of memory, -1 if no simple pairing came up.
+ */
+static int generate_regular(EdgeList *l, int n, int d, unsigned long long *rng) {
+    long long ends = (long long)n * d;
+    int *point = malloc(ends * sizeof(int));
+    if (!point)
+        return 0;
+    for (int attempt = 0; attempt < CONNECT_ATTEMPTS; attempt++) {
+        for (long long i = 0; i < ends; i++)
+            point[i] = (int)(i / d);
+        for (long long i = ends - 1; i > 0; i--) {
+            long long j = (long long)(rng_next(rng) % (unsigned long long)(i + 1));
+            int t = point[i];
+            point[i] = point[j];
+            point[j] = t;
+        }
+        l->m = 0;
+        int simple = 1;
+        for (long long i = 0; i < ends && simple; i += 2) {
+            int u = point[i], v = point[i + 1];
+            if (u == v)
+                simple = 0;
+            else if (!edge_push(l, u < v ? u : v, u < v ? v : u)) {
+                free(point);
+                return 0;
+            }
+        }
+        if (!simple)
+            continue;
+        // Parallel edges show up next to each other once the pairs are sorted
+        Edge *sorted = malloc(l->m * sizeof(Edge));
+        if (!sorted) {
+            free(point);
+            return 0;
+        }
+        memcpy(sorted, l->edges, l->m * sizeof(Edge));
+        qsort(sorted, l->m, sizeof(Edge), compare_edges);
+        for (long long i = 1; i < l->m && simple; i++)
+            simple = compare_edges(&sorted[i - 1], &sorted[i]) != 0;
+        free(sorted);
+        if (simple) {
+            free(point);
+            return 1;
+        }
+    }
+    free(point);
+    return -1;
+}
+
+/**
+ * Builds the edge list of an instance.
+ *
+ * @param n  Receives the number of nodes.
+ * @return 1 on success, 0 if out of memory, -1 if the instance could not be generated.
+ */
+static int generate(const Instance *in, unsigned long long seed, EdgeList *l, int *n) {
+    long long nodes = instance_nodes(in);
+    if (nodes < 1 || nodes > 1LL << 30)
+        return -1;
+    *n = (int)nodes;
+    unsigned long long rng = seed ^ ((unsigned long long)in->family << 56) ^ ((unsigned long long)in->a << 24) ^
+                             (unsigned long long)in->b;
+    switch (in->family) {
+    case FAMILY_ER:
+        if (!generate_er(l, *n, in->b, &rng))
+            return 0;
+        return keep_largest_component(l, n);
+    case FAMILY_REGULAR:
+        return generate_regular(l, *n, in->b, &rng);
+    case FAMILY_GRID:
+        for (int r = 0; r < in->a; r++) {
+            for (int c = 0; c < in->b; c++) {
+                int v = r * in->b + c;
+                if ((c + 1 < in->b && !edge_push(l, v, v + 1)) || (r + 1 < in->a && !edge_push(l, v, v + in->b)))
+                    return 0;
+            }
+        }
+        return 1;
+    case FAMILY_WHEEL:
+        for (int v = 1; v < *n; v++)
+            if (!edge_push(l, 0, v) || !edge_push(l, v, v + 1 < *n ? v + 1 : 1))
+                return 0;
+        return 1;
+    case FAMILY_COMPLETE:
+        for (int v = 0; v < *n; v++)
+            for (int w = v + 1; w < *n; w++)
+                if (!edge_push(l, v, w))
+                    return 0;
+        return 1;
+    case FAMILY_CATERPILLAR: {
+        // Binary tree in heap order (node v has children 2v+1, 2v+2), pendants numbered after it
+        int tree_nodes = (1 << (in->a + 1)) - 1, inner = (1 << in->a) - 1;
+        int next = tree_nodes;
+        for (int v = 1; v < tree_nodes; v++)
+            if (!edge_push(l, (v - 1) / 2, v))
+                return 0;
+        for (int v = 0; v < inner; v++)
+            for (int p = 0; p < in->b; p++)
+                if (!edge_push(l, v, next++))
+                    return 0;
+        return 1;
+    }
+    default:
+        return -1;
+    }
+}
+
+static int compare_doubles(const void *x, const void *y) {
+    double a = *(const double *)x, b = *(const double *)y;
+    return a < b ? -1 : (a > b);
+}
+
+// Median and minimum of count times (sorts them)
+static void summarize(double *t, int count, double *median, double *min) {
+    if (count == 0) {
+        *median = *min = 0;
+        return;
+    }
+    qsort(t, count, sizeof(double), compare_doubles);
+    *min = t[0];
+    *median = count % 2 ? t[count / 2] : (t[count / 2 - 1] + t[count / 2]) / 2;
+}
+
+/**
+ * Generates and solves one instance (in the child process).
+ *
+ * @param r  Receives the row; r->status tells whether it is complete.
+ */
+static void run_instance(const Instance *in, const BenchOptions *o, BenchResult *r) {
+    static double build[MAX_REPS], approx[MAX_REPS], exact[MAX_REPS];
+    EdgeList l = {0};
+    int n = 0;
+
+    // Step 1: Generate the graph
+    double t0 = mlst_seconds();
+    int generated = generate(in, o->seed, &l, &n);
+    r->generate = mlst_seconds() - t0;
+    if (generated <= 0) {
+        r->status = generated == 0 ? 2 : 1;
+        free(l.edges);
+        return;
+    }
+    r->n = n;
+    r->m = (int)l.m;
+
+    MlstSolver *solver = mlst_solver_create();
+    Edge *tree = malloc((n > 1 ? n : 1) * sizeof(Edge));
+    if (!solver || !tree || l.m > 0x7fffffff) {
+        r->status = 2;
+        goto done;
+    }
+    MlstExactOptions exact_options;
+    mlst_exact_options_init(&exact_options);
+    exact_options.method = o->exact_method;
+    exact_options.time_limit = o->exact_time;
+    int run_exact = o->run_exact && n <= MLST_EXACT_MAX_NODES &&
+                    (o->exact_method == MLST_EXACT_CDS || l.m <= MLST_EXACT_MAX_EDGES);
+    double exact_spent = 0, exact_last = 0;
+    r->exact_leaves = -2;
+
+    // Step 2: Warm-up runs (not recorded), then the timed repetitions
+    for (int rep = -o->warmup; rep < o->reps; rep++) {
+        double start = mlst_seconds();
+        MlstGraph *g = mlst_graph_create(n);
+        if (!g || mlst_graph_add_edges(g, l.edges, r->m) != MLST_OK) {
+            mlst_graph_destroy(g);
+            r->status = 2;
+            goto done;
+        }
+        double built = mlst_seconds();
+        MlstResult result;
+        if (mlst_solve_approx(solver, g, NULL, tree, &result) != MLST_OK) {
+            mlst_graph_destroy(g);
+            r->status = 2;
+            goto done;
+        }
+        double approximated = mlst_seconds();
+        r->approx_leaves = result.leaves;
+        r->upper = result.bounds.upper;
+
+        // The exact search stops repeating once it spent its time budget (one timed run is always made)
+        if (run_exact && (exact_last == 0 || exact_spent + exact_last <= o->exact_time ||
+                          (rep >= 0 && r->exact_reps == 0))) {
+            if (mlst_solve_exact(solver, g, &exact_options, tree, &result) == MLST_OK) {
+                exact_last = mlst_seconds() - approximated;
+                exact_spent += exact_last;
+                r->exact_leaves = result.leaves;
+                r->exact_optimal = result.optimal;
+                if (rep >= 0)
+                    exact[r->exact_reps++] = exact_last;
+            } else {
+                run_exact = 0;
+            }
+        }
+        mlst_graph_destroy(g);
+        if (rep >= 0) {
+            build[rep] = built - start;
+            approx[rep] = approximated - built;
+        }
+    }
+    r->reps = o->reps;
+    summarize(build, o->reps, &r->build_median, &r->build_min);
+    summarize(approx, o->reps, &r->approx_median, &r->approx_min);
+    summarize(exact, r->exact_reps, &r->exact_median, &r->exact_min);
+
+done:
+    free(tree);
+    mlst_solver_destroy(solver);
+    free(l.edges);
+}
+
+/**
+ * Runs one instance in a forked child and collects its row and peak RSS.
+ */
+static void bench_instance(const Instance *in, const BenchOptions *o, BenchResult *r) {
+    memset(r, 0, sizeof(*r));
+    instance_name(in, r->name);
+    r->family = in->family;
+    r->a = in->a;
+    r->b = in->b;
+    r->status = 3;
+    r->exact_leaves = -2;
+
+    int fd[2];
+    if (pipe(fd) != 0) {
+        perror("pipe");
+        return;
+    }
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fd[0]);
+        close(fd[1]);
+        return;
+    }
+    if (pid == 0) {
+        close(fd[0]);
+        BenchResult row = *r;
+        row.status = 0;
+        run_instance(in, o, &row);
+        const char *p = (const char *)&row;
+        size_t left = sizeof(row);
+        while (left > 0) {
+            ssize_t written = write(fd[1], p, left);
+            if (written <= 0 && errno != EINTR)
+                _exit(1);
+            if (written > 0) {
+                p += written;
+                left -= written;
+            }
+        }
+        _exit(0);
+    }
+
+    close(fd[1]);
+    BenchResult row;
+    size_t got = 0;
+    while (got < sizeof(row)) {
+        ssize_t n = read(fd[0], (char *)&row + got, sizeof(row) - got);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        got += n;
+    }
+    close(fd[0]);
+    int wstatus;
+    struct rusage usage;
+    while (wait4(pid, &wstatus, 0, &usage) < 0 && errno == EINTR)
+        ;
+    if (got == sizeof(row))
+        *r = row;
+    r->peak_rss_kb = usage.ru_maxrss; // kilobytes on Linux
+}
+
+static const char *status_names[] = {"ok", "not generated", "out of memory", "crashed"};
+
+static double approx_ratio(const BenchResult *r) {
+    if (r->exact_leaves <= 0 || !r->exact_optimal)
+        return -1;
+    return (double)r->approx_leaves / r->exact_leaves;
+}
+
+static const char *exact_method_name(const BenchOptions *o) {
+    if (!o->run_exact)
+        return "none";
+    return o->exact_method == MLST_EXACT_CDS ? "cds" : "bnb";
+}
+
+static void write_csv(FILE *f, const BenchResult *rows, int count, const BenchOptions *o) {
+    fprintf(f, "name,family,a,b,seed,n,m,reps,generate_s,build_median_s,build_min_s,approx_median_s,"
+               "approx_min_s,approx_leaves,upper_bound,exact_method,exact_reps,exact_median_s,exact_min_s,"
+               "exact_leaves,exact_optimal,approx_ratio,peak_rss_kb,status\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &rows[i];
+        fprintf(f, "%s,%s,%d,%d,%llu,%d,%d,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%d,%d,%s,%d,", r->name,
+                family_names[r->family], r->a, r->b, o->seed, r->n, r->m, r->reps, r->generate, r->build_median,
+                r->build_min, r->approx_median, r->approx_min, r->approx_leaves, r->upper, exact_method_name(o),
+                r->exact_reps);
+        if (r->exact_reps > 0)
+            fprintf(f, "%.9f,%.9f,%d,%d,", r->exact_median, r->exact_min, r->exact_leaves, r->exact_optimal);
+        else
+            fprintf(f, ",,,,");
+        if (approx_ratio(r) >= 0)
+            fprintf(f, "%.6f", approx_ratio(r));
+        fprintf(f, ",%ld,%s\n", r->peak_rss_kb, status_names[r->status]);
+    }
+}
+
+static void write_json(FILE *f, const BenchResult *rows, int count, const BenchOptions *o) {
+    fprintf(f, "{\n  \"seed\": %llu,\n  \"reps\": %d,\n  \"warmup\": %d,\n  \"exact_method\": \"%s\",\n"
+               "  \"exact_time_limit_s\": %g,\n  \"results\": [\n",
+            o->seed, o->reps, o->warmup, exact_method_name(o), o->exact_time);
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &rows[i];
+        fprintf(f, "    {\"name\": \"%s\", \"family\": \"%s\", \"a\": %d, \"b\": %d, \"n\": %d, \"m\": %d, "
+                   "\"status\": \"%s\", \"peak_rss_kb\": %ld,\n",
+                r->name, family_names[r->family], r->a, r->b, r->n, r->m, status_names[r->status], r->peak_rss_kb);
+        fprintf(f, "     \"generate_s\": %.9f, \"build\": {\"median_s\": %.9f, \"min_s\": %.9f},\n", r->generate,
+                r->build_median, r->build_min);
+        fprintf(f, "     \"approx\": {\"median_s\": %.9f, \"min_s\": %.9f, \"leaves\": %d, \"upper_bound\": %d},\n",
+                r->approx_median, r->approx_min, r->approx_leaves, r->upper);
+        if (r->exact_reps > 0)
+            fprintf(f, "     \"exact\": {\"reps\": %d, \"median_s\": %.9f, \"min_s\": %.9f, \"leaves\": %d, "
+                       "\"optimal\": %s},\n",
+                    r->exact_reps, r->exact_median, r->exact_min, r->exact_leaves, r->exact_optimal ? "true" : "false");
+        else
+            fprintf(f, "     \"exact\": null,\n");
+        if (approx_ratio(r) >= 0)
+            fprintf(f, "     \"approx_ratio\": %.6f}%s\n", approx_ratio(r), i + 1 < count ? "," : "");
+        else
+            fprintf(f, "     \"approx_ratio\": null}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+// Splits a CSV line in place; returns the number of fields
+static int split_csv(char *line, char **field, int max) {
+    int count = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    while (count < max) {
+        field[count++] = line;
+        char *comma = strchr(line, ',');
+        if (!comma)
+            break;
+        *comma = '\0';
+        line = comma + 1;
+    }
+    return count;
+}
+
+static int column(char **field, int count, const char *name) {
+    for (int i = 0; i < count; i++)
+        if (strcmp(field[i], name) == 0)
+            return i;
+    return -1;
+}
+
+/**
+ * Compares the rows against a CSV file of an earlier run: a graph regresses when a median time
+ * grew by more than threshold percent (and by more than 1 ms, below which timings are noise) or
+ * its leaf counts changed.
+ *
+ * @return Number of regressions found, -1 if the baseline cannot be read.
+ */
+static int compare_baseline(const char *path, const BenchResult *rows, int count, double threshold) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    char header[1024], line[1024];
+    char *field[64];
+    if (!fgets(header, sizeof(header), f)) {
+        fprintf(stderr, "%s: empty baseline\n", path);
+        fclose(f);
+        return -1;
+    }
+    int columns = split_csv(header, field, 64);
+    int c_name = column(field, columns, "name"), c_approx = column(field, columns, "approx_median_s");
+    int c_exact = column(field, columns, "exact_median_s"), c_leaves = column(field, columns, "approx_leaves");
+    int c_exact_leaves = column(field, columns, "exact_leaves");
+    if (c_name < 0 || c_approx < 0 || c_exact < 0 || c_leaves < 0 || c_exact_leaves < 0) {
+        fprintf(stderr, "%s: not a benchmark CSV file\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    int regressions = 0, matched = 0;
+    while (fgets(line, sizeof(line), f)) {
+        int n = split_csv(line, field, 64);
+        if (n < columns)
+            continue;
+        for (int i = 0; i < count; i++) {
+            const BenchResult *r = &rows[i];
+            if (strcmp(r->name, field[c_name]) != 0 || r->status != 0)
+                continue;
+            matched++;
+            struct {
+                const char *phase;
+                double before, after;
+                int measured;
+            } phases[2] = {{"approx", atof(field[c_approx]), r->approx_median, 1},
+                           {"exact", atof(field[c_exact]), r->exact_median, field[c_exact][0] && r->exact_reps > 0}};
+            for (int p = 0; p < 2; p++) {
+                if (phases[p].measured && phases[p].after > phases[p].before * (1 + threshold / 100) &&
+                    phases[p].after - phases[p].before > 1e-3) {
+                    fprintf(stderr, "REGRESSION %s: %s %.6f s -> %.6f s (%+.1f%%)\n", r->name, phases[p].phase,
+                            phases[p].before, phases[p].after, 100 * (phases[p].after / phases[p].before - 1));
+                    regressions++;
+                }
+            }
+            if (atoi(field[c_leaves]) != r->approx_leaves ||
+                (field[c_exact_leaves][0] && r->exact_reps > 0 && atoi(field[c_exact_leaves]) != r->exact_leaves)) {
+                fprintf(stderr, "CHANGED %s: leaves %s/%s -> %d/%d (approximation/exact)\n", r->name,
+                        field[c_leaves], field[c_exact_leaves], r->approx_leaves, r->exact_leaves);
+                regressions++;
+            }
+        }
+    }
+    fclose(f);
+    fprintf(stderr, "Baseline %s: %d graphs compared, %d regressions\n", path, matched, regressions);
+    return regressions;
+}
+
+static int parse_family(const char *name) {
+    for (int f = 0; f < FAMILY_COUNT; f++)
+        if (strcmp(name, family_names[f]) == 0)
+            return f;
+    return -1;
+}
+
+static int usage(const char *prog) {
+    printf("Usage: %s [--quick] [--family er,regular,grid,wheel,complete,caterpillar] [--graph FAMILY:A[:B]]...\n"
+           "          [--max-nodes N] [--reps R] [--warmup W] [--seed S] [--exact cds|bnb|none] [--exact-time S]\n"
+           "          [--json FILE] [--csv FILE] [--baseline FILE] [--threshold PCT]\n", prog);
+    printf("  --quick            only the graphs the exact search can take (at most %d nodes)\n", MLST_EXACT_MAX_NODES);
+    printf("  --family LIST      only these families of the default sweep\n");
+    printf("  --graph F:A[:B]    benchmark this graph instead of the default sweep (repeatable): er:N:DEGREE,\n"
+           "                     regular:N:DEGREE, grid:ROWS:COLS, wheel:N, complete:N, caterpillar:HEIGHT:PENDANTS\n");
+    printf("  --max-nodes N      skip graphs with more nodes\n");
+    printf("  --reps R           timed repetitions per graph (default 5), after W untimed ones (default 1)\n");
+    printf("  --exact M          exact method for graphs within its limits (default cds)\n");
+    printf("  --exact-time S     time limit of one exact run and budget of its repetitions (default 10)\n");
+    printf("  --json/--csv FILE  write the results (\"-\" = stdout; JSON on stdout if neither is given)\n");
+    printf("  --baseline FILE    compare with the CSV of an earlier run; exit status 3 on a regression\n");
+    printf("  --threshold PCT    slowdown that counts as a regression (default 20)\n");
+    return 1;
+}
+
+// Opens an output file ("-" = stdout)
+static FILE *open_output(const char *path) {
+    if (strcmp(path, "-") == 0)
+        return stdout;
+    FILE *f = fopen(path, "w");
+    if (!f)
+        perror(path);
+    return f;
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions o = {5, 1, 1, MLST_EXACT_CDS, 1, 10.0};
+    static Instance instances[MAX_INSTANCES];
+    static BenchResult rows[MAX_INSTANCES];
+    int count = 0, families = -1, quick = 0;
+    long long max_nodes = -1;
+    const char *json_path = NULL, *csv_path = NULL, *baseline_path = NULL;
+    double threshold = 20;
+
+    // Parse the options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+        } else if (strcmp(argv[i], "--family") == 0 && i + 1 < argc) {
+            families = 0;
+            char list[256];
+            snprintf(list, sizeof(list), "%s", argv[++i]);
+            for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+                int f = parse_family(name);
+                if (f < 0) {
+                    fprintf(stderr, "Unknown family %s\n", name);
+                    return 1;
+                }
+                families |= 1 << f;
+            }
+        } else if (strcmp(argv[i], "--graph") == 0 && i + 1 < argc && count < MAX_INSTANCES) {
+            char spec[128];
+            snprintf(spec, sizeof(spec), "%s", argv[++i]);
+            char *colon = strchr(spec, ':');
+            int f = -1;
+            if (colon) {
+                *colon = '\0';
+                f = parse_family(spec);
+            }
+            Instance in = {f < 0 ? FAMILY_COUNT : (Family)f, 0, 0};
+            if (colon && sscanf(colon + 1, "%d:%d", &in.a, &in.b) >= 1 && instance_nodes(&in) > 0) {
+                instances[count++] = in;
+            } else {
+                fprintf(stderr, "Invalid graph %s (see --help for the parameters of each family)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--max-nodes") == 0 && i + 1 < argc) {
+            max_nodes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 1 &&
+                   atoi(argv[i + 1]) <= MAX_REPS) {
+            o.reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0) {
+            o.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            o.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--exact") == 0 && i + 1 < argc) {
+            i++;
+            o.run_exact = strcmp(argv[i], "none") != 0;
+            if (strcmp(argv[i], "cds") == 0)
+                o.exact_method = MLST_EXACT_CDS;
+            else if (strcmp(argv[i], "bnb") == 0)
+                o.exact_method = MLST_EXACT_BNB;
+            else if (o.run_exact)
+                return usage(argv[0]);
+        } else if (strcmp(argv[i], "--exact-time") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0) {
+            o.exact_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (quick && (max_nodes < 0 || max_nodes > MLST_EXACT_MAX_NODES))
+        max_nodes = MLST_EXACT_MAX_NODES;
+    if (!json_path && !csv_path)
+        json_path = "-";
+
+    // The default sweep, unless graphs were given; then the filters
+    if (count == 0) {
+        for (size_t i = 0; i < sizeof(default_suite) / sizeof(default_suite[0]); i++)
+            instances[count++] = default_suite[i];
+    }
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (families >= 0 && !(families >> instances[i].family & 1))
+            continue;
+        if (max_nodes >= 0 && instance_nodes(&instances[i]) > max_nodes)
+            continue;
+        instances[kept++] = instances[i];
+    }
+    count = kept;
+
+    // Run every graph (progress on stderr)
+    for (int i = 0; i < count; i++) {
+        BenchResult *r = &rows[i];
+        bench_instance(&instances[i], &o, r);
+        fprintf(stderr, "[%d/%d] %-22s n=%-8d m=%-9d approx %d leaves in %.6f s", i + 1, count, r->name, r->n, r->m,
+                r->approx_leaves, r->approx_median);
+        if (r->exact_reps > 0)
+            fprintf(stderr, ", exact %d leaves in %.6f s%s", r->exact_leaves, r->exact_median,
+                    r->exact_optimal ? "" : " (not proven optimal)");
+        fprintf(stderr, ", %ld KB%s%s\n", r->peak_rss_kb, r->status ? ", " : "", r->status ? status_names[r->status] : "");
+    }
+
+    // Write the results
+    int failed = 0;
+    if (json_path) {
+        FILE *f = open_output(json_path);
+        if (f) {
+            write_json(f, rows, count, &o);
+            if (f != stdout)
+                fclose(f);
+        }
+        failed |= !f;
+    }
+    if (csv_path) {
+        FILE *f = open_output(csv_path);
+        if (f) {
+            write_csv(f, rows, count, &o);
+            if (f != stdout)
+                fclose(f);
+        }
+        failed |= !f;
+    }
+    if (failed)
+        return 1;
+    if (baseline_path) {
+        int regressions = compare_baseline(baseline_path, rows, count, threshold);
+        if (regressions != 0)
+            return regressions < 0 ? 1 : 3;
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+Upper bounds on the leaves of a spanning tree, cheap enough to compute next to every solve
+
+- Star: a tree on n >= 3 nodes has at most n-1 leaves, and a node that is pinned or is the only
+  neighbour of a pendant node is never a leaf.
+- Degree: a tree with L leaves and I = n-L internal nodes has degree sum 2(n-1), so its internal
+  nodes carry L + 2I - 2 edge ends, no more than the I largest degrees of the graph allow.
+- Domination: the internal nodes form a connected dominating set, so L <= n - γ(G). Any solution
+  of the dual of the domination LP is a lower bound on γ: y(v) = 1 / (1 + largest degree in N[v])
+  is one, since N[u] holds at most deg(u) + 1 nodes and each of them has y <= 1 / (deg(u) + 1).
+- Approximation: the Solis-Oba tree has at least half the optimal leaves (filled in by mlst_approx.c).
+
+All of them take O(n + m) time and 3n ints of scratch.
+*/
+
+#include <stdlib.h>
+
+#include "mlst_internal.h"
+
+// Flag v as a node that is never a leaf; 1 if it was not counted yet (pinned nodes already are)
+static int mark_internal(int *flag, uint64_t pinned, int v) {
+    if (flag[v] || (v < 64 && (pinned >> v & 1)))
+        return 0;
+    flag[v] = 1;
+    return 1;
+}
+
+void graph_bounds(const MlstGraph *g, uint64_t pinned, int *scratch, MlstBounds *b) {
+    int n = g->n, m = g->m;
+    b->approx = -1;
+    if (n <= 2) {
+        // One node has no leaf, both ends of a single edge are leaves
+        b->star = n == 2 ? 2 - __builtin_popcountll(pinned) : 0;
+        b->degree = b->domination = b->upper = b->star;
+        return;
+    }
+    int *degree = scratch, *largest = scratch + n, *flag = scratch + 2 * n;
+
+    // Step 1: Degrees without self-loops (parallel edges only make the bounds weaker), at most n-1
+    for (int v = 0; v < n; v++)
+        degree[v] = flag[v] = 0;
+    for (int i = 0; i < m; i++) {
+        if (g->edges[i].u != g->edges[i].v) {
+            degree[g->edges[i].u]++;
+            degree[g->edges[i].v]++;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        if (degree[v] > n - 1)
+            degree[v] = n - 1;
+        largest[v] = degree[v];
+    }
+
+    // Step 2: Nodes that are never leaves, and the largest degree next to each node
+    int never = __builtin_popcountll(pinned);
+    for (int i = 0; i < m; i++) {
+        int u = g->edges[i].u, v = g->edges[i].v;
+        if (u == v)
+            continue;
+        if (degree[v] > largest[u])
+            largest[u] = degree[v];
+        if (degree[u] > largest[v])
+            largest[v] = degree[u];
+        if (degree[u] == 1)
+            never += mark_internal(flag, pinned, v);
+        if (degree[v] == 1)
+            never += mark_internal(flag, pinned, u);
+    }
+    b->star = n - 1 < n - never ? n - 1 : n - never;
+
+    // Step 3: Degree bound: the fewest internal nodes I whose largest degrees add up to n + I - 2
+    int *count = flag;
+    for (int d = 0; d < n; d++)
+        count[d] = 0;
+    for (int v = 0; v < n; v++)
+        count[degree[v]]++;
+    b->degree = 0;
+    long long sum = 0;
+    int internal = 0;
+    // Loop over the degrees from the largest down, adding one node at a time
+    for (int d = n - 1; d >= 1 && !b->degree; d--) {
+        for (int c = 0; c < count[d]; c++) {
+            sum += d;
+            internal++;
+            if (sum - internal + 2 >= n) {
+                b->degree = n - internal;
+                break;
+            }
+        }
+    }
+
+    // Step 4: Domination bound from the dual solution y(v) = 1 / (1 + largest[v])
+    double dual = 0;
+    for (int v = 0; v < n; v++)
+        dual += 1.0 / (1 + largest[v]);
+    int dominating = (int)(dual - 1e-9);
+    if (dominating < dual - 1e-9)
+        dominating++;
+    if (dominating < 1)
+        dominating = 1;
+    b->domination = n - dominating;
+
+    b->upper = b->star;
+    if (b->degree < b->upper)
+        b->upper = b->degree;
+    if (b->domination < b->upper)
+        b->upper = b->domination;
+}
+
+int mlst_upper_bounds(const MlstGraph *g, MlstBounds *b) {
+    if (!g || !b)
+        return MLST_ERROR_ARGUMENT;
+    int *scratch = malloc((3 * (size_t)g->n + 1) * sizeof(int));
+    if (!scratch)
+        return MLST_ERROR_NO_MEMORY;
+    graph_bounds(g, 0, scratch, b);
+    free(scratch);
+    return MLST_OK;
+}
@@ -0,0 +1,625 @@
+/*
+Persistent result cache of libmlst (MlstCache in mlst.h)
+
+Solved graphs are kept in one memory-mapped file under their canonical labelling (mlst_canon.c),
+so a graph that is identical or isomorphic to one solved before gets the stored tree back,
+relabelled to its own node ids, instead of being searched again.
+
+File layout (native byte order, every offset from the start of the file):
+- A 64-byte header: magic, version, table size, slots in use and the end of the used bytes.
+- The hash table: 2^slot_bits slots of {key, record offset}, linear probing, key 0 = empty.
+- The records, appended at the end: the key, n, m, the leaves and flags, then the graph's edges
+  under the labelling (the stored graph is compared edge by edge, so a hash collision is never a
+  hit) and the n-1 tree edges in the same labels.
+
+A better result for a graph already stored is appended and its slot pointed at it. When the table
+is 70% full the live records are copied into a new file with twice the slots, which is renamed
+over the old one.
+
+Concurrency: threads sharing an MlstCache take its mutex; processes sharing the file take flock()
+on it (shared to look up, exclusive to store). A process that waited on a file a rebuild has
+since replaced notices the new inode behind the path and switches to it.
+*/
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mlst_internal.h"
+
+#define CACHE_MAGIC "MLSTRC01"
+#define CACHE_VERSION 1
+#define CACHE_SLOT_BITS 12      // slots of a new file
+#define CACHE_MAX_SLOT_BITS 40
+#define CACHE_RECORD_SPACE (1 << 16) // record bytes a new file starts with
+
+// Record flags
+#define RECORD_OPTIMAL 1        // the tree is proven optimal
+#define RECORD_APPROX 2         // the tree came from the approximation (the optimum is at most twice its leaves)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_bits;
+    uint64_t used;              // slots holding a key
+    uint64_t end;               // bytes of the file in use; the next record goes here
+    uint64_t reserved[4];
+} CacheHeader;
+
+typedef struct {
+    uint64_t key;
+    uint64_t offset;
+} CacheSlot;
+
+typedef struct {
+    uint64_t key;
+    int32_t n, m;
+    int32_t leaves;
+    uint32_t flags;
+} CacheRecord;                  // followed by m graph edges and n-1 tree edges
+
+struct MlstCache {
+    pthread_mutex_t lock;
+    char *path;
+    int fd;
+    unsigned char *map;
+    size_t size;                // bytes mapped (the file size when last locked)
+};
+
+// Scratch of the cached solves, one per solver
+struct CacheContext {
+    Arena arena;
+};
+
+void cache_context_free(CacheContext *c) {
+    if (!c)
+        return;
+    arena_free(&c->arena);
+    free(c);
+}
+
+static CacheHeader *header(const MlstCache *c) {
+    return (CacheHeader *)c->map;
+}
+
+static CacheSlot *slots(const MlstCache *c) {
+    return (CacheSlot *)(c->map + sizeof(CacheHeader));
+}
+
+static uint64_t table_end(uint32_t slot_bits) {
+    return sizeof(CacheHeader) + ((uint64_t)sizeof(CacheSlot) << slot_bits);
+}
+
+// Bytes of a record of a graph with n nodes and m edges, rounded up to 8
+static uint64_t record_size(int n, int m) {
+    uint64_t size = sizeof(CacheRecord) + ((uint64_t)m + (n > 0 ? n - 1 : 0)) * sizeof(Edge);
+    return (size + 7) & ~(uint64_t)7;
+}
+
+// Map the whole file (again, if its size changed); 0 on success
+static int remap(MlstCache *c) {
+    struct stat st;
+    if (fstat(c->fd, &st) != 0)
+        return -1;
+    if (c->map && (size_t)st.st_size == c->size)
+        return 0;
+    if (c->map)
+        munmap(c->map, c->size);
+    c->map = NULL;
+    c->size = 0;
+    if (st.st_size < (off_t)sizeof(CacheHeader))
+        return -1;
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    c->map = map;
+    c->size = (size_t)st.st_size;
+    return 0;
+}
+
+// 1 if the mapped file has a header this version can use
+static int header_valid(const MlstCache *c) {
+    const CacheHeader *h = header(c);
+    return memcmp(h->magic, CACHE_MAGIC, 8) == 0 && h->version == CACHE_VERSION && h->slot_bits >= 4 &&
+           h->slot_bits <= CACHE_MAX_SLOT_BITS && table_end(h->slot_bits) <= h->end && h->end <= c->size &&
+           h->used < ((uint64_t)1 << h->slot_bits);
+}
+
+// Write an empty table of 2^slot_bits slots (and room for records) into the empty file fd
+static int format_file(int fd, uint32_t slot_bits, uint64_t record_space) {
+    uint64_t size = table_end(slot_bits) + record_space;
+    if (ftruncate(fd, (off_t)size) != 0)
+        return -1;
+    CacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CACHE_MAGIC, 8);
+    h.version = CACHE_VERSION;
+    h.slot_bits = slot_bits;
+    h.end = table_end(slot_bits);
+    return pwrite(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) ? 0 : -1;
+}
+
+/**
+ * Lock the file and map all of it. If a rebuild renamed a new file over the path while this
+ * process waited, the lock is on a dead file: switch to the new one and lock that instead.
+ *
+ * @return 0 with the file locked, -1 on an error (nothing locked).
+ */
+static int lock_file(MlstCache *c, int exclusive) {
+    for (;;) {
+        if (flock(c->fd, exclusive ? LOCK_EX : LOCK_SH) != 0)
+            return -1;
+        struct stat held, named;
+        if (fstat(c->fd, &held) != 0)
+            break;
+        if (stat(c->path, &named) == 0 && (named.st_ino != held.st_ino || named.st_dev != held.st_dev)) {
+            int fd = open(c->path, O_RDWR);
+            if (fd < 0)
+                break;
+            flock(c->fd, LOCK_UN);
+            close(c->fd);
+            if (c->map)
+                munmap(c->map, c->size);
+            c->map = NULL;
+            c->size = 0;
+            c->fd = fd;
+            continue;
+        }
+        if (remap(c) != 0 || !header_valid(c))
+            break;
+        return 0;
+    }
+    flock(c->fd, LOCK_UN);
+    return -1;
+}
+
+static void unlock_file(MlstCache *c) {
+    flock(c->fd, LOCK_UN);
+}
+
+int mlst_cache_open(const char *path, MlstCache **cache) {
+    if (!path || !cache)
+        return MLST_ERROR_ARGUMENT;
+    *cache = NULL;
+    MlstCache *c = calloc(1, sizeof(MlstCache));
+    if (!c || !(c->path = strdup(path))) {
+        free(c);
+        return MLST_ERROR_NO_MEMORY;
+    }
+    c->fd = open(path, O_RDWR | O_CREAT, 0666);
+    if (c->fd < 0) {
+        free(c->path);
+        free(c);
+        return MLST_ERROR_IO;
+    }
+    pthread_mutex_init(&c->lock, NULL);
+
+    // A new (empty) file gets its table under the exclusive lock, so two processes creating it
+    // at once do not both format it
+    int status = MLST_OK;
+    struct stat st;
+    if (flock(c->fd, LOCK_EX) != 0 || fstat(c->fd, &st) != 0)
+        status = MLST_ERROR_IO;
+    else if (st.st_size == 0 && format_file(c->fd, CACHE_SLOT_BITS, CACHE_RECORD_SPACE) != 0)
+        status = MLST_ERROR_IO;
+    flock(c->fd, LOCK_UN);
+    // An existing file must be a cache file of this version
+    if (status == MLST_OK && lock_file(c, 0) != 0)
+        status = MLST_ERROR_IO;
+    if (status != MLST_OK) {
+        mlst_cache_close(c);
+        return status;
+    }
+    unlock_file(c);
+    *cache = c;
+    return MLST_OK;
+}
+
+void mlst_cache_close(MlstCache *c) {
+    if (!c)
+        return;
+    if (c->map)
+        munmap(c->map, c->size);
+    close(c->fd);
+    pthread_mutex_destroy(&c->lock);
+    free(c->path);
+    free(c);
+}
+
+// The record a slot points at, or NULL if it does not fit in the used part of the file
+static const CacheRecord *slot_record(const MlstCache *c, const CacheSlot *slot) {
+    const CacheHeader *h = header(c);
+    if (slot->offset < table_end(h->slot_bits) || slot->offset % 8 != 0 ||
+        slot->offset + sizeof(CacheRecord) > h->end)
+        return NULL;
+    const CacheRecord *rec = (const CacheRecord *)(c->map + slot->offset);
+    if (rec->n < 1 || rec->m < 0 || slot->offset + record_size(rec->n, rec->m) > h->end)
+        return NULL;
+    return rec;
+}
+
+/**
+ * Find the slot of the graph f labels: the first slot with its key whose record holds the same
+ * edge list (other slots with the key belong to colliding graphs).
+ *
+ * @param empty  Receives the empty slot ending the probe, where a new record would go (NULL if
+ *               a damaged table has none).
+ * @return The slot, or NULL if the graph is not stored.
+ */
+static CacheSlot *find(const MlstCache *c, const CanonForm *f, int n, int m, CacheSlot **empty) {
+    uint64_t mask = ((uint64_t)1 << header(c)->slot_bits) - 1;
+    CacheSlot *table = slots(c);
+    *empty = NULL;
+    // Loop through the probe sequence up to the first empty slot
+    for (uint64_t i = f->key & mask, probes = 0; probes <= mask; i = (i + 1) & mask, probes++) {
+        CacheSlot *slot = &table[i];
+        if (slot->key == 0) {
+            *empty = slot;
+            return NULL;
+        }
+        if (slot->key != f->key)
+            continue;
+        const CacheRecord *rec = slot_record(c, slot);
+        if (rec && rec->key == f->key && rec->n == n && rec->m == m &&
+            memcmp(rec + 1, f->edges, (size_t)m * sizeof(Edge)) == 0)
+            return slot;
+    }
+    return NULL;
+}
+
+/**
+ * Check a stored tree: n-1 edges of the stored graph without a cycle, with the stored leaves.
+ * Labels index the sorted edge list, so each tree edge is found by binary search.
+ *
+ * @param parent, degree  Scratch of n ints each.
+ * @return 1 if the tree is a spanning tree of the graph with rec->leaves leaves.
+ */
+static int tree_valid(const CacheRecord *rec, const Edge *edges, const Edge *tree, int *parent, int *degree) {
+    int n = rec->n, m = rec->m;
+    for (int v = 0; v < n; v++) {
+        parent[v] = v;
+        degree[v] = 0;
+    }
+    // Loop through the tree edges: each must be a graph edge joining two components
+    for (int i = 0; i < n - 1; i++) {
+        Edge e = tree[i];
+        if (e.u < 0 || e.v >= n || e.u >= e.v)
+            return 0;
+        int lo = 0, hi = m;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (edges[mid].u < e.u || (edges[mid].u == e.u && edges[mid].v < e.v))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == m || edges[lo].u != e.u || edges[lo].v != e.v)
+            return 0;
+        int a = e.u, b = e.v;
+        while (parent[a] != a)
+            a = parent[a] = parent[parent[a]];
+        while (parent[b] != b)
+            b = parent[b] = parent[parent[b]];
+        if (a == b)
+            return 0;
+        parent[a] = b;
+        degree[e.u]++;
+        degree[e.v]++;
+    }
+    int leaves = 0;
+    for (int v = 0; v < n; v++)
+        leaves += degree[v] == 1;
+    return leaves == rec->leaves;
+}
+
+/**
+ * Look the labelled graph up.
+ *
+ * @param need_optimal  Only a proven-optimal record counts as a hit.
+ * @param tree          Receives the n-1 stored tree edges (labels of f).
+ * @param scratch       2n ints.
+ * @return 1 on a hit (leaves and flags filled), 0 otherwise.
+ */
+static int cache_lookup(MlstCache *c, const CanonForm *f, int n, int m, int need_optimal, Edge *tree,
+                        int *scratch, int *leaves, uint32_t *flags) {
+    int hit = 0;
+    pthread_mutex_lock(&c->lock);
+    if (lock_file(c, 0) == 0) {
+        CacheSlot *empty;
+        CacheSlot *slot = find(c, f, n, m, &empty);
+        const CacheRecord *rec = slot ? slot_record(c, slot) : NULL;
+        if (rec && (!need_optimal || (rec->flags & RECORD_OPTIMAL))) {
+            const Edge *stored = (const Edge *)(rec + 1);
+            memcpy(tree, stored + m, (size_t)(n - 1) * sizeof(Edge));
+            if (tree_valid(rec, stored, tree, scratch, scratch + n)) {
+                hit = 1;
+                *leaves = rec->leaves;
+                *flags = rec->flags;
+            }
+        }
+        unlock_file(c);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return hit;
+}
+
+// Grow the file to hold at least size bytes (doubling) and map it again; 0 on success
+static int grow(MlstCache *c, uint64_t size) {
+    if (size <= c->size)
+        return 0;
+    uint64_t target = 2 * (uint64_t)c->size > size ? 2 * (uint64_t)c->size : size;
+    if (ftruncate(c->fd, (off_t)target) != 0)
+        return -1;
+    return remap(c);
+}
+
+/**
+ * Copy the live records into a new file with twice the slots and rename it over the old one.
+ * The new file is locked before the rename, so processes that switch to it wait for this store.
+ *
+ * @return 0 on success (c now holds the new file, locked exclusively), -1 if the old file is kept.
+ */
+static int rebuild(MlstCache *c) {
+    const CacheHeader *old = header(c);
+    uint32_t bits = old->slot_bits + 1;
+    if (bits > CACHE_MAX_SLOT_BITS)
+        return -1;
+    uint64_t live = 0, count = (uint64_t)1 << old->slot_bits;
+    for (uint64_t i = 0; i < count; i++) {
+        const CacheRecord *rec = slots(c)[i].key ? slot_record(c, &slots(c)[i]) : NULL;
+        if (rec)
+            live += record_size(rec->n, rec->m);
+    }
+
+    char *tmp_path = malloc(strlen(c->path) + 32);
+    if (!tmp_path)
+        return -1;
+    sprintf(tmp_path, "%s.%ld.tmp", c->path, (long)getpid());
+    int fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    MlstCache fresh = {.fd = fd};
+    if (fd < 0 || flock(fd, LOCK_EX) != 0 || format_file(fd, bits, live + CACHE_RECORD_SPACE) != 0 ||
+        remap(&fresh) != 0) {
+        if (fresh.map)
+            munmap(fresh.map, fresh.size);
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp_path);
+        }
+        free(tmp_path);
+        return -1;
+    }
+
+    // Step 1: Copy every live record and point a slot of the new table at it
+    CacheHeader *h = header(&fresh);
+    uint64_t mask = ((uint64_t)1 << bits) - 1;
+    for (uint64_t i = 0; i < count; i++) {
+        const CacheSlot *slot = &slots(c)[i];
+        const CacheRecord *rec = slot->key ? slot_record(c, slot) : NULL;
+        if (!rec)
+            continue;
+        uint64_t size = record_size(rec->n, rec->m);
+        memcpy(fresh.map + h->end, rec, size);
+        uint64_t j = slot->key & mask;
+        while (slots(&fresh)[j].key != 0)
+            j = (j + 1) & mask;
+        slots(&fresh)[j].offset = h->end;
+        slots(&fresh)[j].key = slot->key;
+        h->end += size;
+        h->used++;
+    }
+
+    // Step 2: Put the new file in place and drop the old one (still locked until closed)
+    if (rename(tmp_path, c->path) != 0) {
+        munmap(fresh.map, fresh.size);
+        close(fd);
+        unlink(tmp_path);
+        free(tmp_path);
+        return -1;
+    }
+    free(tmp_path);
+    munmap(c->map, c->size);
+    close(c->fd);
+    c->fd = fd;
+    c->map = fresh.map;
+    c->size = fresh.size;
+    return 0;
+}
+
+/**
+ * Store a result unless the record already there is at least as good (proven optimal beats
+ * unproven, then more leaves win).
+ *
+ * @param tree  The n-1 tree edges in the labels of f, each with u < v.
+ * @return 1 if the result was stored, 0 if not.
+ */
+static int cache_store(MlstCache *c, const CanonForm *f, int n, int m, const Edge *tree, int leaves,
+                       uint32_t flags) {
+    int stored = 0;
+    pthread_mutex_lock(&c->lock);
+    if (lock_file(c, 1) == 0) {
+        CacheSlot *empty;
+        CacheSlot *slot = find(c, f, n, m, &empty);
+        const CacheRecord *old = slot ? slot_record(c, slot) : NULL;
+        int better = !old || ((flags & RECORD_OPTIMAL) && !(old->flags & RECORD_OPTIMAL)) ||
+                     ((flags & RECORD_OPTIMAL) == (old->flags & RECORD_OPTIMAL) && leaves > old->leaves);
+        // A new key that would fill the table past 70% moves everything into a bigger table first
+        uint64_t capacity = (uint64_t)1 << header(c)->slot_bits;
+        if (better && !slot && (header(c)->used + 1) * 10 > capacity * 7 && rebuild(c) == 0)
+            slot = find(c, f, n, m, &empty);
+        uint64_t offset = header(c)->end, size = record_size(n, m);
+        // Growing maps the file again, so the slot is kept by its index
+        CacheSlot *target = slot ? slot : empty;
+        uint64_t index = target ? (uint64_t)(target - slots(c)) : 0;
+        capacity = (uint64_t)1 << header(c)->slot_bits;
+        if (better && target && header(c)->used + 1 < capacity && grow(c, offset + size) == 0) {
+            // Step 1: Append the record, then point the slot at it: the key goes in last, so a
+            // crash part way leaves at worst an unused record
+            CacheRecord *rec = (CacheRecord *)(c->map + offset);
+            rec->key = f->key;
+            rec->n = n;
+            rec->m = m;
+            rec->leaves = leaves;
+            rec->flags = flags;
+            Edge *edges = (Edge *)(rec + 1);
+            memcpy(edges, f->edges, (size_t)m * sizeof(Edge));
+            memcpy(edges + m, tree, (size_t)(n - 1) * sizeof(Edge));
+            header(c)->end = offset + size;
+            // Step 2: The slot (the same one again if the graph was stored before)
+            target = &slots(c)[index];
+            target->offset = offset;
+            if (!slot) {
+                target->key = f->key;
+                header(c)->used++;
+            }
+            stored = 1;
+        }
+        unlock_file(c);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return stored;
+}
+
+static CacheContext *cache_context(MlstSolver *s) {
+    if (!s->cache)
+        s->cache = calloc(1, sizeof(CacheContext));
+    return s->cache;
+}
+
+static int compare_edges(const void *a, const void *b) {
+    const Edge *x = a, *y = b;
+    if (x->u != y->u)
+        return x->u < y->u ? -1 : 1;
+    return (x->v > y->v) - (x->v < y->v);
+}
+
+/**
+ * Fill r from a cache hit: the tree as edges of g (in g's order, like a search returns them) and
+ * the bounds the record allows.
+ *
+ * @param stored   The n-1 tree edges in the labels of f (sorted here).
+ * @param scratch  3n ints.
+ */
+static void fill_hit(const MlstGraph *g, const CanonForm *f, Edge *stored, int leaves, uint32_t flags,
+                     int *scratch, Edge *tree, MlstResult *r) {
+    int n = g->n;
+    memset(r, 0, sizeof(*r));
+    r->stats.enabled = STATS_ENABLED;
+    if (tree) {
+        // Loop through the graph's edges, taking each one the stored tree has (of parallel edges the first)
+        int *taken = scratch, k = 0;
+        memset(taken, 0, (size_t)n * sizeof(int));
+        qsort(stored, n - 1, sizeof(Edge), compare_edges);
+        for (int i = 0; i < g->m && k < n - 1; i++) {
+            int u = f->label[g->edges[i].u], v = f->label[g->edges[i].v];
+            Edge key = {u < v ? u : v, u < v ? v : u};
+            Edge *e = bsearch(&key, stored, n - 1, sizeof(Edge), compare_edges);
+            if (e && !taken[e - stored]) {
+                taken[e - stored] = 1;
+                tree[k++] = g->edges[i];
+            }
+        }
+    }
+    r->leaves = leaves;
+    r->tree_edges = n - 1;
+    graph_bounds(g, 0, scratch, &r->bounds);
+    if (flags & RECORD_APPROX) {
+        r->bounds.approx = 2 * leaves;
+        if (r->bounds.approx < r->bounds.upper)
+            r->bounds.upper = r->bounds.approx;
+    }
+    if (flags & RECORD_OPTIMAL)
+        r->bounds.upper = leaves;
+    r->optimal = (flags & RECORD_OPTIMAL) != 0;
+    r->exact.bound = r->bounds.upper;
+    r->cache.hit = 1;
+}
+
+/**
+ * The cached solve behind mlst_solve_exact and mlst_solve_approx: label g, look it up, and on a
+ * miss solve it with the cache switched off and store the result.
+ *
+ * @param exact  1 for the exact search (only proven-optimal records are hits), 0 for the approximation.
+ */
+static int cached_solve(MlstSolver *s, const MlstGraph *g, MlstCache *cache, int exact, const void *opt,
+                        Edge *tree, MlstResult *r) {
+    double started = mlst_seconds();
+    CacheContext *c = cache_context(s);
+    if (!c)
+        return MLST_ERROR_NO_MEMORY;
+    arena_reset(&c->arena);
+    int n = g->n, m = g->m;
+    CanonForm f;
+    int status = canon_form(&c->arena, g, &f);
+    Edge *labelled = arena_alloc(&c->arena, (size_t)n * sizeof(Edge));
+    int *scratch = arena_alloc(&c->arena, 3 * (size_t)n * sizeof(int));
+    if (status == MLST_OK && (!labelled || !scratch))
+        status = MLST_ERROR_NO_MEMORY;
+    if (status != MLST_OK)
+        return status;
+
+    // Step 1: A hit needs no solve (the approximation's verification has nothing to check then)
+    int leaves;
+    uint32_t flags;
+    if (cache_lookup(cache, &f, n, m, exact, labelled, scratch, &leaves, &flags)) {
+        if (!exact)
+            approx_forget(s);
+        fill_hit(g, &f, labelled, leaves, flags, scratch, tree, r);
+        r->cache.canonical = f.canonical;
+        r->cache.seconds = mlst_seconds() - started;
+        return MLST_OK;
+    }
+    double looked_up = mlst_seconds();
+
+    // Step 2: Solve without the cache, into the arena if the caller wants no tree
+    Edge *solved = tree ? tree : arena_alloc(&c->arena, (size_t)n * sizeof(Edge));
+    if (!solved)
+        return MLST_ERROR_NO_MEMORY;
+    if (exact) {
+        MlstExactOptions plain = *(const MlstExactOptions *)opt;
+        plain.cache = NULL;
+        status = mlst_solve_exact(s, g, &plain, solved, r);
+    } else {
+        MlstApproxOptions plain = *(const MlstApproxOptions *)opt;
+        plain.cache = NULL;
+        status = mlst_solve_approx(s, g, &plain, solved, r);
+    }
+    if (status != MLST_OK)
+        return status;
+
+    // Step 3: Store spanning trees, in the labels of the canonical form
+    double storing = mlst_seconds();
+    if (r->leaves >= 0 && r->tree_edges == n - 1) {
+        for (int i = 0; i < n - 1; i++) {
+            int u = f.label[solved[i].u], v = f.label[solved[i].v];
+            labelled[i].u = u < v ? u : v;
+            labelled[i].v = u < v ? v : u;
+        }
+        uint32_t flags = exact ? 0 : RECORD_APPROX;
+        if ((exact && r->optimal) || r->leaves >= r->bounds.upper)
+            flags |= RECORD_OPTIMAL;
+        r->cache.stored = cache_store(cache, &f, n, m, labelled, r->leaves, flags);
+    }
+    r->cache.canonical = f.canonical;
+    r->cache.seconds = (looked_up - started) + (mlst_seconds() - storing);
+    return MLST_OK;
+}
+
+int cache_solve_exact(MlstSolver *s, const MlstGraph *g, const MlstExactOptions *opt, Edge *tree, MlstResult *r) {
+    return cached_solve(s, g, opt->cache, 1, opt, tree, r);
+}
+
+int cache_solve_approx(MlstSolver *s, const MlstGraph *g, const MlstApproxOptions *opt, Edge *tree, MlstResult *r) {
+    // A graph without nodes has nothing to store
+    if (g->n < 1) {
+        MlstApproxOptions plain = *opt;
+        plain.cache = NULL;
+        return mlst_solve_approx(s, g, &plain, tree, r);
+    }
+    return cached_solve(s, g, opt->cache, 0, opt, tree, r);
+}
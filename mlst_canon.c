@@ -0,0 +1,559 @@
+/*
+Canonical labelling of a graph, the key of the result cache (mlst_cache.c)
+
+Two isomorphic graphs get the same labelled edge list, so a result stored for one can be mapped
+onto the other. The labelling is the usual individualization-refinement search:
+- Colour refinement splits the nodes into cells until every node of a cell sees the same number
+  of neighbours in each cell. Colours are cell positions, so the partition does not depend on
+  the order the nodes were given in.
+- While a cell has several nodes, each of them in turn is made a cell of its own and the
+  partition refined again; every discrete partition reached is a labelling, and the one giving
+  the smallest sorted edge list is the canonical one.
+- Twins (nodes with the same neighbours apart from each other) can be swapped by an automorphism,
+  so a cell of twins is split into single nodes at once instead of being branched on: stars,
+  cliques and the pendant nodes of caterpillars cost one step.
+- Two labellings with the same edge list differ by an automorphism. The automorphisms found that
+  way prune the siblings they map onto an already searched child.
+
+The search stops after a work budget proportional to the graph. The labelling found so far still
+maps the graph onto its edge list (and the same input always gets it), but an isomorphic graph
+given in another order may then get another one, so such a graph only finds its own entries.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mlst_internal.h"
+
+#define MAX_AUTOMORPHISMS 64
+#define AUTOMORPHISM_INTS (1 << 22) // memory kept for automorphisms past the first few
+#define WORK_BASE 2000000LL     // budget for small graphs, in node/edge visits
+#define WORK_PER_ITEM 64        // budget per node and edge on top of it
+
+// Search level: the partition before branching on one of its cells, and the children tried
+typedef struct {
+    int *order, *color, *end;
+    int start, size;            // the cell branched on
+    int next;                   // index in the cell of the child being searched
+    int merged;                 // automorphisms taken into the orbits of the cell
+} Level;
+
+typedef struct {
+    int n, m;
+    const MlstGraph *g;
+    int *off, *adj;             // adjacency lists (CSR, sorted; a self-loop is listed twice)
+    int *twin;                  // twin class of each node (its smallest member; the node itself if none)
+    int *order, *pos;           // nodes by cell, and the position of each node in it
+    int *color;                 // start position of each node's cell
+    int *end;                   // end of the cell starting at each position
+    int *count;                 // neighbours of each node in the splitter cell
+    int *moved;                 // counted nodes of the cell starting at each position
+    int *touched, *cells;       // nodes and cells counted for the current splitter
+    int *queue, *queued;        // splitter cells waiting, and a flag by cell start
+    int head, waiting;
+    int *tmp;                   // merge sort buffer
+    int *label;                 // label of each node in the leaf being scored
+    Edge *edges, *best_edges;   // edge lists of that leaf and of the best one
+    int *best;                  // nodes by label in the best leaf
+    int have_best;
+    int *automorphism[MAX_AUTOMORPHISMS];
+    int automorphisms;
+    int *orbit, *index;         // union-find over the nodes of a level's cell, and their index in it
+    const Level *orbit_level;   // the level they belong to
+    long long work, budget;
+    Arena *arena;
+} Canon;
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Sort a[0..count): short lists (most adjacency lists and split cell lists) by insertion
+static void sort_ints(int *a, int count) {
+    if (count > 16) {
+        qsort(a, count, sizeof(int), compare_ints);
+        return;
+    }
+    for (int i = 1; i < count; i++) {
+        int x = a[i], j = i;
+        for (; j > 0 && a[j - 1] > x; j--)
+            a[j] = a[j - 1];
+        a[j] = x;
+    }
+}
+
+static int compare_edges(const void *a, const void *b) {
+    const Edge *x = a, *y = b;
+    if (x->u != y->u)
+        return x->u < y->u ? -1 : 1;
+    return (x->v > y->v) - (x->v < y->v);
+}
+
+static uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Stable merge sort of nodes a[0..size) by their neighbour count in the splitter
+static void sort_nodes(Canon *c, int *a, int size) {
+    if (size < 2)
+        return;
+    int half = size / 2;
+    sort_nodes(c, a, half);
+    sort_nodes(c, a + half, size - half);
+    int i = 0, j = half, k = 0;
+    while (i < half && j < size)
+        c->tmp[k++] = c->count[a[j]] < c->count[a[i]] ? a[j++] : a[i++];
+    while (i < half)
+        c->tmp[k++] = a[i++];
+    while (j < size)
+        c->tmp[k++] = a[j++];
+    memcpy(a, c->tmp, size * sizeof(int));
+}
+
+static void enqueue(Canon *c, int s) {
+    c->queue[(c->head + c->waiting++) % c->n] = s;
+    c->queued[s] = 1;
+}
+
+// Split the cell starting at s, whose counted nodes sit sorted at its back, by count; the nodes in
+// front of them all count 0 and stay one piece, so only the counted ones are looked at
+static void split(Canon *c, int s, int moved) {
+    int e = c->end[s], was_queued = c->queued[s], largest = s;
+    int a = s;
+    for (int i = e - moved > s ? e - moved : s + 1; i <= e; i++) {
+        if (i < e && c->count[c->order[i]] == c->count[c->order[i - 1]])
+            continue;
+        c->end[a] = i;
+        if (a != s)
+            for (int j = a; j < i; j++)
+                c->color[c->order[j]] = a;
+        if (i - a > c->end[largest] - largest)
+            largest = a;
+        a = i;
+    }
+    if (c->end[s] == e)
+        return;
+    // A cell already waiting is still searched whole; otherwise its largest piece is implied by the others
+    for (int p = s; p < e; p = c->end[p])
+        if (!c->queued[p] && (was_queued || p != largest))
+            enqueue(c, p);
+}
+
+/**
+ * Colour refinement: split cells by the number of neighbours their nodes have in a splitter cell,
+ * until no waiting splitter splits anything. Cells are taken and split in position order, so the
+ * partition reached does not depend on how the nodes were numbered.
+ */
+static void refine(Canon *c) {
+    int n = c->n;
+    while (c->waiting > 0 && c->work <= c->budget) {
+        int w = c->queue[c->head];
+        c->head = (c->head + 1) % n;
+        c->waiting--;
+        c->queued[w] = 0;
+
+        // Step 1: Count the neighbours every node has in the splitter
+        int touched = 0, cells = 0;
+        for (int i = w; i < c->end[w]; i++) {
+            int x = c->order[i];
+            for (int j = c->off[x]; j < c->off[x + 1]; j++)
+                if (c->count[c->adj[j]]++ == 0)
+                    c->touched[touched++] = c->adj[j];
+            c->work += c->off[x + 1] - c->off[x] + 1;
+        }
+
+        // Step 2: Move the counted nodes of each cell to its back
+        for (int i = 0; i < touched; i++) {
+            int u = c->touched[i], s = c->color[u];
+            if (c->moved[s] == 0)
+                c->cells[cells++] = s;
+            int p = c->end[s] - 1 - c->moved[s]++, q = c->pos[u], x = c->order[p];
+            c->order[q] = x;
+            c->pos[x] = q;
+            c->order[p] = u;
+            c->pos[u] = p;
+        }
+        sort_ints(c->cells, cells);
+
+        // Step 3: Sort those nodes by count and split the cells where it changes
+        for (int k = 0; k < cells; k++) {
+            int s = c->cells[k], e = c->end[s], moved = c->moved[s];
+            c->moved[s] = 0;
+            if (e - s == 1)
+                continue;
+            sort_nodes(c, c->order + e - moved, moved);
+            for (int i = e - moved; i < e; i++)
+                c->pos[c->order[i]] = i;
+            split(c, s, moved);
+            c->work += 4LL * moved;
+        }
+        for (int i = 0; i < touched; i++)
+            c->count[c->touched[i]] = 0;
+    }
+}
+
+// Make v a cell of its own at the back of its cell, and a splitter
+static void individualize(Canon *c, int v) {
+    int s = c->color[v], e = c->end[s], p = c->pos[v], x = c->order[e - 1];
+    c->order[p] = x;
+    c->pos[x] = p;
+    c->order[e - 1] = v;
+    c->pos[v] = e - 1;
+    c->end[s] = e - 1;
+    c->end[e - 1] = e;
+    c->color[v] = e - 1;
+    if (!c->queued[e - 1])
+        enqueue(c, e - 1);
+}
+
+// Score a discrete partition: keep it if its edge list is the smallest, or record the automorphism
+static void leaf(Canon *c) {
+    int n = c->n, m = c->m;
+    for (int i = 0; i < n; i++)
+        c->label[c->order[i]] = i;
+    for (int i = 0; i < m; i++) {
+        int u = c->label[c->g->edges[i].u], v = c->label[c->g->edges[i].v];
+        c->edges[i].u = u < v ? u : v;
+        c->edges[i].v = u < v ? v : u;
+    }
+    qsort(c->edges, m, sizeof(Edge), compare_edges);
+    c->work += n + 8 * (long long)m;
+
+    int cmp = -1;
+    if (c->have_best) {
+        cmp = 0;
+        for (int i = 0; i < m && cmp == 0; i++)
+            cmp = compare_edges(&c->edges[i], &c->best_edges[i]);
+    }
+    if (cmp < 0) {
+        memcpy(c->best, c->order, n * sizeof(int));
+        memcpy(c->best_edges, c->edges, m * sizeof(Edge));
+        c->have_best = 1;
+    } else if (cmp == 0 && c->automorphisms < MAX_AUTOMORPHISMS &&
+               (c->automorphisms < 4 || (long long)(c->automorphisms + 1) * n <= AUTOMORPHISM_INTS)) {
+        // Both labellings give the same graph: node order[i] plays the role of best[i]
+        int *a = arena_alloc(c->arena, n * sizeof(int));
+        if (!a)
+            return;
+        for (int i = 0; i < n; i++)
+            a[c->order[i]] = c->best[i];
+        c->automorphism[c->automorphisms++] = a;
+    }
+}
+
+static int orbit_find(int *parent, int v) {
+    while (parent[v] != v)
+        v = parent[v] = parent[parent[v]];
+    return v;
+}
+
+/**
+ * 1 if an automorphism fixing every single-node cell of the level maps an earlier child onto child k.
+ * The orbits of the level's cell are kept between calls and only take in automorphisms found
+ * since; the root of each orbit is its node with the smallest index in the cell.
+ */
+static int pruned(Canon *c, Level *l, int k) {
+    if (c->automorphisms == 0)
+        return 0;
+    const int *cell = l->order + l->start;
+    if (c->orbit_level != l) {
+        for (int i = 0; i < l->size; i++) {
+            c->orbit[cell[i]] = cell[i];
+            c->index[cell[i]] = i;
+        }
+        c->orbit_level = l;
+        l->merged = 0;
+        c->work += l->size;
+    }
+    // Loop through the new automorphisms that keep the level's partition (they fix its single nodes)
+    for (; l->merged < c->automorphisms; l->merged++) {
+        const int *g = c->automorphism[l->merged];
+        int keeps = 1;
+        for (int i = 0; i < c->n && keeps; i = l->end[i])
+            keeps = l->end[i] != i + 1 || g[l->order[i]] == l->order[i];
+        c->work += c->n;
+        if (!keeps)
+            continue;
+        for (int i = 0; i < l->size; i++) {
+            int x = orbit_find(c->orbit, cell[i]), y = orbit_find(c->orbit, g[cell[i]]);
+            if (x != y)
+                c->orbit[c->index[x] < c->index[y] ? y : x] = c->index[x] < c->index[y] ? x : y;
+        }
+        c->work += l->size;
+    }
+    c->work++;
+    return c->index[orbit_find(c->orbit, cell[k])] < k;
+}
+
+static int compare_pairs(const void *a, const void *b) {
+    const uint64_t *x = a, *y = b;
+    if (x[0] != y[0])
+        return x[0] < y[0] ? -1 : 1;
+    return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+// Number of times x occurs in the sorted adjacency list of v
+static int occurrences(const Canon *c, int v, int x) {
+    int count = 0;
+    for (int i = c->off[v]; i < c->off[v + 1]; i++)
+        count += c->adj[i] == x;
+    return count;
+}
+
+// 1 if swapping u and v is an automorphism: false twins (closed = 0) have the same neighbours and
+// are not adjacent, true twins (closed = 1) are joined by one edge and have the same neighbours
+// apart from each other; neither may have a self-loop
+static int twins(const Canon *c, int u, int v, int closed) {
+    int du = c->off[u + 1] - c->off[u], dv = c->off[v + 1] - c->off[v];
+    if (du != dv || occurrences(c, u, u) || occurrences(c, v, v) || occurrences(c, u, v) != closed ||
+        occurrences(c, v, u) != closed)
+        return 0;
+    const int *a = c->adj + c->off[u], *b = c->adj + c->off[v];
+    int i = 0, j = 0;
+    // Loop through both lists in step, skipping the other node of the pair
+    for (;;) {
+        while (i < du && a[i] == v)
+            i++;
+        while (j < dv && b[j] == u)
+            j++;
+        if (i == du || j == dv)
+            return i == du && j == dv;
+        if (a[i++] != b[j++])
+            return 0;
+    }
+}
+
+// Build the sorted adjacency lists and the twin classes
+static int prepare(Canon *c) {
+    int n = c->n, m = c->m;
+    const Edge *edges = c->g->edges;
+    int *fill = c->label; // Scratch until the search needs labels
+    memset(c->off, 0, (n + 1) * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        c->off[edges[i].u + 1]++;
+        c->off[edges[i].v + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+        c->off[v + 1] += c->off[v];
+    memcpy(fill, c->off, n * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        c->adj[fill[edges[i].u]++] = edges[i].v;
+        c->adj[fill[edges[i].v]++] = edges[i].u;
+    }
+    for (int v = 0; v < n; v++)
+        sort_ints(c->adj + c->off[v], c->off[v + 1] - c->off[v]);
+
+    // Step 2: Twin classes. Candidates share a hash of their open (false twins) or closed (true
+    // twins) neighbourhood and are checked against the first node of their group
+    uint64_t *open = arena_alloc(c->arena, (size_t)n * sizeof(uint64_t));
+    uint64_t *pairs = arena_alloc(c->arena, 2 * (size_t)n * sizeof(uint64_t));
+    if (!open || !pairs)
+        return -1;
+    for (int v = 0; v < n; v++) {
+        open[v] = 0;
+        for (int i = c->off[v]; i < c->off[v + 1]; i++)
+            open[v] += mix(c->adj[i]);
+        c->twin[v] = v;
+    }
+    for (int closed = 0; closed < 2; closed++) {
+        for (int v = 0; v < n; v++) {
+            pairs[2 * v] = closed ? open[v] + mix(v) : open[v];
+            pairs[2 * v + 1] = v;
+        }
+        qsort(pairs, n, 2 * sizeof(uint64_t), compare_pairs);
+        // Loop through the groups of equal hashes
+        for (int i = 0; i < n;) {
+            int j = i + 1;
+            while (j < n && pairs[2 * j] == pairs[2 * i])
+                j++;
+            int rep = (int)pairs[2 * i + 1];
+            for (int k = i + 1; k < j; k++) {
+                int v = (int)pairs[2 * k + 1];
+                if (c->twin[v] == v && twins(c, rep, v, closed))
+                    c->twin[v] = c->twin[rep];
+            }
+            i = j;
+        }
+    }
+    c->work += 4 * (long long)n + 4 * (long long)m;
+    return 0;
+}
+
+// 1 if the cell starting at s holds several nodes, all of one twin class
+static int twin_cell(const Canon *c, int s) {
+    int t = c->twin[c->order[s]];
+    for (int i = s + 1; i < c->end[s]; i++)
+        if (c->twin[c->order[i]] != t)
+            return 0;
+    return 1;
+}
+
+// Save the partition of a new level; NULL if out of memory
+static Level *push_level(Canon *c, Level *levels, int depth, int s) {
+    Level *l = &levels[depth];
+    int n = c->n;
+    if (!l->order) {
+        l->order = arena_alloc(c->arena, 3 * (size_t)n * sizeof(int));
+        if (!l->order)
+            return NULL;
+        l->color = l->order + n;
+        l->end = l->color + n;
+    }
+    memcpy(l->order, c->order, n * sizeof(int));
+    memcpy(l->color, c->color, n * sizeof(int));
+    memcpy(l->end, c->end, n * sizeof(int));
+    c->work += 3 * (long long)n;
+    if (c->orbit_level == l)
+        c->orbit_level = NULL;
+    l->start = s;
+    l->size = c->end[s] - s;
+    l->next = 0;
+    return l;
+}
+
+// Go back to the partition of a level
+static void restore_level(Canon *c, const Level *l) {
+    int n = c->n;
+    memcpy(c->order, l->order, n * sizeof(int));
+    memcpy(c->color, l->color, n * sizeof(int));
+    memcpy(c->end, l->end, n * sizeof(int));
+    for (int i = 0; i < n; i++)
+        c->pos[c->order[i]] = i;
+    c->work += 4 * (long long)n;
+}
+
+/**
+ * Search the labellings of g for the one with the smallest edge list.
+ *
+ * @return 1 if the search finished, 0 if the budget ran out first, -1 if out of memory.
+ */
+static int search(Canon *c) {
+    int n = c->n;
+    Level *levels = arena_alloc(c->arena, (size_t)(n + 1) * sizeof(Level));
+    if (!levels)
+        return -1;
+    memset(levels, 0, (size_t)(n + 1) * sizeof(Level));
+    if (n == 0) {
+        leaf(c);
+        return 1;
+    }
+    for (int i = 0; i < n; i++) {
+        c->order[i] = c->pos[i] = i;
+        c->color[i] = 0;
+    }
+    c->end[0] = n;
+    enqueue(c, 0);
+    refine(c);
+    int depth = 0;
+    // Loop until every level has run out of children
+    for (;;) {
+        // Step 1: Go down from the current partition to a discrete one; cells before the first
+        // with several nodes only ever hold one, so the scan goes on from there
+        int s = 0;
+        while (c->work <= c->budget) {
+            while (s < n && c->end[s] == s + 1)
+                s++;
+            if (s == n)
+                break;
+            if (twin_cell(c, s)) {
+                // Swapping twins is an automorphism: every order of the cell gives the same labelling,
+                // and their neighbours see all of them alike, so nothing else splits
+                for (int i = s; i < c->end[s]; i++)
+                    c->color[c->order[i]] = i;
+                for (int i = s, e = c->end[s]; i < e; i++)
+                    c->end[i] = i + 1;
+                continue;
+            }
+            Level *l = push_level(c, levels, depth++, s);
+            if (!l)
+                return -1;
+            individualize(c, l->order[s]);
+            refine(c);
+        }
+        if (c->work > c->budget)
+            return 0;
+        leaf(c);
+
+        // Step 2: Back up to the deepest level with a child left that no automorphism rules out
+        Level *l = NULL;
+        while (depth > 0) {
+            l = &levels[depth - 1];
+            do {
+                l->next++;
+            } while (l->next < l->size && pruned(c, l, l->next));
+            if (l->next < l->size)
+                break;
+            depth--;
+        }
+        if (depth == 0)
+            return 1;
+        restore_level(c, l);
+        individualize(c, l->order[l->start + l->next]);
+        refine(c);
+    }
+}
+
+int canon_form(Arena *a, const MlstGraph *g, CanonForm *f) {
+    int n = g->n, m = g->m;
+    Canon c;
+    memset(&c, 0, sizeof(c));
+    c.n = n;
+    c.m = m;
+    c.g = g;
+    c.arena = a;
+    c.budget = WORK_BASE + WORK_PER_ITEM * ((long long)n + m);
+    c.off = arena_alloc(a, (size_t)(n + 1) * sizeof(int));
+    c.adj = arena_alloc(a, 2 * (size_t)m * sizeof(int) + 1);
+    c.twin = arena_alloc(a, (size_t)n * sizeof(int));
+    c.order = arena_alloc(a, (size_t)n * sizeof(int));
+    c.pos = arena_alloc(a, (size_t)n * sizeof(int));
+    c.color = arena_alloc(a, (size_t)n * sizeof(int));
+    c.end = arena_alloc(a, (size_t)n * sizeof(int));
+    c.count = arena_alloc(a, (size_t)n * sizeof(int));
+    c.moved = arena_alloc(a, (size_t)n * sizeof(int));
+    c.queued = arena_alloc(a, (size_t)n * sizeof(int));
+    c.touched = arena_alloc(a, (size_t)n * sizeof(int));
+    c.cells = arena_alloc(a, (size_t)n * sizeof(int));
+    c.queue = arena_alloc(a, (size_t)n * sizeof(int));
+    c.tmp = arena_alloc(a, (size_t)n * sizeof(int));
+    c.label = arena_alloc(a, (size_t)n * sizeof(int));
+    c.best = arena_alloc(a, (size_t)n * sizeof(int));
+    c.orbit = arena_alloc(a, (size_t)n * sizeof(int));
+    c.index = arena_alloc(a, (size_t)n * sizeof(int));
+    c.edges = arena_alloc(a, (size_t)m * sizeof(Edge) + 1);
+    c.best_edges = arena_alloc(a, (size_t)m * sizeof(Edge) + 1);
+    if (!c.off || !c.adj || !c.twin || !c.order || !c.pos || !c.color || !c.end || !c.count || !c.moved ||
+        !c.queued || !c.touched || !c.cells || !c.queue || !c.tmp || !c.label || !c.best || !c.orbit || !c.index ||
+        !c.edges || !c.best_edges)
+        return MLST_ERROR_NO_MEMORY;
+    memset(c.count, 0, (size_t)n * sizeof(int));
+    memset(c.moved, 0, (size_t)n * sizeof(int));
+    memset(c.queued, 0, (size_t)n * sizeof(int));
+
+    // Step 1: The search; if it stops early its best labelling is used, or the nodes as given
+    int status = prepare(&c) != 0 ? -1 : search(&c);
+    if (status < 0)
+        return MLST_ERROR_NO_MEMORY;
+    if (!c.have_best) {
+        for (int i = 0; i < n; i++)
+            c.order[i] = i;
+        leaf(&c);
+    }
+    f->canonical = status == 1;
+    f->lab = c.best;
+    f->label = c.label;
+    for (int i = 0; i < n; i++)
+        f->label[c.best[i]] = i;
+    f->edges = c.best_edges;
+
+    // Step 2: The key hashes the node count and the edge list
+    uint64_t h = mix((uint64_t)n) ^ mix((uint64_t)m << 1);
+    for (int i = 0; i < m; i++)
+        h = mix(h ^ ((uint64_t)(uint32_t)f->edges[i].u << 32 | (uint32_t)f->edges[i].v));
+    f->key = h ? h : 1;
+    return MLST_OK;
+}
@@ -0,0 +1,266 @@
+/*
+Exact search through connected dominating sets
+
+The internal nodes of a spanning tree with 3 or more nodes form a connected dominating set (every
+other node hangs off one of them), and every connected dominating set D is the inner part of a
+spanning tree: a spanning tree of the subgraph on D, with every node outside D hung from a
+neighbour in D. So the most leaves are n minus the size of a minimum connected dominating set,
+and that set can be searched over the n nodes instead of over the C(m, n-1) edge combinations the
+other methods walk through, which is what makes dense graphs (K5 and up) cheap.
+
+Node sets are 64-bit masks. The search grows D from one seed node, always by a neighbour of D,
+and branches on taking or refusing that node, so every connected set is reached exactly once and
+no table of visited sets is needed. A branch is cut when
+- a node that must be in D (pinned, or a cut vertex of the graph) was refused or is out of reach
+- a node not dominated yet has no neighbour left that could still join D
+- D plus a lower bound on the nodes still needed is no smaller than the best set found so far.
+The search stops as soon as the best set reaches the size the upper bounds of mlst_bound.c allow.
+Cut vertices are in every connected dominating set, and a node of degree 1 is never in a minimum
+one, so both are settled before the search. The first best set comes from a greedy pass.
+Pinned nodes (see mlst_exact.c) are forced into D, so they are never leaves.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "mlst_internal.h"
+
+#define MAX_NODES MLST_EXACT_MAX_NODES
+
+typedef struct {
+    int n;
+    uint64_t closed[MAX_NODES]; // each node with its neighbours
+    uint64_t all;              // the n nodes
+    uint64_t forced;           // nodes every set searched for contains
+    uint64_t allowed;          // nodes that may be in a minimum set
+    uint64_t best;             // smallest connected dominating set found so far
+    int best_size;
+    int target_size;           // no set is smaller (n minus the upper bound on the leaves)
+    long long nodes, pruned;
+    double deadline;           // monotonic seconds (0 = no limit)
+    int timed_out;
+    MlstStats *stats;          // instrumentation (STAT_ macros): every smaller set is an improvement
+    double started;
+} CdsSearch;
+
+// Union of the closed neighbourhoods of the nodes in set
+static uint64_t neighbourhood(const CdsSearch *s, uint64_t set) {
+    uint64_t out = 0;
+    // Loop over the nodes of the set, lowest first
+    for (; set; set &= set - 1)
+        out |= s->closed[__builtin_ctzll(set)];
+    return out;
+}
+
+// Nodes reachable from start (a subset of within) without leaving within
+static uint64_t reach(const CdsSearch *s, uint64_t start, uint64_t within) {
+    uint64_t seen = start, frontier = start;
+    while (frontier) {
+        uint64_t next = neighbourhood(s, frontier) & within & ~seen;
+        seen |= next;
+        frontier = next;
+    }
+    return seen;
+}
+
+// Greedy connected dominating set: start at a forced node (or the highest degree one) and keep
+// adding the neighbour of the set that dominates the most new nodes, forced nodes first
+static uint64_t greedy_set(const CdsSearch *s) {
+    int start = 0;
+    if (s->forced) {
+        start = __builtin_ctzll(s->forced);
+    } else {
+        for (int v = 1; v < s->n; v++)
+            if (__builtin_popcountll(s->closed[v]) > __builtin_popcountll(s->closed[start]))
+                start = v;
+    }
+    uint64_t d = (uint64_t)1 << start;
+    for (;;) {
+        uint64_t dominated = neighbourhood(s, d);
+        uint64_t open = s->all & ~dominated;
+        if (!open && !(s->forced & ~d))
+            return d;
+        // A node on the way to an open node dominates one, and a missing forced node is already a
+        // neighbour once nothing is open, so some neighbour of d always scores above 0
+        int pick = -1, pick_score = 0;
+        for (uint64_t x = dominated & ~d; x; x &= x - 1) {
+            int v = __builtin_ctzll(x);
+            int score = __builtin_popcountll(s->closed[v] & open) + ((s->forced >> v & 1) ? s->n : 0);
+            if (score > pick_score) {
+                pick = v;
+                pick_score = score;
+            }
+        }
+        d |= (uint64_t)1 << pick;
+    }
+}
+
+// Grow the connected set d by neighbours outside refused, keeping the smallest dominating set
+static void cds_search(CdsSearch *s, uint64_t d, uint64_t refused) {
+    s->nodes++;
+    if (s->deadline > 0 && (s->nodes & 1023) == 0 && mlst_seconds() >= s->deadline)
+        s->timed_out = 1;
+    if (s->timed_out || s->best_size <= s->target_size)
+        return;
+
+    int size = __builtin_popcountll(d);
+    uint64_t dominated = neighbourhood(s, d);
+    uint64_t open = s->all & ~dominated;       // nodes not dominated yet
+    uint64_t missing = s->forced & ~d;
+    if (!open && !missing) {
+        if (size < s->best_size) {
+            s->best = d;
+            s->best_size = size;
+            STAT_IMPROVE(s->stats, s->started, s->n - size);
+        }
+        return;
+    }
+
+    // Nodes that could still join d, and the ones of them d can grow into
+    uint64_t free_nodes = s->allowed & ~d & ~refused;
+    uint64_t reachable = reach(s, d, d | free_nodes) & ~d;
+    if ((missing & ~reachable) || (open & ~neighbourhood(s, reachable))) {
+        s->pruned++;
+        return;
+    }
+    // Every missing forced node has to be added, and no added node dominates more than `most` open nodes
+    int need = __builtin_popcountll(missing);
+    if (open) {
+        int most = 1;
+        for (uint64_t x = reachable; x; x &= x - 1) {
+            int covered = __builtin_popcountll(s->closed[__builtin_ctzll(x)] & open);
+            if (covered > most)
+                most = covered;
+        }
+        int cover = (__builtin_popcountll(open) + most - 1) / most;
+        if (cover > need)
+            need = cover;
+    }
+    if (size + need >= s->best_size) {
+        s->pruned++;
+        return;
+    }
+
+    // A forced neighbour is taken without branching; otherwise branch on the neighbour that
+    // dominates the most open nodes (taking it first, so good sets are found early)
+    uint64_t frontier = dominated & free_nodes;
+    if (frontier & s->forced) {
+        cds_search(s, d | (frontier & s->forced & -(frontier & s->forced)), refused);
+        return;
+    }
+    int pick = __builtin_ctzll(frontier), pick_score = -1;
+    for (uint64_t x = frontier; x; x &= x - 1) {
+        int v = __builtin_ctzll(x);
+        int score = __builtin_popcountll(s->closed[v] & open);
+        if (score > pick_score) {
+            pick = v;
+            pick_score = score;
+        }
+    }
+    cds_search(s, d | (uint64_t)1 << pick, refused);
+    cds_search(s, d, refused | (uint64_t)1 << pick);
+}
+
+int cds_solve(const MlstGraph *g, uint64_t pinned, const MlstExactOptions *opt, Edge *tree, MlstResult *r) {
+    CdsSearch s;
+    memset(&s, 0, sizeof(s));
+    int n = g->n, m = g->m;
+    STAT_TIMER(t);
+    s.stats = &r->stats;
+    s.started = mlst_seconds();
+    s.n = n;
+    s.all = n == 64 ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+
+    // Step 1: Closed neighbourhoods (self-loops and parallel edges change nothing)
+    for (int v = 0; v < n; v++)
+        s.closed[v] = (uint64_t)1 << v;
+    for (int i = 0; i < m; i++) {
+        s.closed[g->edges[i].u] |= (uint64_t)1 << g->edges[i].v;
+        s.closed[g->edges[i].v] |= (uint64_t)1 << g->edges[i].u;
+    }
+    if (reach(&s, 1, s.all) != s.all) {
+        r->leaves = -1; // Disconnected: no spanning tree
+        return MLST_OK;
+    }
+
+    // Step 2: Search, unless a single node is enough (n <= 2 has no internal node at all)
+    s.best = 1;
+    s.best_size = 1;
+    if (n >= 3) {
+        // Cut vertices are forced in; nodes of degree 1 are never needed (their neighbour is a cut vertex)
+        s.forced = pinned;
+        s.allowed = s.all;
+        for (int v = 0; v < n; v++) {
+            uint64_t rest = s.all & ~((uint64_t)1 << v);
+            if (reach(&s, rest & -rest, rest) != rest)
+                s.forced |= (uint64_t)1 << v;
+            if (__builtin_popcountll(s.closed[v]) == 2)
+                s.allowed &= ~((uint64_t)1 << v);
+        }
+        s.allowed |= s.forced;
+        s.best = greedy_set(&s);
+        s.best_size = __builtin_popcountll(s.best);
+        s.target_size = n - r->bounds.upper;
+        s.deadline = opt->time_limit > 0 ? mlst_seconds() + opt->time_limit : 0;
+        STAT_IMPROVE(s.stats, s.started, n - s.best_size);
+        STAT_LAP(&r->stats, MLST_PHASE_SETUP, t);
+        if (s.forced) {
+            // Every set contains the lowest forced node: grow from it
+            cds_search(&s, s.forced & -s.forced, 0);
+        } else {
+            // Split the sets by their lowest node: seed v refuses every allowed node below it
+            for (int v = 0; v < n && !s.timed_out && s.best_size > s.target_size; v++)
+                if (s.allowed >> v & 1)
+                    cds_search(&s, (uint64_t)1 << v, s.allowed & (((uint64_t)1 << v) - 1));
+        }
+    }
+
+    STAT_LAP(&r->stats, MLST_PHASE_SEARCH, t);
+
+    // Step 3: Tree: a breadth-first tree of the set, every other node hung from its lowest neighbour in it
+    int parent[MAX_NODES];
+    int root = __builtin_ctzll(s.best);
+    parent[root] = -1;
+    uint64_t seen = (uint64_t)1 << root, layer = seen;
+    while (layer) {
+        uint64_t next = neighbourhood(&s, layer) & s.best & ~seen;
+        for (uint64_t x = next; x; x &= x - 1) {
+            int v = __builtin_ctzll(x);
+            parent[v] = __builtin_ctzll(s.closed[v] & layer);
+        }
+        seen |= next;
+        layer = next;
+    }
+    for (int v = 0; v < n; v++)
+        if (!(s.best >> v & 1))
+            parent[v] = __builtin_ctzll(s.closed[v] & s.best);
+
+    // Step 4: Pick the first graph edge of every parent link, in edge order, and count the leaves
+    uint64_t linked = 0;
+    int degree[MAX_NODES] = {0};
+    int k = 0;
+    for (int i = 0; i < m && k < n - 1; i++) {
+        int u = g->edges[i].u, v = g->edges[i].v;
+        int child = (parent[v] == u && !(linked >> v & 1)) ? v : ((parent[u] == v && !(linked >> u & 1)) ? u : -1);
+        if (child < 0 || u == v)
+            continue;
+        linked |= (uint64_t)1 << child;
+        degree[u]++;
+        degree[v]++;
+        if (tree)
+            tree[k] = g->edges[i];
+        k++;
+    }
+    int leaves = 0;
+    for (int v = 0; v < n; v++)
+        leaves += degree[v] == 1 && !(pinned >> v & 1);
+
+    r->leaves = leaves;
+    r->tree_edges = k;
+    r->exact.nodes = s.nodes;
+    r->exact.pruned = s.pruned;
+    r->exact.trees = 1;
+    r->exact.timed_out = s.timed_out;
+    r->optimal = !s.timed_out;
+    return MLST_OK;
+}
@@ -0,0 +1,1616 @@
+/*
+Exact search for a spanning tree with the maximum number of leaf nodes, as a library
+
+Three ways through the same k = n-1 edge combinations:
+- Enumeration: every combination in lexicographic order, with a rollback union-find/degree table
+  so branches that close a cycle are skipped and every complete combination is a spanning tree.
+- Revolving door: every combination in Gray code order, one edge out and one edge in per step.
+- Branch and bound: the enumeration order, pruned by an optimistic leaf bound, split into tasks
+  on a work-stealing thread pool, with rank ranges (sharding), time limits and checkpoints.
+
+All three keep the most leaves and break ties towards the lexicographically first edge set.
+A fourth method, the minimum connected dominating set search in mlst_cds.c, works on node sets
+instead of edge combinations; exact_solve only hands the graph over to it.
+Nodes in the pinned mask (cut vertices of a block handed over by the kernelization in mlst_kernel.c)
+start with degree 2, so they count as internal from the start and are never leaves.
+Every buffer lives in the solver's ExactContext, so nothing here is global apart from the
+binomial table, which is filled once and only read afterwards.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "mlst_internal.h"
+
+#define MAX_NODES MLST_EXACT_MAX_NODES
+#define MAX_EDGES MLST_EXACT_MAX_EDGES
+
+
+// Partial tree carried through the recursion
+// Each picked edge is pushed (union + degree update) and popped again on return,
+// so no combination has to rebuild its union-find or degree table from scratch.
+// Union by rank without path compression keeps every union undoable in O(1).
+typedef struct {
+    int uf_parent[MAX_NODES], uf_rank[MAX_NODES];
+    int degree[MAX_NODES];     // degree of each node in the partial tree
+    int internal;              // nodes with degree >= 2 (they can never become leaves again)
+    int leaves;                // nodes with degree == 1 in the partial tree
+} PartialTree;
+
+// Degree a node starts with: 2 if it is pinned (can never be a leaf), else 0
+static int base_degree(uint64_t pinned, int x) {
+    return (pinned >> x & 1) ? 2 : 0;
+}
+
+// Reset the partial tree to n isolated nodes (pinned nodes already count as internal)
+static void tree_init(PartialTree *t, int n, uint64_t pinned) {
+    // Loop to make each node its own set with its base degree
+    for (int i = 0; i < n; i++) {
+        t->uf_parent[i] = i;
+        t->uf_rank[i] = 0;
+        t->degree[i] = base_degree(pinned, i);
+    }
+    t->internal = __builtin_popcountll(pinned);
+    t->leaves = 0;
+}
+
+// Union-find lookup without path compression (keeps the structure undoable)
+// O(log n) because of union by rank
+static int uf_find(const PartialTree *t, int x) {
+    while (t->uf_parent[x] != x)
+        x = t->uf_parent[x];
+    return x;
+}
+
+// Raise a node's degree and keep the leaf/internal counters in sync
+static void degree_inc(PartialTree *t, int x) {
+    int d = ++t->degree[x];
+    if (d == 1) {
+        t->leaves++;
+    } else if (d == 2) {
+        t->leaves--;
+        t->internal++;
+    }
+}
+
+// Lower a node's degree (exact inverse of degree_inc)
+static void degree_dec(PartialTree *t, int x) {
+    int d = t->degree[x]--;
+    if (d == 1) {
+        t->leaves--;
+    } else if (d == 2) {
+        t->leaves++;
+        t->internal--;
+    }
+}
+
+// Add edge e to the partial tree
+// Returns the root that was attached below the other one (needed to undo), or -1 if e closes a cycle
+static int push_edge(PartialTree *t, Edge e) {
+    int ru = uf_find(t, e.u);
+    int rv = uf_find(t, e.v);
+    if (ru == rv)
+        return -1; // Both ends already connected: this edge would form a cycle
+
+    // Attach the lower-rank root below the higher-rank one
+    if (t->uf_rank[ru] < t->uf_rank[rv]) {
+        int tmp = ru;
+        ru = rv;
+        rv = tmp;
+    }
+    t->uf_parent[rv] = ru;
+    if (t->uf_rank[ru] == t->uf_rank[rv])
+        t->uf_rank[ru]++;
+
+    degree_inc(t, e.u);
+    degree_inc(t, e.v);
+    return rv;
+}
+
+// Undo the most recent push_edge of edge e (child is the value push_edge returned)
+static void pop_edge(PartialTree *t, Edge e, int child) {
+    int root = t->uf_parent[child];
+    t->uf_parent[child] = child;
+    if (t->uf_rank[root] == t->uf_rank[child] + 1)
+        t->uf_rank[root]--;
+
+    degree_dec(t, e.u);
+    degree_dec(t, e.v);
+}
+
+// Word-sized kernel for graphs that fit in a machine word (n <= 32 or n <= 64)
+// Each node is one bit, so a node set or one node's adjacency is a single integer.
+// DEFINE_MASK_KERNELS(bits, word, ctz) generates, for one word width:
+//   is_connected_<bits>: bit-parallel BFS over adjacency masks (one OR per visited node)
+#define DEFINE_MASK_KERNELS(bits, word, ctz)                                             \
+static int is_connected_##bits(const Edge *combo, int k, int n) {                       \
+    word adj[bits] = {0};                                                               \
+    word all = (n == bits) ? (word)~(word)0 : (((word)1 << n) - 1);                     \
+    /* Loop through the edges to build each node's adjacency mask */                    \
+    for (int i = 0; i < k; i++) {                                                       \
+        adj[combo[i].u] |= (word)1 << combo[i].v;                                       \
+        adj[combo[i].v] |= (word)1 << combo[i].u;                                       \
+    }                                                                                   \
+    word seen = 1, frontier = 1;                                                        \
+    /* Loop until no new node is reached: the next frontier is the union of the */      \
+    /* adjacency masks of the current one, minus everything already seen */             \
+    while (frontier) {                                                                  \
+        word next = 0;                                                                  \
+        while (frontier) {                                                              \
+            next |= adj[ctz(frontier)];                                                 \
+            frontier &= frontier - 1;                                                   \
+        }                                                                               \
+        frontier = next & ~seen;                                                        \
+        seen |= next;                                                                   \
+    }                                                                                   \
+    return (seen & all) == all;                                                         \
+}
+
+DEFINE_MASK_KERNELS(32, uint32_t, __builtin_ctz)
+DEFINE_MASK_KERNELS(64, uint64_t, __builtin_ctzll)
+
+// Check if the combination of edges forms a connected graph
+// Returns 1 if all nodes are connected (k = n-1 connected edges form a spanning tree), 0 otherwise
+// Dispatches to the smallest word-sized kernel that fits n (n never exceeds MAX_NODES = 64 here)
+static int is_connected(const Edge *combo, int k, int n) {
+    if (n <= 32)
+        return is_connected_32(combo, k, n);
+    return is_connected_64(combo, k, n);
+}
+
+// Binomial coefficients C(a, b) for the combinatorial number system (saturated at ULLONG_MAX)
+// The combination with edge indices c0 < c1 < ... < c(k-1) has lexicographic rank
+// sum over positions p of C(m-1-j, k-1-p) for every index j skipped before c(p) was picked.
+// Filled once (init_binomials) and only read afterwards, so every solver can share it.
+static unsigned long long binom[MAX_EDGES + 1][MAX_EDGES + 1];
+static pthread_once_t binom_once = PTHREAD_ONCE_INIT;
+
+// Fill the binomial table with Pascal's rule
+static void fill_binomials(void) {
+    for (int a = 0; a <= MAX_EDGES; a++) {
+        binom[a][0] = 1;
+        for (int b = 1; b <= MAX_EDGES; b++) {
+            unsigned long long x = (a > 0) ? binom[a - 1][b - 1] : 0;
+            unsigned long long y = (a > 0) ? binom[a - 1][b] : 0;
+            binom[a][b] = (x > ULLONG_MAX - y) ? ULLONG_MAX : x + y;
+        }
+    }
+}
+
+static void init_binomials(void) {
+    pthread_once(&binom_once, fill_binomials);
+}
+
+// Number of k-combinations that start with edge index i at position p (the rest picked after i)
+static unsigned long long combos_below(int m, int k, int p, int i) {
+    return binom[m - i - 1][k - p - 1];
+}
+
+// Lexicographic rank of the k-combination idx[0] < idx[1] < ... of m edges
+static unsigned long long combination_rank(const int *idx, int k, int m) {
+    unsigned long long rank = 0;
+    int j = 0;
+    // Loop over positions, adding the combinations that start with each skipped index
+    for (int p = 0; p < k; p++) {
+        for (; j < idx[p]; j++)
+            rank += combos_below(m, k, p, j);
+        j = idx[p] + 1;
+    }
+    return rank;
+}
+
+// Inverse of combination_rank: writes the k-combination with the given rank into idx
+static void combination_unrank(unsigned long long rank, int k, int m, int *idx) {
+    int j = 0;
+    // Loop over positions, skipping whole blocks of combinations until rank falls inside one
+    for (int p = 0; p < k; p++) {
+        while (rank >= combos_below(m, k, p, j)) {
+            rank -= combos_below(m, k, p, j);
+            j++;
+        }
+        idx[p] = j++;
+    }
+}
+
+unsigned long long mlst_count_combinations(int m, int k) {
+    if (m < 0 || k < 0 || k > m)
+        return 0;
+    if (m > MAX_EDGES)
+        return ULLONG_MAX;
+    init_binomials();
+    return binom[m][k];
+}
+
+// FNV-1a fingerprint of the input graph, so shard files from a different graph are rejected
+static unsigned long long graph_fingerprint(const Edge *edges, int m, int n) {
+    unsigned long long h = 1469598103934665603ULL;
+    int values[2];
+    // Loop over the node count and every edge endpoint
+    for (int i = -1; i < m; i++) {
+        values[0] = (i < 0) ? n : edges[i].u;
+        values[1] = (i < 0) ? m : edges[i].v;
+        for (int j = 0; j < 2; j++) {
+            h ^= (unsigned)values[j];
+            h *= 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+unsigned long long mlst_graph_fingerprint(const MlstGraph *g) {
+    return graph_fingerprint(g->edges, g->m, g->n);
+}
+
+/*
+Twin symmetry breaking
+
+Two nodes are twins if they have the same neighbours apart from each other (and are both pinned
+or both not). Swapping them is an automorphism: it maps every spanning tree to one with the same
+leaves. For a class of twins v1 < v2 < ... < vk the swaps (vi vi+1) generate every permutation of
+the class. Swap t turns each edge vi-w into vi+1-w and back, so it pairs up those edges.
+
+A combination T is lexicographically no larger than its image under swap t exactly when, at the
+first pair (in order of the lower edge index) where T holds one edge but not the other, T holds
+the lower one. The lexicographically first optimal tree passes this test for every swap, since
+its images have the same leaves. The searches below therefore drop every prefix that already
+fails a test and still return the same tree, without visiting its mirror images.
+*/
+#define MAX_SWAPS MAX_NODES
+#define MAX_ROLES 4            // an edge u-w is paired by at most two swaps at u and two at w
+
+typedef struct {
+    int count;                     // twin swaps (0 = no symmetry breaking)
+    int pairs[MAX_SWAPS];          // edge pairs of each swap
+    int lo[MAX_SWAPS][MAX_NODES];  // pair j of swap t: its lower and higher edge index,
+    int hi[MAX_SWAPS][MAX_NODES];  // pairs ordered by the lower one
+    int roles[MAX_EDGES];          // swaps each edge is paired by
+    int role[MAX_EDGES][MAX_ROLES];
+} Symmetry;
+
+// How the edges decided so far compare against each swap
+typedef struct {
+    uint64_t satisfied;            // swaps whose first differing pair holds the lower edge
+    unsigned char equal[MAX_SWAPS]; // leading pairs of each swap that are decided and alike
+} SymmetryState;
+
+// No swaps: every combination is searched
+static void symmetry_clear(Symmetry *y, int m) {
+    y->count = 0;
+    for (int i = 0; i < m; i++)
+        y->roles[i] = 0;
+}
+
+// Add the swap of twins a and b, pairing the edges a-w and b-w of each common neighbour w
+static void symmetry_add_swap(Symmetry *y, int a, int b, const uint64_t *adj, int (*edge_id)[MAX_NODES]) {
+    int t = y->count, p = 0;
+    // Loop over the common neighbours, inserting each pair in order of its lower edge
+    for (uint64_t x = adj[a] & ~((uint64_t)1 << b); x; x &= x - 1) {
+        int w = __builtin_ctzll(x);
+        int e1 = edge_id[a][w], e2 = edge_id[b][w];
+        int lo = e1 < e2 ? e1 : e2, hi = e1 < e2 ? e2 : e1;
+        if (y->roles[lo] == MAX_ROLES || y->roles[hi] == MAX_ROLES)
+            return; // Cannot happen for twins, but dropping a swap is always safe
+        int j = p++;
+        for (; j > 0 && y->lo[t][j - 1] > lo; j--) {
+            y->lo[t][j] = y->lo[t][j - 1];
+            y->hi[t][j] = y->hi[t][j - 1];
+        }
+        y->lo[t][j] = lo;
+        y->hi[t][j] = hi;
+    }
+    if (p == 0)
+        return;
+    y->pairs[t] = p;
+    for (int j = 0; j < p; j++) {
+        y->role[y->lo[t][j]][y->roles[y->lo[t][j]]++] = t;
+        y->role[y->hi[t][j]][y->roles[y->hi[t][j]]++] = t;
+    }
+    y->count++;
+}
+
+// Find the twin classes of a graph and the swaps between consecutive twins
+// Graphs with self-loops or parallel edges are left without symmetry breaking
+static void symmetry_init(Symmetry *y, const Edge *edges, int m, int n, uint64_t pinned) {
+    symmetry_clear(y, m);
+    if (n < 3)
+        return;
+    int edge_id[MAX_NODES][MAX_NODES];
+    uint64_t adj[MAX_NODES] = {0};
+    for (int i = 0; i < m; i++) {
+        int u = edges[i].u, v = edges[i].v;
+        if (u == v || (adj[u] >> v & 1))
+            return;
+        adj[u] |= (uint64_t)1 << v;
+        adj[v] |= (uint64_t)1 << u;
+        edge_id[u][v] = edge_id[v][u] = i;
+    }
+    uint64_t placed = 0;           // nodes already in an earlier node's class
+    for (int a = 0; a < n; a++) {
+        if (placed >> a & 1)
+            continue;
+        int last = a;
+        for (int b = a + 1; b < n; b++) {
+            uint64_t bit_a = (uint64_t)1 << a, bit_b = (uint64_t)1 << b;
+            if ((placed & bit_b) || (adj[a] & ~bit_b) != (adj[b] & ~bit_a) ||
+                ((pinned >> a ^ pinned >> b) & 1))
+                continue;
+            placed |= bit_b;
+            symmetry_add_swap(y, last, b, adj, edge_id);
+            last = b;
+        }
+    }
+}
+
+// Edge e has just been picked or skipped (every lower edge already was, chosen holds the picked ones)
+// Returns 0 if some swap now maps every combination with these decisions to a smaller one
+static int symmetry_decide(const Symmetry *y, SymmetryState *st, const uint64_t *chosen, int e) {
+    for (int r = 0; r < y->roles[e]; r++) {
+        int t = y->role[e][r];
+        if (st->satisfied >> t & 1)
+            continue;
+        // Loop over the leading pairs of swap t that are now decided (a pair is once its higher edge is)
+        while (st->equal[t] < y->pairs[t]) {
+            int lo = y->lo[t][st->equal[t]], hi = y->hi[t][st->equal[t]];
+            if (hi > e)
+                break;
+            int has_lo = chosen[lo >> 6] >> (lo & 63) & 1, has_hi = chosen[hi >> 6] >> (hi & 63) & 1;
+            if (has_lo == has_hi) {
+                st->equal[t]++;
+                continue;
+            }
+            if (!has_lo)
+                return 0;
+            st->satisfied |= (uint64_t)1 << t;
+            break;
+        }
+    }
+    return 1;
+}
+
+// State of the lexicographic enumeration of every spanning tree
+typedef struct {
+    const Edge *edges;
+    int m, k, n;
+    uint64_t pinned;
+    const MlstExactOptions *opt;
+    PartialTree tree;
+    const Symmetry *sym;       // twin swaps to break (none unless opt->symmetry)
+    uint64_t chosen[2];        // edge indices of the combination being built, as bits
+    Edge current[MAX_NODES];   // edges of the combination being built
+    long long trees;           // spanning trees reached
+    unsigned long long combinations; // combinations checked: the trees and the completions of prefixes with a cycle
+    int bound;                 // no tree has more leaves (bounds.upper): the search stops once one has this many
+    int best_leaves;           // -1 until the first tree
+    Edge best_tree[MAX_NODES];
+    MlstStats *stats;          // instrumentation (STAT_ macros, compiled out unless MLST_STATS)
+    double started;            // monotonic time the search started
+} Enumeration;
+
+// Recursive function to generate all combinations of k edges from the list of edges
+// For each combination, checks if it forms a valid spanning tree and updates the best tree if needed
+// The partial tree (union-find + degrees) is updated as each edge is picked and undone on return,
+// so a complete combination is known to be a spanning tree and its leaf count is already at hand.
+/**
+ * Generates all possible combinations of e->k edges from the e->m edges.
+ *
+ * @param e       Enumeration state (graph, partial tree, current combination and best tree).
+ * @param start   Current starting index in the edges array for combination generation.
+ * @param cpos    Current position in the current combination array to insert the next edge.
+ * @param st      Twin symmetry state of the edges below start.
+ */
+static void generate_combinations(Enumeration *e, int start, int cpos, const SymmetryState *st) {
+    // Step 1: Base case - if we've picked k edges, process this combination
+    if (cpos == e->k) {
+        // Step 2: k edges without a cycle on n nodes always form a spanning tree
+        int leaves = e->tree.leaves;
+        e->trees++;
+        e->combinations++;
+        if (e->opt->on_tree)
+            e->opt->on_tree(e->opt->user, e->trees, e->current, e->k, e->tree.degree, leaves);
+
+        // Step 3: If this tree has more leaves than the best so far, update the best
+        if (leaves > e->best_leaves) {
+            e->best_leaves = leaves;
+            memcpy(e->best_tree, e->current, e->k * sizeof(Edge));
+            STAT_IMPROVE(e->stats, e->started, leaves);
+            if (e->opt->on_improve)
+                e->opt->on_improve(e->opt->user, leaves);
+        }
+        // Step 4: Return to stop further recursion for this combination
+        return;
+    }
+
+    // Step 5: Recursive case - try each possible edge at the current position
+    // (stopping early when too few edges are left to fill the remaining positions, or once a tree
+    // reached the upper bound: trees come in lexicographic order, so it is already the tie-break winner)
+    SymmetryState skip = *st;  // the edges from start to i-1 are skipped
+    for (int i = start; i <= e->m - (e->k - cpos) && e->best_leaves < e->bound; i++) {
+        int child = push_edge(&e->tree, e->edges[i]);
+        STAT_INC(e->stats->edges_tried);
+        if (child < 0) {
+            // Every combination that completes this prefix contains the cycle
+            unsigned long long rejected = combos_below(e->m, e->k, cpos, i);
+            e->combinations = (rejected > ULLONG_MAX - e->combinations) ? ULLONG_MAX : e->combinations + rejected;
+            STAT_INC(e->stats->cycles);
+        }
+        if (child >= 0) {      // An edge that closes a cycle cannot be part of any tree
+            SymmetryState pick = skip;
+            e->chosen[i >> 6] |= (uint64_t)1 << (i & 63);
+            e->current[cpos] = e->edges[i]; // Place edge at current position
+            // Step 6: Recurse to fill the next position in the combination (unless a twin swap maps it to an earlier one)
+            if (symmetry_decide(e->sym, &pick, e->chosen, i))
+                generate_combinations(e, i + 1, cpos + 1, &pick);
+            e->chosen[i >> 6] &= ~((uint64_t)1 << (i & 63));
+            pop_edge(&e->tree, e->edges[i], child);
+        }
+        // Step 7: Leaving edge i out may already map every later combination to an earlier one
+        if (!symmetry_decide(e->sym, &skip, e->chosen, i))
+            break;
+    }
+}
+
+// Degree table for the revolving-door enumeration
+// Each step swaps one edge out and one edge in, so all counters are updated in O(1)
+typedef struct {
+    int degree[MAX_NODES];
+    int leaves;                // nodes with degree 1
+    int isolated;              // nodes with degree 0 (while any exist, the edges cannot span the graph;
+                               // pinned nodes start at 2 and are left to the connectivity check)
+} GrayState;
+
+// Everything the revolving-door enumeration keeps
+typedef struct {
+    const Edge *edges;
+    int k, n;
+    uint64_t pinned;
+    const MlstExactOptions *opt;
+    GrayState g;
+    int c[MAX_EDGES + 2];      // c[1] < c[2] < ... < c[k] are edge indices, c[k+1] = m is a sentinel
+    int bound;                 // no tree has more leaves (bounds.upper): the search stops once one has this many
+    int best_leaves;           // -1 until the first tree
+    int best_idx[MAX_NODES];
+    long long combinations;    // combinations visited
+    long long checks;          // connectivity checks (only done when no node is isolated)
+    long long trees;           // spanning trees found
+    MlstStats *stats;          // instrumentation (STAT_ macros)
+    double started;            // monotonic time the search started
+} GraySearch;
+
+// Add (delta = +1) or remove (delta = -1) one edge endpoint at node x
+static void gray_touch(GrayState *g, int x, int delta) {
+    int before = g->degree[x];
+    int after = before + delta;
+    g->degree[x] = after;
+    g->leaves += (after == 1) - (before == 1);
+    g->isolated += (after == 0) - (before == 0);
+}
+
+// Swap edge out for edge in (either may be NULL while building the first combination)
+static void gray_swap(GrayState *g, const Edge *out, const Edge *in) {
+    if (out) {
+        gray_touch(g, out->u, -1);
+        gray_touch(g, out->v, -1);
+    }
+    if (in) {
+        gray_touch(g, in->u, +1);
+        gray_touch(g, in->v, +1);
+    }
+}
+
+// Visit one combination (edge indices c[1..k]): connectivity is only checked when no node is isolated
+static void gray_visit(GraySearch *s) {
+    int k = s->k, n = s->n;
+    const int *c = s->c;
+    s->combinations++;
+    if (s->g.isolated > 0 && n > 1)
+        return; // Some node has no edge: cannot be a spanning tree, no check needed
+
+    // k = n-1 edges span the graph exactly when they connect it (word-sized kernel)
+    Edge combo[MAX_NODES];
+    for (int j = 1; j <= k; j++)
+        combo[j - 1] = s->edges[c[j]];
+    s->checks++;
+    if (!is_connected(combo, k, n))
+        return;
+    s->trees++;
+
+    // More leaves wins; ties go to the lexicographically smallest edge set, like the other modes
+    int better = s->g.leaves > s->best_leaves;
+    if (s->g.leaves == s->best_leaves) {
+        for (int j = 1; j <= k && !better; j++) {
+            if (c[j] != s->best_idx[j - 1]) {
+                better = c[j] < s->best_idx[j - 1];
+                break;
+            }
+        }
+    }
+    if (better) {
+        if (s->g.leaves > s->best_leaves)
+            STAT_IMPROVE(s->stats, s->started, s->g.leaves);
+        if (s->g.leaves > s->best_leaves && s->opt->on_improve)
+            s->opt->on_improve(s->opt->user, s->g.leaves);
+        s->best_leaves = s->g.leaves;
+        for (int j = 1; j <= k; j++)
+            s->best_idx[j - 1] = c[j];
+    }
+}
+
+// Advance c[1..k] (c[1] < c[2] < ... < c[k], c[k+1] = m) to the next combination in revolving-door order
+// Knuth, TAOCP 7.2.1.3, Algorithm R: sets out/in to the index that left and the one that entered
+// Returns 0 once every combination has been visited (needs 0 < k < m)
+static int gray_next(int *c, int k, int *out, int *in) {
+    // Easy case: move c[1] up (k odd) or down (k even) by one
+    if (k % 2 == 1 && c[1] + 1 < c[2]) {
+        *out = c[1];
+        *in = ++c[1];
+        return 1;
+    }
+    if (k % 2 == 0 && c[1] > 0) {
+        *out = c[1];
+        *in = --c[1];
+        return 1;
+    }
+
+    // Otherwise alternate between trying to decrease and to increase c[j], for j = 2, 3, ...
+    int decrease = (k % 2 == 1);
+    for (int j = 2; j <= k; j++) {
+        if (decrease && c[j] >= j) {
+            // Here c[j] == c[j-1] + 1: drop c[j], bring in j-2
+            *out = c[j];
+            *in = j - 2;
+            c[j] = c[j - 1];
+            c[j - 1] = j - 2;
+            return 1;
+        }
+        if (!decrease && c[j] + 1 < c[j + 1]) {
+            // Here c[j-1] == j-2: drop j-2, bring in c[j] + 1
+            *out = c[j - 1];
+            *in = c[j] + 1;
+            c[j - 1] = c[j];
+            c[j]++;
+            return 1;
+        }
+        decrease = !decrease;
+    }
+    return 0;
+}
+
+/**
+ * Exhaustive search that walks all k-edge combinations in revolving-door (Gray code) order
+ * (Knuth, TAOCP 7.2.1.3, Algorithm R): consecutive combinations differ by exactly one edge out
+ * and one edge in, so the degree table and leaf counter are updated in O(1) per step.
+ * Connectivity is only checked for combinations in which every node has at least one edge.
+ * Finds the same best tree as generate_combinations (most leaves, lexicographically first), except
+ * that it stops at the first tree reaching s->bound, which need not be the lexicographically first one.
+ *
+ * @param s       Search state with edges, k and n set; receives the best tree and the counters.
+ * @param m       Total number of available edges in the edges array.
+ */
+static void revolving_door_search(GraySearch *s, int m) {
+    int k = s->k;
+    int *c = s->c;
+    s->combinations = s->checks = s->trees = 0;
+    s->best_leaves = -1;
+    if (k > m)
+        return;
+
+    // Step 1: Start from the combination {0, 1, ..., k-1}
+    for (int i = 0; i < s->n; i++)
+        s->g.degree[i] = base_degree(s->pinned, i);
+    s->g.leaves = 0;
+    s->g.isolated = s->n - __builtin_popcountll(s->pinned);
+    for (int j = 1; j <= k; j++) {
+        c[j] = j - 1;
+        gray_swap(&s->g, NULL, &s->edges[c[j]]);
+    }
+    c[k + 1] = m;
+    gray_visit(s);
+    if (k == 0 || k == m)
+        return; // Only one combination exists
+
+    // Step 2: Each step moves to the next combination by swapping one edge, until a tree reaches the bound
+    int out, in;
+    while (s->best_leaves < s->bound && gray_next(c, k, &out, &in)) {
+        gray_swap(&s->g, &s->edges[out], &s->edges[in]);
+        gray_visit(s);
+    }
+}
+
+// Branch-and-bound search description shared (read-only, apart from the atomics) by all workers
+typedef struct {
+    const Edge *edges;
+    int m, k, n;
+    uint64_t pinned;           // nodes that can never be leaves
+    int last_edge[MAX_NODES];  // index of the last edge touching each node (-1 if none)
+    int optimum;               // leaf count that cannot be beaten (the best upper bound, at most a star)
+    const Symmetry *sym;       // twin swaps: combinations a swap maps to an earlier one are skipped
+    int ranked;                // 1 if C(m, k) fits in 64 bits, so combinations can be ranked
+    unsigned long long rank_lo, rank_hi; // only combinations with rank in [rank_lo, rank_hi) are searched
+    atomic_llong incumbent;    // shared incumbent every worker prunes against (see bnb_key)
+    const MlstExactOptions *opt; // trace callbacks
+    MlstStats *stats;          // instrumentation: the improvements are recorded under snapshot_lock
+    double started;            // monotonic time the search started
+
+    // Run control, set up before the search starts
+    double time_limit;           // seconds of search before stopping early (0 = no limit)
+    const char *checkpoint_path; // where to write checkpoints (NULL = none)
+    double checkpoint_interval;  // seconds between two checkpoints
+    int shard, num_shards;       // recorded in checkpoints (-1 / 0 when not sharded)
+    unsigned long long range_lo; // first rank of the whole run (rank_lo moves forward on resume)
+    int seed_leaves;             // incumbent carried over from a checkpoint (-1 if none)
+    unsigned long long seed_rank;
+    long long seed_trees;        // spanning trees reached before the checkpoint
+
+    // Progress shared with the checkpoint/time-limit monitor
+    atomic_int stop;             // set when the time limit is hit: every worker unwinds
+    atomic_llong trees_done;     // spanning trees reached so far (flushed periodically by workers)
+    pthread_mutex_t snapshot_lock;
+    long long snapshot_key;      // best tree published so far (bnb_key) and its edge indices
+    int snapshot_idx[MAX_NODES];
+
+    int best_leaves;           // result: leaves of the best tree found (-1 if none)
+    int best_idx[MAX_NODES];   // result: edge indices of the best tree found
+    int timed_out;             // result: 1 if the time limit stopped the search (optimality unproven)
+    unsigned long long position; // result: every rank below this one has been searched
+} SearchShared;
+
+// Totals reported by a search
+typedef struct {
+    long long nodes;           // search nodes expanded
+    long long pruned;          // branches cut by the leaf bound
+    long long symmetric;       // branches cut by twin symmetry breaking
+    long long trees;           // complete spanning trees reached
+    long long edges_tried;     // instrumentation: edges pushed, and those that closed a cycle
+    long long cycles;
+} SearchStats;
+
+// One unit of parallel work: the subtree below a fixed prefix of picked edges
+typedef struct {
+    int prefix[MAX_NODES];     // indices of the fixed first edges
+    int depth;                 // number of fixed edges
+    int index;                 // position of the task in lexicographic order
+    unsigned long long base;   // rank of the first combination below the prefix
+    int best_leaves;           // best tree found in this subtree (-1 if none)
+    int best_idx[MAX_NODES];   // its edge indices
+    atomic_int state;          // 0 = waiting, 1 = running, 2 = finished
+    atomic_ullong position;    // every rank of this task below position has been searched
+} SearchTask;
+
+// Per-thread search state: nothing in here is shared between workers
+typedef struct {
+    SearchShared *shared;
+    SearchTask *task;          // task being searched
+    PartialTree tree;
+    int picked[MAX_NODES];     // indices of the edges in the partial tree
+    uint64_t chosen[2];        // the same edges as bits (for the symmetry tests)
+    long long nodes;           // search nodes expanded
+    long long pruned;          // branches cut by the leaf bound
+    long long symmetric;       // branches cut by twin symmetry breaking
+    long long trees;           // complete spanning trees reached
+    long long edges_tried;     // instrumentation: edges pushed, and those that closed a cycle
+    long long cycles;
+    long long trees_flushed;   // part of trees already added to shared->trees_done
+    int stopped;               // the time limit was hit while running the current task
+} SearchWorker;
+
+// Optimistic bound on the leaves of any spanning tree that extends the current partial tree
+// Internal nodes stay internal, a tree with 3 or more nodes has at least one internal node,
+// and no tree of the graph beats optimum
+static int bnb_upper_bound(const PartialTree *t, int n, int optimum) {
+    int internal = t->internal;
+    if (n >= 3 && internal == 0)
+        internal = 1;
+    return n - internal < optimum ? n - internal : optimum;
+}
+
+// Most leaves any spanning tree of n nodes can have when the pinned nodes are never leaves
+static int star_bound(int n, uint64_t pinned) {
+    int bound = (n >= 3) ? n - 1 : (n == 2 ? 2 : 0);
+    int free_nodes = n - __builtin_popcountll(pinned);
+    return free_nodes < bound ? free_nodes : bound;
+}
+
+// Prepare the shared branch-and-bound state for a graph with n nodes and m edges
+// (snapshot_lock is initialized once, when the context is created)
+static void bnb_init(SearchShared *s, const Edge *edges, int m, int n, uint64_t pinned) {
+    s->edges = edges;
+    s->m = m;
+    s->k = n - 1;
+    s->n = n;
+    s->pinned = pinned;
+    for (int i = 0; i < n; i++)
+        s->last_edge[i] = -1;
+    // Loop to remember the last edge each node can still be connected by
+    for (int i = 0; i < m; i++) {
+        s->last_edge[edges[i].u] = i;
+        s->last_edge[edges[i].v] = i;
+    }
+    // A star (n-1 leaves) is the best any tree on n >= 3 nodes can do; with 2 nodes both ends are leaves
+    s->optimum = star_bound(n, pinned);
+    // By default the whole rank range [0, C(m, k)) is searched
+    s->rank_lo = 0;
+    s->rank_hi = (s->k <= m) ? binom[m][s->k] : 0;
+    s->ranked = (s->rank_hi != ULLONG_MAX);
+    s->range_lo = 0;
+    s->best_leaves = -1;
+    atomic_init(&s->incumbent, 0);
+    s->opt = NULL;
+
+    s->time_limit = 0;
+    s->checkpoint_path = NULL;
+    s->checkpoint_interval = 60;
+    s->shard = -1;
+    s->num_shards = 0;
+    s->seed_leaves = -1;
+    s->seed_rank = 0;
+    s->seed_trees = 0;
+    atomic_init(&s->stop, 0);
+    atomic_init(&s->trees_done, 0);
+    s->snapshot_key = 0;
+    s->timed_out = 0;
+    s->position = 0;
+}
+
+// Orders (leaves, task) pairs: more leaves first, then the earlier task
+// A tree is only kept if its key beats the incumbent, so ties always go to the earliest task
+static long long bnb_key(int leaves, int task_index) {
+    return ((long long)leaves << 32) | (unsigned)(INT_MAX - task_index);
+}
+
+// Continue a checkpointed search: only ranks from position on are searched, and the
+// checkpoint's best tree is the starting incumbent (ties are still explored, see bnb_key)
+static void bnb_resume(SearchShared *s, unsigned long long position, int leaves, unsigned long long rank, long long trees) {
+    s->rank_lo = position;
+    s->seed_leaves = leaves;
+    s->seed_rank = rank;
+    s->seed_trees = trees;
+    if (leaves >= 0)
+        atomic_store(&s->incumbent, bnb_key(leaves, INT_MAX));
+}
+
+// Skipping edge i strands any untouched node whose last edge is i
+static int bnb_strands_node(const SearchShared *s, const PartialTree *t, int i) {
+    Edge e = s->edges[i];
+    return (t->degree[e.u] == base_degree(s->pinned, e.u) && s->last_edge[e.u] == i) ||
+           (t->degree[e.v] == base_degree(s->pinned, e.v) && s->last_edge[e.v] == i);
+}
+
+// Raise the shared incumbent to a tree with leaves leaves found in task task_index
+// The tree itself is kept in a snapshot so a checkpoint can record it
+static void bnb_publish(SearchShared *s, int leaves, int task_index, const int *idx) {
+    long long key = bnb_key(leaves, task_index);
+    long long cur = atomic_load(&s->incumbent);
+    while (key > cur) {
+        if (atomic_compare_exchange_weak(&s->incumbent, &cur, key)) {
+            if ((cur >> 32) < leaves && s->opt && s->opt->on_improve)
+                s->opt->on_improve(s->opt->user, leaves);
+            pthread_mutex_lock(&s->snapshot_lock);
+            if (key > s->snapshot_key) {
+                s->snapshot_key = key;
+                memcpy(s->snapshot_idx, idx, s->k * sizeof(int));
+            }
+            if ((cur >> 32) < leaves)
+                STAT_IMPROVE(s->stats, s->started, leaves);
+            pthread_mutex_unlock(&s->snapshot_lock);
+            break;
+        }
+    }
+}
+
+/**
+ * Exact branch-and-bound search over the same edge combinations as generate_combinations.
+ * Instead of checking each complete combination, a branch is dropped as soon as:
+ *   - the newly picked edge closes a cycle,
+ *   - too few edges are left to reach k edges, or a node can no longer be connected at all,
+ *   - the optimistic leaf bound cannot beat the task's best tree or the shared incumbent.
+ * Once a provably optimal tree (shared->optimum) is found, every later branch fails the bound.
+ * Ties keep the lexicographically first tree, so the result does not depend on thread timing.
+ * Only combinations whose rank lies in [shared->rank_lo, shared->rank_hi) are visited.
+ * Every 1024 nodes the worker publishes its position (ranks below base are done) and
+ * checks whether the time limit has stopped the search.
+ *
+ * @param w       Worker running the search (holds the partial tree and the current task).
+ * @param start   Index of the first edge that may still be picked.
+ * @param cpos    Number of edges picked so far.
+ * @param base    Rank of the first combination that extends the picked edges.
+ * @param st      Twin symmetry state of the edges below start.
+ */
+static void branch_and_bound(SearchWorker *w, int start, int cpos, unsigned long long base, const SymmetryState *st) {
+    SearchShared *s = w->shared;
+    SearchTask *task = w->task;
+    if (w->stopped)
+        return;
+    if ((++w->nodes & 1023) == 0) {
+        // Lexicographic depth-first order: every combination ranked below base is finished
+        atomic_store_explicit(&task->position, base > s->rank_lo ? base : s->rank_lo, memory_order_relaxed);
+        atomic_fetch_add_explicit(&s->trees_done, w->trees - w->trees_flushed, memory_order_relaxed);
+        w->trees_flushed = w->trees;
+        if (atomic_load_explicit(&s->stop, memory_order_relaxed)) {
+            w->stopped = 1;
+            return;
+        }
+    }
+
+    // Step 1: k acyclic edges on n nodes always form a spanning tree
+    if (cpos == s->k) {
+        w->trees++;
+        if (w->tree.leaves > task->best_leaves) {
+            task->best_leaves = w->tree.leaves;
+            memcpy(task->best_idx, w->picked, s->k * sizeof(int));
+            bnb_publish(s, task->best_leaves, task->index, task->best_idx);
+        }
+        return;
+    }
+
+    // Step 2: Drop this branch if even the optimistic bound cannot beat the best tree
+    // (a tie only wins if it comes from an earlier task, i.e. earlier in lexicographic order)
+    int bound = bnb_upper_bound(&w->tree, s->n, s->optimum);
+    if (bound <= task->best_leaves ||
+        bnb_key(bound, task->index) <= atomic_load_explicit(&s->incumbent, memory_order_relaxed)) {
+        w->pruned++;
+        return;
+    }
+
+    // Step 3: Try each edge that still leaves enough edges to complete the tree
+    // (unless a twin swap maps every combination with it to an earlier one)
+    int last = s->m - (s->k - cpos);
+    SymmetryState skip = *st;  // the edges from start to i-1 are skipped
+    for (int i = start; i <= last; i++) {
+        // Skip edges whose whole block of combinations lies outside the rank range
+        unsigned long long below = s->ranked ? combos_below(s->m, s->k, cpos, i) : 0;
+        if (s->ranked && base >= s->rank_hi)
+            break;
+        if (!s->ranked || base + below > s->rank_lo) {
+            int child = push_edge(&w->tree, s->edges[i]);
+            STAT_INC(w->edges_tried);
+            if (child < 0)
+                STAT_INC(w->cycles);
+            if (child >= 0) {
+                SymmetryState pick = skip;
+                w->picked[cpos] = i;
+                w->chosen[i >> 6] |= (uint64_t)1 << (i & 63);
+                if (symmetry_decide(s->sym, &pick, w->chosen, i))
+                    branch_and_bound(w, i + 1, cpos + 1, base, &pick);
+                else
+                    w->symmetric++;
+                w->chosen[i >> 6] &= ~((uint64_t)1 << (i & 63));
+                pop_edge(&w->tree, s->edges[i], child);
+            }
+        }
+        base += below;
+
+        // Step 4: Skipping edge i would leave a node that can never be connected,
+        // or would map every later combination to an earlier one
+        if (bnb_strands_node(s, &w->tree, i))
+            break;
+        if (!symmetry_decide(s->sym, &skip, w->chosen, i)) {
+            w->symmetric++;
+            break;
+        }
+    }
+}
+
+// Growable list of search tasks (kept in the context, so its buffer is reused between searches)
+typedef struct {
+    SearchTask *items;
+    int count, capacity;
+    int failed;                // a task could not be added (out of memory)
+} TaskList;
+
+// Collect every feasible prefix of depth edges as a task, in lexicographic order
+// Uses the same cycle, dead-end and rank-range rules as branch_and_bound, so no task is hopeless from the start
+static void collect_tasks(SearchWorker *w, int start, int cpos, int depth, unsigned long long base,
+                          const SymmetryState *st, TaskList *list) {
+    SearchShared *s = w->shared;
+    if (list->failed)
+        return;
+    if (cpos == depth || cpos == s->k) {
+        if (mlst_reserve((void **)&list->items, &list->capacity, (size_t)list->count + 1, sizeof(SearchTask)) != 0) {
+            list->failed = 1;
+            return;
+        }
+        SearchTask *task = &list->items[list->count];
+        memcpy(task->prefix, w->picked, cpos * sizeof(int));
+        task->depth = cpos;
+        task->index = list->count++;
+        task->base = base;
+        task->best_leaves = -1;
+        atomic_init(&task->state, 0);
+        atomic_init(&task->position, base > s->rank_lo ? base : s->rank_lo);
+        return;
+    }
+
+    int last = s->m - (s->k - cpos);
+    SymmetryState skip = *st;
+    for (int i = start; i <= last; i++) {
+        unsigned long long below = s->ranked ? combos_below(s->m, s->k, cpos, i) : 0;
+        if (s->ranked && base >= s->rank_hi)
+            break;
+        if (!s->ranked || base + below > s->rank_lo) {
+            int child = push_edge(&w->tree, s->edges[i]);
+            if (child >= 0) {
+                SymmetryState pick = skip;
+                w->picked[cpos] = i;
+                w->chosen[i >> 6] |= (uint64_t)1 << (i & 63);
+                if (symmetry_decide(s->sym, &pick, w->chosen, i))
+                    collect_tasks(w, i + 1, cpos + 1, depth, base, &pick, list);
+                w->chosen[i >> 6] &= ~((uint64_t)1 << (i & 63));
+                pop_edge(&w->tree, s->edges[i], child);
+            }
+        }
+        base += below;
+        if (bnb_strands_node(s, &w->tree, i) || !symmetry_decide(s->sym, &skip, w->chosen, i))
+            break;
+    }
+}
+
+// Rebuild the task's prefix in the worker's partial tree and search everything below it
+static void run_task(SearchWorker *w, SearchTask *task) {
+    SearchShared *s = w->shared;
+    w->task = task;
+    tree_init(&w->tree, s->n, s->pinned);
+    w->chosen[0] = w->chosen[1] = 0;
+    // Loop to push the fixed edges of the prefix (acyclic by construction)
+    for (int d = 0; d < task->depth; d++) {
+        push_edge(&w->tree, s->edges[task->prefix[d]]);
+        w->picked[d] = task->prefix[d];
+        w->chosen[task->prefix[d] >> 6] |= (uint64_t)1 << (task->prefix[d] & 63);
+    }
+    int start = task->depth > 0 ? task->prefix[task->depth - 1] + 1 : 0;
+    // Replay the prefix's decisions against the twin swaps (collect_tasks already checked they pass)
+    SymmetryState st = {0};
+    for (int i = 0; i < start; i++)
+        symmetry_decide(s->sym, &st, w->chosen, i);
+    atomic_store(&task->state, 1);
+    branch_and_bound(w, start, task->depth, task->base, &st);
+    // A stopped task stays "running" so its last published position is what a checkpoint keeps
+    if (!w->stopped)
+        atomic_store(&task->state, 2);
+}
+
+// Double-ended task queue: the owner pops from the bottom, thieves steal from the top
+typedef struct {
+    int *items;                // task indices
+    int top, bottom;
+    pthread_mutex_t lock;
+} TaskDeque;
+
+// Everything one pool thread needs
+typedef struct {
+    SearchWorker worker;
+    TaskList *tasks;
+    TaskDeque *deques;
+    int id, num_threads;
+    pthread_t handle;
+    int started;               // handle is a running thread (thread 0 is the calling thread)
+} PoolThread;
+
+// The exact search's share of a solver context
+struct ExactContext {
+    SearchShared shared;
+    TaskList tasks;
+    PoolThread *threads;
+    int thread_capacity;
+    TaskDeque *deques;
+    int deque_capacity;
+    int *deque_items;          // backing store of every deque
+    int deque_item_capacity;
+    Enumeration enumeration;
+    GraySearch gray;
+    Symmetry sym;
+};
+
+// Take a task index from a deque (from the bottom if own, else from the top); -1 if empty
+static int deque_take(TaskDeque *d, int own) {
+    int index = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom)
+        index = own ? d->items[--d->bottom] : d->items[d->top++];
+    pthread_mutex_unlock(&d->lock);
+    return index;
+}
+
+// Pool thread: run own tasks first, then steal from the other threads until all queues are empty
+static void *pool_thread_main(void *arg) {
+    PoolThread *pt = arg;
+    for (;;) {
+        if (pt->worker.stopped || atomic_load(&pt->worker.shared->stop))
+            break; // Time limit: leave the remaining tasks for a resumed run
+        int index = deque_take(&pt->deques[pt->id], 1);
+        // Loop over the other threads' deques looking for work to steal
+        for (int j = 1; index < 0 && j < pt->num_threads; j++)
+            index = deque_take(&pt->deques[(pt->id + j) % pt->num_threads], 0);
+        if (index < 0)
+            break; // Tasks never spawn new tasks, so empty queues mean we are done
+        run_task(&pt->worker, &pt->tasks->items[index]);
+    }
+    // Flush the trees not yet counted in shared->trees_done (the final checkpoint reports them)
+    atomic_fetch_add(&pt->worker.shared->trees_done, pt->worker.trees - pt->worker.trees_flushed);
+    pt->worker.trees_flushed = pt->worker.trees;
+    return NULL;
+}
+
+// Every combination ranked below the returned value has been searched:
+// the smallest start of a waiting task or published position of an unfinished one
+static unsigned long long search_position(SearchShared *s, TaskList *tasks) {
+    unsigned long long position = s->rank_hi;
+    for (int i = 0; i < tasks->count; i++) {
+        SearchTask *task = &tasks->items[i];
+        if (atomic_load(&task->state) != 2) {
+            unsigned long long p = atomic_load_explicit(&task->position, memory_order_relaxed);
+            if (p < position)
+                position = p;
+        }
+    }
+    return position;
+}
+
+// Write the search position and the best tree so far to s->checkpoint_path
+// The file is written next to the target and renamed over it, so a crash never leaves half a checkpoint
+// Returns 0 on success, -1 if the file cannot be written
+static int write_checkpoint(SearchShared *s, unsigned long long position, long long trees, int leaves, const int *idx) {
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", s->checkpoint_path);
+    FILE *f = fopen(tmp_path, "w");
+    if (!f)
+        return -1;
+    fprintf(f, "mlst-checkpoint 1\n");
+    fprintf(f, "fingerprint %llx\n", graph_fingerprint(s->edges, s->m, s->n));
+    fprintf(f, "graph %d %d\n", s->n, s->m);
+    fprintf(f, "shard %d %d\n", s->shard, s->num_shards);
+    fprintf(f, "range %llu %llu\n", s->range_lo, s->rank_hi);
+    fprintf(f, "position %llu\n", position);
+    fprintf(f, "trees %lld\n", trees);
+    fprintf(f, "leaves %d\n", leaves);
+    fprintf(f, "rank %llu\n", leaves >= 0 ? combination_rank(idx, s->k, s->m) : 0ULL);
+    if (fclose(f) != 0)
+        return -1;
+    return rename(tmp_path, s->checkpoint_path) == 0 ? 0 : -1;
+}
+
+int mlst_read_checkpoint(const char *path, MlstCheckpoint *c) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return -1;
+    int version = 0;
+    int ok = fscanf(f, "mlst-checkpoint %d fingerprint %llx graph %d %d shard %d %d range %llu %llu "
+                       "position %llu trees %lld leaves %d rank %llu",
+                    &version, &c->fingerprint, &c->n, &c->m, &c->shard, &c->num_shards,
+                    &c->range_lo, &c->range_hi, &c->position, &c->trees, &c->best_leaves, &c->best_rank) == 12;
+    fclose(f);
+    return (ok && version == 1) ? 0 : -1;
+}
+
+// Checkpoint with the best tree known right now (the snapshot, or the incumbent a resume started from)
+static void checkpoint_now(SearchShared *s, TaskList *tasks) {
+    int idx[MAX_NODES];
+    unsigned long long position = search_position(s, tasks);
+    long long trees = s->seed_trees + atomic_load(&s->trees_done);
+    pthread_mutex_lock(&s->snapshot_lock);
+    int leaves = s->snapshot_key ? (int)(s->snapshot_key >> 32) : -1;
+    memcpy(idx, s->snapshot_idx, s->k * sizeof(int));
+    pthread_mutex_unlock(&s->snapshot_lock);
+
+    // The incumbent a resumed run started from wins ties: it has the lower rank or was found first
+    if (s->seed_leaves >= leaves && s->seed_leaves >= 0) {
+        leaves = s->seed_leaves;
+        combination_unrank(s->seed_rank, s->k, s->m, idx);
+    }
+    if (write_checkpoint(s, position, trees, leaves, idx) != 0)
+        fprintf(stderr, "Cannot write checkpoint %s\n", s->checkpoint_path);
+}
+
+// Background thread that enforces the time limit and writes periodic checkpoints
+typedef struct {
+    SearchShared *s;
+    TaskList *tasks;
+    double start;              // monotonic time the search started
+    int finished;              // set by the pool once every thread is done
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} Monitor;
+
+static void *monitor_main(void *arg) {
+    Monitor *mon = arg;
+    SearchShared *s = mon->s;
+    double deadline = mon->start + s->time_limit;
+    double next_checkpoint = mon->start + s->checkpoint_interval;
+    pthread_mutex_lock(&mon->lock);
+    while (!mon->finished) {
+        double now = mlst_seconds();
+        if (s->time_limit > 0 && now >= deadline && !atomic_load(&s->stop)) {
+            atomic_store(&s->stop, 1);
+            s->timed_out = 1;
+        }
+        if (s->checkpoint_path && now >= next_checkpoint) {
+            checkpoint_now(s, mon->tasks);
+            next_checkpoint = now + s->checkpoint_interval;
+        }
+
+        // Sleep until the next checkpoint or the deadline, or until the pool reports it is finished
+        double wake_at = s->checkpoint_path ? next_checkpoint : -1;
+        if (s->time_limit > 0 && !atomic_load(&s->stop) && (wake_at < 0 || deadline < wake_at))
+            wake_at = deadline;
+        if (wake_at < 0) {
+            pthread_cond_wait(&mon->wake, &mon->lock);
+            continue;
+        }
+        struct timespec ts;
+        ts.tv_sec = (time_t)wake_at;
+        ts.tv_nsec = (long)((wake_at - (double)ts.tv_sec) * 1e9);
+        pthread_cond_timedwait(&mon->wake, &mon->lock, &ts);
+    }
+    pthread_mutex_unlock(&mon->lock);
+    return NULL;
+}
+
+/**
+ * Runs the branch-and-bound search on a work-stealing pool of num_threads threads.
+ * The recursion tree is split into tasks by fixing the first few picked edges; each thread
+ * starts with a round-robin share of the tasks and steals from the others once it runs dry.
+ * The result is stored in s->best_leaves / s->best_idx; it is identical for any thread count.
+ * With s->time_limit or s->checkpoint_path set, a monitor thread stops the search at the deadline
+ * and writes checkpoints; s->timed_out and s->position then tell how far the search got.
+ * The task list, threads and deques are the context's, grown as needed and kept for the next search.
+ *
+ * @param c           Context whose shared state was prepared by bnb_init.
+ * @param num_threads Number of worker threads (1 runs the whole search in the calling thread).
+ * @param stats       Receives the search totals of all threads.
+ * @return MLST_OK, or MLST_ERROR_NO_MEMORY if the task list or the pool could not be allocated.
+ */
+static int parallel_branch_and_bound(ExactContext *c, int num_threads, SearchStats *stats) {
+    SearchShared *s = &c->shared;
+    if (mlst_reserve((void **)&c->threads, &c->thread_capacity, num_threads, sizeof(PoolThread)) != 0 ||
+        mlst_reserve((void **)&c->deques, &c->deque_capacity, num_threads, sizeof(TaskDeque)) != 0)
+        return MLST_ERROR_NO_MEMORY;
+    PoolThread *threads = c->threads;
+    memset(threads, 0, num_threads * sizeof(PoolThread));
+
+    // Step 1: Split the search into enough tasks to keep every thread busy (one task if serial)
+    SearchWorker *splitter = &threads[0].worker;
+    splitter->shared = s;
+    TaskList *tasks = &c->tasks;
+    tasks->failed = 0;
+    int target = num_threads > 1 ? 32 * num_threads : 1;
+    for (int depth = 0; depth <= s->k; depth++) {
+        tasks->count = 0;
+        SymmetryState st = {0};
+        tree_init(&splitter->tree, s->n, s->pinned);
+        collect_tasks(splitter, 0, 0, depth, 0, &st, tasks);
+        if (tasks->failed || tasks->count >= target)
+            break;
+    }
+    int per_deque = tasks->count / num_threads + 1;
+    if (tasks->failed ||
+        mlst_reserve((void **)&c->deque_items, &c->deque_item_capacity, (size_t)per_deque * num_threads, sizeof(int)) != 0)
+        return MLST_ERROR_NO_MEMORY;
+
+    // Step 2: Deal the tasks round-robin onto per-thread deques
+    TaskDeque *deques = c->deques;
+    for (int t = 0; t < num_threads; t++) {
+        deques[t].items = c->deque_items + (size_t)t * per_deque;
+        deques[t].top = deques[t].bottom = 0;
+        pthread_mutex_init(&deques[t].lock, NULL);
+    }
+    // Loop backwards so each owner pops its tasks in lexicographic order
+    for (int i = tasks->count - 1; i >= 0; i--) {
+        TaskDeque *d = &deques[i % num_threads];
+        d->items[d->bottom++] = i;
+    }
+
+    // Step 3: Run the pool (thread 0 is the calling thread; a thread that cannot start leaves its tasks to thieves)
+    for (int t = 0; t < num_threads; t++) {
+        threads[t].worker.shared = s;
+        threads[t].tasks = tasks;
+        threads[t].deques = deques;
+        threads[t].id = t;
+        threads[t].num_threads = num_threads;
+    }
+    for (int t = 1; t < num_threads; t++)
+        threads[t].started = pthread_create(&threads[t].handle, NULL, pool_thread_main, &threads[t]) == 0;
+    Monitor mon = {s, tasks, mlst_seconds(), 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+    pthread_t monitor;
+    int use_monitor = (s->time_limit > 0 || s->checkpoint_path);
+    if (use_monitor) {
+        // The monitor sleeps on monotonic deadlines, so its condition variable must use that clock
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&mon.wake, &attr);
+        pthread_condattr_destroy(&attr);
+        use_monitor = pthread_create(&monitor, NULL, monitor_main, &mon) == 0;
+    }
+    pool_thread_main(&threads[0]);
+    for (int t = 1; t < num_threads; t++)
+        if (threads[t].started)
+            pthread_join(threads[t].handle, NULL);
+    if (use_monitor) {
+        pthread_mutex_lock(&mon.lock);
+        mon.finished = 1;
+        pthread_cond_signal(&mon.wake);
+        pthread_mutex_unlock(&mon.lock);
+        pthread_join(monitor, NULL);
+    }
+    pthread_cond_destroy(&mon.wake);
+    s->position = search_position(s, tasks);
+    // The deadline can pass between the last task finishing and the monitor being told: a search
+    // that covered its whole range did not time out
+    if (s->position == s->rank_hi)
+        s->timed_out = 0;
+
+    // Step 4: Most leaves wins, ties go to the earliest task (the same tree a serial search keeps)
+    SearchTask *best = NULL;
+    for (int i = 0; i < tasks->count; i++) {
+        if (tasks->items[i].best_leaves > (best ? best->best_leaves : -1))
+            best = &tasks->items[i];
+    }
+    if (best) {
+        s->best_leaves = best->best_leaves;
+        memcpy(s->best_idx, best->best_idx, s->k * sizeof(int));
+    }
+    // The incumbent from a checkpoint covers ranks already searched: it wins ties with a lower rank
+    if (s->seed_leaves >= 0 &&
+        (s->seed_leaves > s->best_leaves ||
+         (s->seed_leaves == s->best_leaves && s->seed_rank < combination_rank(s->best_idx, s->k, s->m)))) {
+        s->best_leaves = s->seed_leaves;
+        combination_unrank(s->seed_rank, s->k, s->m, s->best_idx);
+    }
+
+    if (s->checkpoint_path)
+        checkpoint_now(s, tasks); // Final checkpoint: complete, or where the time limit stopped us
+
+    stats->nodes = 0;
+    stats->pruned = 0;
+    stats->symmetric = 0;
+    stats->edges_tried = 0;
+    stats->cycles = 0;
+    stats->trees = s->seed_trees;
+    for (int t = 0; t < num_threads; t++) {
+        stats->nodes += threads[t].worker.nodes;
+        stats->pruned += threads[t].worker.pruned;
+        stats->symmetric += threads[t].worker.symmetric;
+        stats->trees += threads[t].worker.trees;
+        stats->edges_tried += threads[t].worker.edges_tried;
+        stats->cycles += threads[t].worker.cycles;
+        pthread_mutex_destroy(&deques[t].lock);
+    }
+    return MLST_OK;
+}
+
+void mlst_shard_range(unsigned long long total, int i, int num_shards, unsigned long long *lo, unsigned long long *hi) {
+    unsigned long long q = total / num_shards, r = total % num_shards;
+    *lo = q * i + ((unsigned long long)i < r ? (unsigned long long)i : r);
+    *hi = *lo + q + ((unsigned long long)i < r ? 1 : 0);
+}
+
+void exact_context_free(ExactContext *c) {
+    if (!c)
+        return;
+    pthread_mutex_destroy(&c->shared.snapshot_lock);
+    free(c->tasks.items);
+    free(c->threads);
+    free(c->deques);
+    free(c->deque_items);
+    free(c);
+}
+
+// The solver's exact search context, created on first use
+static ExactContext *exact_context(MlstSolver *s) {
+    if (!s->exact) {
+        s->exact = calloc(1, sizeof(ExactContext));
+        if (s->exact)
+            pthread_mutex_init(&s->exact->shared.snapshot_lock, NULL);
+    }
+    return s->exact;
+}
+
+void mlst_exact_options_init(MlstExactOptions *opt) {
+    memset(opt, 0, sizeof(*opt));
+    opt->method = MLST_EXACT_BNB;
+    opt->threads = 1;
+    opt->checkpoint_interval = 60;
+    opt->shard = -1;
+}
+
+// Branch and bound with the options' rank range, checkpoint and time limit
+static int solve_bnb(ExactContext *c, const MlstGraph *g, uint64_t pinned, const MlstExactOptions *opt,
+                     Edge *tree, MlstResult *r) {
+    SearchShared *s = &c->shared;
+    int n = g->n, m = g->m;
+    STAT_TIMER(t);
+    bnb_init(s, g->edges, m, n, pinned);
+    symmetry_init(&c->sym, g->edges, m, n, pinned);
+    s->sym = &c->sym;
+    s->opt = opt;
+    s->stats = &r->stats;
+    // Stop as soon as a tree reaches the best upper bound, not only the star
+    if (r->bounds.upper < s->optimum)
+        s->optimum = r->bounds.upper;
+    int rank_needed = opt->num_shards > 0 || opt->checkpoint_path || opt->resume;
+    if (rank_needed && !s->ranked)
+        return MLST_ERROR_NOT_RANKABLE;
+    if (opt->resume) {
+        // Pick up where the checkpointed run stopped (including its shard, if any)
+        const MlstCheckpoint *ck = opt->resume;
+        if (ck->fingerprint != graph_fingerprint(g->edges, m, n) || ck->n != n || ck->m != m)
+            return MLST_ERROR_IO;
+        s->range_lo = ck->range_lo;
+        s->rank_hi = ck->range_hi;
+        s->shard = opt->num_shards > 0 ? opt->shard : ck->shard;
+        s->num_shards = opt->num_shards > 0 ? opt->num_shards : ck->num_shards;
+        bnb_resume(s, ck->position, ck->best_leaves, ck->best_rank, ck->trees);
+    } else if (opt->num_shards > 0) {
+        mlst_shard_range(s->rank_hi, opt->shard, opt->num_shards, &s->rank_lo, &s->rank_hi);
+        s->range_lo = s->rank_lo;
+        s->shard = opt->shard;
+        s->num_shards = opt->num_shards;
+    }
+    s->time_limit = opt->time_limit;
+    s->checkpoint_path = opt->checkpoint_path;
+    s->checkpoint_interval = opt->checkpoint_interval > 0 ? opt->checkpoint_interval : 60;
+
+    r->exact.bound = s->optimum;
+    r->exact.rank_lo = s->range_lo;
+    r->exact.rank_hi = s->rank_hi;
+    r->exact.twin_swaps = c->sym.count;
+    // A node without edges means there is no spanning tree at all
+    for (int v = 0; v < n && n > 1; v++) {
+        if (s->last_edge[v] < 0) {
+            r->leaves = -1;
+            return MLST_OK;
+        }
+    }
+
+    SearchStats stats = {0};
+    STAT_LAP(&r->stats, MLST_PHASE_SETUP, t);
+    s->started = mlst_seconds();
+    int status = parallel_branch_and_bound(c, opt->threads, &stats);
+    if (status != MLST_OK)
+        return status;
+    STAT_LAP(&r->stats, MLST_PHASE_SEARCH, t);
+    r->stats.edges_tried = stats.edges_tried;
+    r->stats.cycles = stats.cycles;
+    r->exact.nodes = stats.nodes;
+    r->exact.pruned = stats.pruned;
+    r->exact.symmetric = stats.symmetric;
+    r->exact.trees = stats.trees;
+    r->exact.timed_out = s->timed_out;
+    r->exact.position = s->position;
+    r->leaves = s->best_leaves;
+    if (s->best_leaves >= 0) {
+        r->tree_edges = s->k;
+        if (s->ranked)
+            r->exact.best_rank = combination_rank(s->best_idx, s->k, m);
+        for (int i = 0; tree && i < s->k; i++)
+            tree[i] = g->edges[s->best_idx[i]];
+    }
+    r->optimal = s->best_leaves >= 0 && !s->timed_out && s->num_shards <= 0;
+    return MLST_OK;
+}
+
+int mlst_solve_exact(MlstSolver *solver, const MlstGraph *g, const MlstExactOptions *opt, Edge *tree, MlstResult *r) {
+    MlstExactOptions defaults;
+    if (!opt) {
+        mlst_exact_options_init(&defaults);
+        opt = &defaults;
+    }
+    if (!solver || !g || !r || g->n < 1 || opt->threads < 1 ||
+        (opt->num_shards > 0 && (opt->shard < 0 || opt->shard >= opt->num_shards)))
+        return MLST_ERROR_ARGUMENT;
+    // Ranks, shards and checkpoints belong to the edge combinations, which the dominating set search does not walk
+    if (opt->method == MLST_EXACT_CDS && (opt->num_shards > 0 || opt->checkpoint_path || opt->resume))
+        return MLST_ERROR_ARGUMENT;
+    // Ranks, shards and checkpoints number the combinations of the whole graph, not of its blocks
+    if (opt->kernelize && (opt->num_shards > 0 || opt->checkpoint_path || opt->resume))
+        return MLST_ERROR_ARGUMENT;
+    int status;
+    // A shard or a checkpointed run is only part of a search: there is no answer to look up or store
+    if (opt->cache && opt->num_shards <= 0 && !opt->checkpoint_path && !opt->resume)
+        status = cache_solve_exact(solver, g, opt, tree, r);
+    else if (opt->kernelize)
+        status = kernel_solve_exact(solver, g, opt, tree, r);
+    else
+        status = exact_solve(solver, g, 0, opt, tree, r);
+    // A proven optimum is the tightest upper bound there is (a cache hit reports it the same way)
+    if (status == MLST_OK && r->optimal)
+        r->bounds.upper = r->leaves;
+    return status;
+}
+
+int exact_solve(MlstSolver *solver, const MlstGraph *g, uint64_t pinned, const MlstExactOptions *opt,
+                Edge *tree, MlstResult *r) {
+    // The dominating set search works on node sets only, so it has no edge limit
+    if (g->n > MAX_NODES || (g->m > MAX_EDGES && opt->method != MLST_EXACT_CDS))
+        return MLST_ERROR_TOO_LARGE;
+    memset(r, 0, sizeof(*r));
+    r->stats.enabled = STATS_ENABLED;
+    STAT_TIMER(t);
+    int scratch[3 * MAX_NODES];
+    graph_bounds(g, pinned, scratch, &r->bounds);
+    r->exact.bound = r->bounds.upper;
+    STAT_LAP(&r->stats, MLST_PHASE_BOUNDS, t);
+    if (opt->method == MLST_EXACT_CDS)
+        return cds_solve(g, pinned, opt, tree, r);
+    ExactContext *c = exact_context(solver);
+    if (!c)
+        return MLST_ERROR_NO_MEMORY;
+    init_binomials();
+    int n = g->n, m = g->m, k = n - 1;
+
+    if (opt->method == MLST_EXACT_BNB)
+        return solve_bnb(c, g, pinned, opt, tree, r);
+
+    if (opt->method == MLST_EXACT_GRAY) {
+        GraySearch *gs = &c->gray;
+        gs->edges = g->edges;
+        gs->k = k;
+        gs->n = n;
+        gs->pinned = pinned;
+        gs->opt = opt;
+        gs->bound = r->bounds.upper;
+        gs->stats = &r->stats;
+        gs->started = mlst_seconds();
+        revolving_door_search(gs, m);
+        STAT_LAP(&r->stats, MLST_PHASE_SEARCH, t);
+        r->exact.combinations = gs->combinations;
+        r->exact.checks = gs->checks;
+        r->exact.trees = gs->trees;
+        r->leaves = gs->best_leaves;
+        for (int i = 0; gs->best_leaves >= 0 && i < k; i++) {
+            if (tree)
+                tree[i] = g->edges[gs->best_idx[i]];
+        }
+        if (gs->best_leaves >= 0 && binom[m][k] != ULLONG_MAX)
+            r->exact.best_rank = combination_rank(gs->best_idx, k, m);
+    } else {
+        // Try all possible combinations of n-1 edges
+        Enumeration *e = &c->enumeration;
+        e->edges = g->edges;
+        e->m = m;
+        e->k = k;
+        e->n = n;
+        e->pinned = pinned;
+        e->opt = opt;
+        e->trees = 0;
+        e->combinations = 0;
+        e->bound = r->bounds.upper;
+        e->best_leaves = -1;
+        if (opt->symmetry)
+            symmetry_init(&c->sym, g->edges, m, n, pinned);
+        else
+            symmetry_clear(&c->sym, m);
+        e->sym = &c->sym;
+        e->chosen[0] = e->chosen[1] = 0;
+        e->stats = &r->stats;
+        r->exact.twin_swaps = c->sym.count;
+        tree_init(&e->tree, n, pinned);
+        SymmetryState st = {0};
+        STAT_LAP(&r->stats, MLST_PHASE_SETUP, t);
+        e->started = mlst_seconds();
+        generate_combinations(e, 0, 0, &st);
+        STAT_LAP(&r->stats, MLST_PHASE_SEARCH, t);
+        r->exact.trees = e->trees;
+        r->exact.combinations = (long long)(e->combinations < (unsigned long long)LLONG_MAX ? e->combinations : LLONG_MAX);
+        r->leaves = e->best_leaves;
+        if (tree && e->best_leaves >= 0)
+            memcpy(tree, e->best_tree, k * sizeof(Edge));
+    }
+    r->tree_edges = r->leaves >= 0 ? k : 0;
+    r->optimal = r->leaves >= 0;
+    return MLST_OK;
+}
+
+int mlst_write_shard_result(const char *path, const MlstShardResult *r, const Edge *tree) {
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+    fprintf(f, "mlst-shard 1\n");
+    fprintf(f, "fingerprint %llx\n", r->fingerprint);
+    fprintf(f, "graph %d %d\n", r->n, r->m);
+    fprintf(f, "shard %d %d\n", r->shard, r->num_shards);
+    fprintf(f, "range %llu %llu\n", r->rank_lo, r->rank_hi);
+    fprintf(f, "trees %lld\n", r->trees);
+    fprintf(f, "leaves %d\n", r->best_leaves);
+    fprintf(f, "rank %llu\n", r->best_rank);
+    fprintf(f, "tree");
+    // Loop to list the edges of the shard's best tree
+    for (int i = 0; r->best_leaves >= 0 && i < r->n - 1; i++)
+        fprintf(f, " %d-%d", tree[i].u, tree[i].v);
+    fprintf(f, "\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int mlst_read_shard_result(const char *path, MlstShardResult *r) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return -1;
+    int version = 0;
+    int ok = fscanf(f, "mlst-shard %d fingerprint %llx graph %d %d shard %d %d range %llu %llu "
+                       "trees %lld leaves %d rank %llu",
+                    &version, &r->fingerprint, &r->n, &r->m, &r->shard, &r->num_shards,
+                    &r->rank_lo, &r->rank_hi, &r->trees, &r->best_leaves, &r->best_rank) == 11;
+    fclose(f);
+    return (ok && version == 1) ? 0 : -1;
+}
+
+int mlst_merge_shards(char **paths, int count, const MlstGraph *g, Edge *tree, int *leaves, long long *trees) {
+    int n = g->n, m = g->m;
+    unsigned long long fingerprint = graph_fingerprint(g->edges, m, n);
+    int num_shards = -1;
+    int *seen = NULL;
+    int best_leaves = -1;
+    unsigned long long best_rank = 0;
+    *trees = 0;
+    *leaves = -1;
+    if (n < 1 || n > MAX_NODES || m > MAX_EDGES) {
+        fprintf(stderr, "Shard results can only be merged for graphs of 1 to %d nodes and at most %d edges\n",
+                MAX_NODES, MAX_EDGES);
+        return 1;
+    }
+
+    // Loop through the shard files, checking they all belong to the same sharded search
+    for (int i = 0; i < count; i++) {
+        MlstShardResult r;
+        if (mlst_read_shard_result(paths[i], &r) != 0) {
+            fprintf(stderr, "Cannot read shard result %s\n", paths[i]);
+            free(seen);
+            return 1;
+        }
+        if (r.fingerprint != fingerprint || r.n != n || r.m != m) {
+            fprintf(stderr, "Shard result %s was computed on a different graph\n", paths[i]);
+            free(seen);
+            return 1;
+        }
+        if (num_shards < 0) {
+            num_shards = r.num_shards;
+            seen = calloc(num_shards > 0 ? num_shards : 1, sizeof(int));
+            if (!seen) {
+                fprintf(stderr, "Out of memory\n");
+                return 1;
+            }
+        }
+        if (r.num_shards != num_shards || r.shard < 0 || r.shard >= num_shards) {
+            fprintf(stderr, "Shard result %s does not belong to a %d-way split\n", paths[i], num_shards);
+            free(seen);
+            return 1;
+        }
+        if (seen[r.shard]++)
+            continue; // Same shard listed twice: count it once
+        *trees += r.trees;
+        if (r.best_leaves > best_leaves || (r.best_leaves == best_leaves && r.best_rank < best_rank)) {
+            best_leaves = r.best_leaves;
+            best_rank = r.best_rank;
+        }
+    }
+
+    int missing = 0;
+    // Loop to list the shards that still have to be (re-)run
+    for (int i = 0; i < num_shards; i++) {
+        if (!seen[i]) {
+            if (!missing++)
+                fprintf(stderr, "Missing shard results:");
+            fprintf(stderr, " %d/%d", i, num_shards);
+        }
+    }
+    if (missing)
+        fprintf(stderr, "\n");
+    free(seen);
+    if (missing || num_shards < 0)
+        return 1;
+
+    if (best_leaves >= 0) {
+        int idx[MAX_NODES];
+        init_binomials();
+        combination_unrank(best_rank, n - 1, m, idx);
+        *leaves = best_leaves;
+        for (int i = 0; i < n - 1; i++)
+            tree[i] = g->edges[idx[i]];
+    }
+    return 0;
+}
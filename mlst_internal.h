@@ -0,0 +1,126 @@
+/*
+Definitions shared by the library sources (not part of the public API in mlst.h)
+*/
+
+#ifndef MLST_INTERNAL_H
+#define MLST_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mlst.h"
+
+struct MlstGraph {
+    int n, m;
+    int capacity;               // edges the buffer can hold
+    Edge *edges;
+};
+
+// Scratch state of each solver, created on first use and freed with the solver
+typedef struct ApproxContext ApproxContext;
+typedef struct ExactContext ExactContext;
+typedef struct KernelContext KernelContext;
+typedef struct CacheContext CacheContext;
+
+struct MlstSolver {
+    ApproxContext *approx;
+    ExactContext *exact;
+    KernelContext *kernel;
+    CacheContext *cache;
+};
+
+void approx_context_free(ApproxContext *c);
+void exact_context_free(ExactContext *c);
+void kernel_context_free(KernelContext *c);
+void cache_context_free(CacheContext *c);
+
+// The solvers without the kernelization step (mlst_exact.c, mlst_approx.c)
+// Nodes in pinned (a bit per node) are never leaves: the kernelization pins the cut vertices of a block
+int exact_solve(MlstSolver *s, const MlstGraph *g, uint64_t pinned, const MlstExactOptions *opt,
+                Edge *tree, MlstResult *r);
+int approx_solve(MlstSolver *s, const MlstGraph *g, const MlstApproxOptions *opt, Edge *tree, MlstResult *r);
+
+// Upper bounds on the leaves (mlst_bound.c), the pinned nodes counting as never leaves; scratch holds 3n ints
+void graph_bounds(const MlstGraph *g, uint64_t pinned, int *scratch, MlstBounds *b);
+
+// Minimum connected dominating set search (mlst_cds.c), called by exact_solve for MLST_EXACT_CDS
+int cds_solve(const MlstGraph *g, uint64_t pinned, const MlstExactOptions *opt, Edge *tree, MlstResult *r);
+
+// Kernelized solves (mlst_kernel.c): reduce g, solve the pieces with the calls above, lift the tree
+int kernel_solve_exact(MlstSolver *s, const MlstGraph *g, const MlstExactOptions *opt, Edge *tree, MlstResult *r);
+int kernel_solve_approx(MlstSolver *s, const MlstGraph *g, const MlstApproxOptions *opt, Edge *tree, MlstResult *r);
+
+// If the last approximation on s was a kernelized solve of g, the reduced graph and tree it built; else NULL
+const MlstGraph *kernel_reduced_approx(MlstSolver *s, const MlstGraph *g, const Edge **tree, int *tree_edges);
+
+// Forget the reduced graph of the last kernelized approximation (a plain solve replaced it)
+void kernel_forget(MlstSolver *s);
+
+// Forget the last approximation altogether (a cache hit replaced it): mlst_verify_approx has nothing to check
+void approx_forget(MlstSolver *s);
+
+// Solves through the options' cache (mlst_cache.c): look g up, else solve it without the cache and store the result
+int cache_solve_exact(MlstSolver *s, const MlstGraph *g, const MlstExactOptions *opt, Edge *tree, MlstResult *r);
+int cache_solve_approx(MlstSolver *s, const MlstGraph *g, const MlstApproxOptions *opt, Edge *tree, MlstResult *r);
+
+// Instrumentation (MlstStats in mlst.h): every STAT_ macro compiles to nothing unless MLST_STATS is defined
+#ifdef MLST_STATS
+#define STATS_ENABLED 1
+#define STAT_INC(x) ((x)++)
+#define STAT_ADD(x, v) ((x) += (v))
+#define STAT_MAX(x, v) do { if ((v) > (x)) (x) = (v); } while (0)
+// Start a phase timer t, then add the time since t to phase p of stats and restart t
+#define STAT_TIMER(t) double t = mlst_seconds()
+#define STAT_LAP(stats, p, t) do { double now_ = mlst_seconds(); (stats)->phase[p] += now_ - (t); (t) = now_; } while (0)
+#define STAT_RESTART(t) ((t) = mlst_seconds())
+#define STAT_IMPROVE(stats, t, leaves) stats_improvement(stats, mlst_seconds() - (t), leaves)
+#else
+#define STATS_ENABLED 0
+#define STAT_INC(x) ((void)0)
+#define STAT_ADD(x, v) ((void)0)
+#define STAT_MAX(x, v) ((void)0)
+#define STAT_TIMER(t) ((void)0)
+#define STAT_LAP(stats, p, t) ((void)0)
+#define STAT_RESTART(t) ((void)0)
+#define STAT_IMPROVE(stats, t, leaves) ((void)0)
+#endif
+
+// Record a new best tree found seconds into the search (mlst_stats.c)
+void stats_improvement(MlstStats *s, double seconds, int leaves);
+
+// Add the counters and phase times of b to a (not the improvements: they belong to one search)
+void stats_add(MlstStats *a, const MlstStats *b);
+
+// Region allocator: memory is handed out by bumping an offset and given back all at once by
+// arena_reset, so a solve's scratch arrays cost no malloc/free pairs once the arena is warm
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock *block;          // block being carved (earlier blocks hang off its prev link)
+} Arena;
+
+// size bytes aligned for any type, valid until the next reset; NULL if out of memory
+void *arena_alloc(Arena *a, size_t size);
+
+// Give back everything allocated; if the last round needed several blocks they are replaced by
+// one block of their combined size, so the next round of the same size fits without allocating
+void arena_reset(Arena *a);
+
+void arena_free(Arena *a);
+
+// Grow *p to hold count items of size bytes each (if *capacity is smaller); 0 on success, -1 if out of memory
+int mlst_reserve(void **p, int *capacity, size_t count, size_t size);
+
+// Canonical labelling (mlst_canon.c), the key of the result cache: isomorphic graphs get the same labelled edge list
+typedef struct {
+    int *lab;                   // lab[i] is the node of g with label i
+    int *label;                 // label[v] is the label of node v
+    Edge *edges;                // g's edges under the labelling (u < v), sorted
+    uint64_t key;               // hash of the node count and the labelled edges (never 0)
+    int canonical;              // 0 if the search ran out of budget: only this edge order gets this labelling
+} CanonForm;
+
+// Label g; the arrays of f are carved from a
+int canon_form(Arena *a, const MlstGraph *g, CanonForm *f);
+
+#endif
@@ -0,0 +1,614 @@
+/*
+Kernelization of libmlst: shrinks a graph before the solvers see it and lifts their trees back
+
+- Blocks: the graph is split at its cut vertices into biconnected blocks (iterative Tarjan over
+  the edges). A spanning tree is exactly one spanning tree per block, and a cut vertex has an edge
+  in at least two blocks, so it is never a leaf. The exact search solves each block with its cut
+  vertices pinned as internal, and the leaf counts add up. A block with one edge is a bridge
+  (pendant edges included) and is taken as it is.
+- Chains: a path of degree-2 nodes x1 .. xk between two other nodes u and w can miss at most one
+  of its edges in a spanning tree. Missing an inner edge is never worse than missing an end edge
+  (move the gap inward: the old end stays a leaf, one more chain node becomes a leaf, and at most
+  u or w stops being one), and all inner gaps give the same two chain leaves. So a chain with
+  k >= 3 keeps only x1 and xk, joined by one edge that stands for the inner edges: if the tree uses
+  it every chain edge is taken, otherwise every chain edge but x1-x2 is. Either way the lifted
+  tree has the same leaves as the reduced one.
+
+Every array lives in the solver's KernelContext arena and is reset by the next kernelized solve.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "mlst_internal.h"
+
+// The kernelization's share of a solver context
+struct KernelContext {
+    Arena arena;
+    // The last kernelized approximation, kept for mlst_verify_approx
+    const MlstGraph *source;   // NULL if the last approximation was not kernelized
+    int source_n, source_m;
+    MlstGraph reduced;
+    Edge *reduced_tree;
+    int reduced_tree_edges;
+};
+
+// A piece of the graph handed to a solver: a block (exact search) or the whole graph (approximation)
+// after its chains were shortened, with what is needed to lift its tree back
+typedef struct {
+    int n, m;
+    Edge *edges;               // in piece node ids
+    int *node;                 // piece node -> graph node
+    uint64_t pinned;           // piece nodes that are cut vertices (exact search only; set when n <= 64)
+    int chains;
+    int *chain_start;          // chain c is chain_nodes[chain_start[c]] .. chain_nodes[chain_start[c + 1] - 1]
+    int *chain_nodes;          // graph nodes x1 .. xk of every shortened chain
+    int *chain_of;             // piece node -> chain whose end it is (-1 if none)
+    int contracted;            // nodes removed by shortening chains
+} Piece;
+
+void kernel_context_free(KernelContext *c) {
+    if (!c)
+        return;
+    arena_free(&c->arena);
+    free(c);
+}
+
+void kernel_forget(MlstSolver *s) {
+    if (s->kernel)
+        s->kernel->source = NULL;
+}
+
+const MlstGraph *kernel_reduced_approx(MlstSolver *s, const MlstGraph *g, const Edge **tree, int *tree_edges) {
+    KernelContext *c = s->kernel;
+    if (!c || !c->source || c->source != g || c->source_n != g->n || c->source_m != g->m)
+        return NULL;
+    *tree = c->reduced_tree;
+    *tree_edges = c->reduced_tree_edges;
+    return &c->reduced;
+}
+
+// The solver's kernelization context (created on first use) with its arena emptied
+static KernelContext *kernel_context(MlstSolver *s) {
+    if (!s->kernel)
+        s->kernel = calloc(1, sizeof(KernelContext));
+    if (s->kernel) {
+        s->kernel->source = NULL;
+        arena_reset(&s->kernel->arena);
+    }
+    return s->kernel;
+}
+
+// count items of size bytes from the arena (NULL if out of memory)
+static void *kernel_alloc(Arena *a, size_t count, size_t size) {
+    return arena_alloc(a, count * size);
+}
+
+/**
+ * Shortens the degree-2 chains of a graph with n nodes and m edges (no self-loops) into p.
+ * A node is a chain node if it has degree 2 and is not pinned; if a cycle consists of chain nodes
+ * only, its lowest node is taken as the chain's end point.
+ * Time: O(n + m)
+ *
+ * @param a       Arena for the arrays of p.
+ * @param node    Graph node of each of the n nodes (lifted trees use graph nodes).
+ * @param pinned  pinned[v] is 1 if node v is a cut vertex (NULL = none); pinned nodes are never
+ *                contracted, whatever the size of the graph.
+ * @return MLST_OK or MLST_ERROR_NO_MEMORY.
+ */
+static int shorten_chains(Arena *a, int n, const Edge *edges, int m, const int *node, const unsigned char *pinned,
+                          Piece *p) {
+    int *offset = kernel_alloc(a, (size_t)n + 1, sizeof(int));
+    int *incident = kernel_alloc(a, 2 * (size_t)m, sizeof(int));   // edge ids around each node
+    int *next = kernel_alloc(a, (size_t)n, sizeof(int));
+    unsigned char *chain = kernel_alloc(a, (size_t)n, 1);            // node is an inner chain node
+    unsigned char *seen = kernel_alloc(a, (size_t)n, 1);
+    unsigned char *edge_seen = kernel_alloc(a, (size_t)m, 1);
+    int *edge_role = kernel_alloc(a, (size_t)m, sizeof(int));       // -1 kept, -2 dropped, c >= 0: stands for chain c
+    int *keep = kernel_alloc(a, (size_t)n, sizeof(int));             // new id of each kept node (-1 if dropped)
+    p->chain_start = kernel_alloc(a, (size_t)n + 1, sizeof(int));
+    p->chain_nodes = kernel_alloc(a, (size_t)n, sizeof(int));
+    int *chain_first = kernel_alloc(a, (size_t)n, sizeof(int));      // local ids of x1 and xk of each chain
+    int *chain_last = kernel_alloc(a, (size_t)n, sizeof(int));
+    int *path = kernel_alloc(a, (size_t)n, sizeof(int));
+    if (!offset || !incident || !next || !chain || !seen || !edge_seen || !edge_role || !keep ||
+        !p->chain_start || !p->chain_nodes || !chain_first || !chain_last || !path)
+        return MLST_ERROR_NO_MEMORY;
+
+    // Step 1: Incident edges of every node (CSR)
+    memset(offset, 0, ((size_t)n + 1) * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        offset[edges[i].u + 1]++;
+        offset[edges[i].v + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+        offset[v + 1] += offset[v];
+    memcpy(next, offset, (size_t)n * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        incident[next[edges[i].u]++] = i;
+        incident[next[edges[i].v]++] = i;
+    }
+    for (int v = 0; v < n; v++) {
+        chain[v] = offset[v + 1] - offset[v] == 2 && !(pinned && pinned[v]);
+        seen[v] = 0;
+        keep[v] = 0;
+    }
+    for (int i = 0; i < m; i++) {
+        edge_seen[i] = 0;
+        edge_role[i] = -1;
+    }
+
+    // Step 2: Walk from every end point along each of its edges into a chain
+    // (a second round turns the lowest node of each cycle made only of chain nodes into an end point)
+    int chains = 0, stored = 0;
+    p->chain_start[0] = 0;
+    for (int round = 0; round < 2; round++) {
+        for (int u = 0; u < n; u++) {
+            if (chain[u]) {
+                if (round == 0 || seen[u])
+                    continue;
+                chain[u] = 0;
+            }
+            for (int j = offset[u]; j < offset[u + 1]; j++) {
+                int e = incident[j];
+                int x = edges[e].u == u ? edges[e].v : edges[e].u;
+                if (edge_seen[e] || !chain[x] || seen[x])
+                    continue;
+                // Follow the chain until a node that is not an inner chain node
+                int k = 0, prev = e, inner_first = -1;
+                edge_seen[e] = 1;
+                while (chain[x] && !seen[x]) {
+                    seen[x] = 1;
+                    path[k++] = x;
+                    int f = incident[offset[x]] == prev ? incident[offset[x] + 1] : incident[offset[x]];
+                    if (k == 2)
+                        inner_first = prev;
+                    if (k >= 2)
+                        edge_role[prev] = -2;
+                    edge_seen[f] = 1;
+                    prev = f;
+                    x = edges[f].u == x ? edges[f].v : edges[f].u;
+                }
+                if (k < 3) {
+                    // Too short to shorten: put its inner edge back
+                    if (inner_first >= 0)
+                        edge_role[inner_first] = -1;
+                    continue;
+                }
+                // Keep x1 and xk; x1-x2 stands for the inner edges x1-x2 .. x(k-1)-xk
+                edge_role[inner_first] = chains;
+                for (int t = 1; t < k - 1; t++)
+                    keep[path[t]] = -1;
+                chain_first[chains] = path[0];
+                chain_last[chains] = path[k - 1];
+                for (int t = 0; t < k; t++)
+                    p->chain_nodes[stored++] = node[path[t]];
+                p->chain_start[++chains] = stored;
+            }
+        }
+    }
+
+    // Step 3: Renumber the kept nodes and write the shorter edge list
+    p->n = 0;
+    p->node = kernel_alloc(a, (size_t)n, sizeof(int));
+    p->chain_of = kernel_alloc(a, (size_t)n, sizeof(int));
+    p->edges = kernel_alloc(a, (size_t)m, sizeof(Edge));
+    if (!p->node || !p->chain_of || !p->edges)
+        return MLST_ERROR_NO_MEMORY;
+    // The pinned mask only covers pieces the exact search accepts (at most 64 nodes)
+    p->pinned = 0;
+    for (int v = 0; v < n; v++) {
+        if (keep[v] < 0)
+            continue;
+        if (pinned && pinned[v] && p->n < 64)
+            p->pinned |= (uint64_t)1 << p->n;
+        keep[v] = p->n;
+        p->chain_of[p->n] = -1;
+        p->node[p->n++] = node[v];
+    }
+    for (int c = 0; c < chains; c++) {
+        p->chain_of[keep[chain_first[c]]] = c;
+        p->chain_of[keep[chain_last[c]]] = c;
+    }
+    p->m = 0;
+    for (int i = 0; i < m; i++) {
+        if (edge_role[i] == -2)
+            continue;
+        Edge e = edges[i];
+        if (edge_role[i] >= 0) {
+            e.u = chain_first[edge_role[i]];
+            e.v = chain_last[edge_role[i]];
+        }
+        p->edges[p->m].u = keep[e.u];
+        p->edges[p->m].v = keep[e.v];
+        p->m++;
+    }
+    p->chains = chains;
+    p->contracted = n - p->n;
+    return MLST_OK;
+}
+
+// Writes the graph edges of the piece tree (k edges in piece node ids) to out; returns how many
+// Time: O(k + chain nodes)
+static int lift_tree(Arena *a, const Piece *p, const Edge *tree, int k, Edge *out) {
+    unsigned char *used = kernel_alloc(a, (size_t)p->chains + 1, 1);
+    if (!used)
+        return -1;
+    memset(used, 0, (size_t)p->chains + 1);
+    int count = 0;
+    for (int i = 0; i < k; i++) {
+        int cu = p->chain_of[tree[i].u], cv = p->chain_of[tree[i].v];
+        if (cu >= 0 && cu == cv) {
+            used[cu] = 1; // The edge between the two ends of a chain is the one standing for it
+            continue;
+        }
+        out[count].u = p->node[tree[i].u];
+        out[count].v = p->node[tree[i].v];
+        count++;
+    }
+    // Loop over the chains: all inner edges if the tree used the chain's edge, else all but x1-x2
+    for (int c = 0; c < p->chains; c++) {
+        for (int t = p->chain_start[c] + (used[c] ? 0 : 1); t + 1 < p->chain_start[c + 1]; t++) {
+            out[count].u = p->chain_nodes[t];
+            out[count].v = p->chain_nodes[t + 1];
+            count++;
+        }
+    }
+    return count;
+}
+
+int kernel_solve_approx(MlstSolver *s, const MlstGraph *g, const MlstApproxOptions *opt, Edge *tree, MlstResult *r) {
+    KernelContext *c = kernel_context(s);
+    if (!c)
+        return MLST_ERROR_NO_MEMORY;
+    Arena *a = &c->arena;
+    int n = g->n, m = 0;
+
+    // Self-loops are never in a tree: leave them out before counting degrees
+    Edge *edges = kernel_alloc(a, (size_t)g->m, sizeof(Edge));
+    int *node = kernel_alloc(a, (size_t)n, sizeof(int));
+    if (!edges || !node)
+        return MLST_ERROR_NO_MEMORY;
+    for (int i = 0; i < g->m; i++)
+        if (g->edges[i].u != g->edges[i].v)
+            edges[m++] = g->edges[i];
+    for (int v = 0; v < n; v++)
+        node[v] = v;
+
+    Piece p;
+    int status = shorten_chains(a, n, edges, m, node, NULL, &p);
+    if (status != MLST_OK)
+        return status;
+    c->reduced.n = p.n;
+    c->reduced.m = p.m;
+    c->reduced.capacity = p.m;
+    c->reduced.edges = p.edges;
+    c->reduced_tree = kernel_alloc(a, (size_t)p.n, sizeof(Edge));
+    Edge *lifted = kernel_alloc(a, (size_t)n, sizeof(Edge));
+    if (!c->reduced_tree || !lifted)
+        return MLST_ERROR_NO_MEMORY;
+
+    MlstApproxOptions plain = *opt;
+    plain.kernelize = 0;
+    status = approx_solve(s, &c->reduced, &plain, c->reduced_tree, r);
+    if (status != MLST_OK)
+        return status;
+    c->reduced_tree_edges = r->tree_edges;
+    int count = lift_tree(a, &p, c->reduced_tree, r->tree_edges, lifted);
+    if (count < 0)
+        return MLST_ERROR_NO_MEMORY;
+    if (tree)
+        memcpy(tree, lifted, (size_t)count * sizeof(Edge));
+    r->tree_edges = count;
+    r->kernel.blocks = 1;
+    r->kernel.contracted = p.contracted;
+    r->kernel.max_nodes = p.n;
+    r->kernel.max_edges = p.m;
+    c->source = g;
+    c->source_n = g->n;
+    c->source_m = g->m;
+    return MLST_OK;
+}
+
+// Biconnected blocks of a graph, found by an iterative Tarjan search over the edges
+typedef struct {
+    int count;                 // blocks found
+    int *block_of;             // edge -> block (-1 for self-loops)
+    int *blocks_at;            // node -> number of blocks it has edges in (>= 2 for a cut vertex)
+    int reached;               // nodes reached from node 0
+} Blocks;
+
+/**
+ * Labels every edge with its biconnected block (parallel edges share the block of their ends).
+ * Only the part of the graph reachable from node 0 is searched.
+ * Time: O(n + m)
+ */
+static int find_blocks(Arena *a, int n, const Edge *edges, int m, Blocks *b) {
+    int *offset = kernel_alloc(a, (size_t)n + 1, sizeof(int));
+    int *incident = kernel_alloc(a, 2 * (size_t)m, sizeof(int));
+    int *pos = kernel_alloc(a, (size_t)n, sizeof(int));          // next incident edge to look at
+    int *disc = kernel_alloc(a, (size_t)n, sizeof(int));         // discovery time (0 = not yet)
+    int *low = kernel_alloc(a, (size_t)n, sizeof(int));
+    int *via = kernel_alloc(a, (size_t)n, sizeof(int));          // tree edge the node was reached by
+    int *stack = kernel_alloc(a, (size_t)n, sizeof(int));        // DFS path
+    int *edge_stack = kernel_alloc(a, (size_t)m, sizeof(int));
+    int *stamp = kernel_alloc(a, (size_t)n, sizeof(int));
+    b->block_of = kernel_alloc(a, (size_t)m, sizeof(int));
+    b->blocks_at = kernel_alloc(a, (size_t)n, sizeof(int));
+    if (!offset || !incident || !pos || !disc || !low || !via || !stack || !edge_stack || !stamp ||
+        !b->block_of || !b->blocks_at)
+        return MLST_ERROR_NO_MEMORY;
+
+    memset(offset, 0, ((size_t)n + 1) * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        b->block_of[i] = -1;
+        if (edges[i].u == edges[i].v)
+            continue;
+        offset[edges[i].u + 1]++;
+        offset[edges[i].v + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+        offset[v + 1] += offset[v];
+    memcpy(pos, offset, (size_t)n * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        if (edges[i].u == edges[i].v)
+            continue;
+        incident[pos[edges[i].u]++] = i;
+        incident[pos[edges[i].v]++] = i;
+    }
+    for (int v = 0; v < n; v++) {
+        pos[v] = offset[v];
+        disc[v] = 0;
+        stamp[v] = -1;
+        b->blocks_at[v] = 0;
+    }
+
+    int time = 0, depth = 0, top = 0;
+    b->count = 0;
+    disc[0] = low[0] = ++time;
+    via[0] = -1;
+    stack[depth++] = 0;
+    b->reached = 1;
+    while (depth > 0) {
+        int u = stack[depth - 1];
+        if (pos[u] < offset[u + 1]) {
+            int e = incident[pos[u]++];
+            if (e == via[u])
+                continue; // The tree edge back to the parent (a parallel copy is a real back edge)
+            int x = edges[e].u == u ? edges[e].v : edges[e].u;
+            if (!disc[x]) {
+                edge_stack[top++] = e;
+                disc[x] = low[x] = ++time;
+                via[x] = e;
+                stack[depth++] = x;
+                b->reached++;
+            } else if (disc[x] < disc[u]) {
+                edge_stack[top++] = e; // Back edge up the path
+                if (disc[x] < low[u])
+                    low[u] = disc[x];
+            }
+            continue;
+        }
+        // u is finished: report to its parent, which closes a block if u cannot reach above it
+        depth--;
+        if (depth == 0)
+            break;
+        int parent = stack[depth - 1];
+        if (low[u] < low[parent])
+            low[parent] = low[u];
+        if (low[u] >= disc[parent]) {
+            int id = b->count++;
+            int e;
+            do {
+                e = edge_stack[--top];
+                b->block_of[e] = id;
+                // Count each block once per node
+                for (int t = 0; t < 2; t++) {
+                    int v = t ? edges[e].v : edges[e].u;
+                    if (stamp[v] != id) {
+                        stamp[v] = id;
+                        b->blocks_at[v]++;
+                    }
+                }
+            } while (e != via[u]);
+        }
+    }
+    return MLST_OK;
+}
+
+// First spanning tree of a piece in edge order (used when the time limit leaves no time for a block)
+// Returns its leaves (pinned nodes never count), or -1 if out of memory
+static int first_tree(Arena *a, const Piece *p, Edge *tree) {
+    int *parent = kernel_alloc(a, (size_t)p->n, sizeof(int));
+    int *degree = kernel_alloc(a, (size_t)p->n, sizeof(int));
+    if (!parent || !degree)
+        return -1;
+    for (int v = 0; v < p->n; v++) {
+        parent[v] = v;
+        degree[v] = 0;
+    }
+    int k = 0;
+    for (int i = 0; i < p->m && k < p->n - 1; i++) {
+        int ru = p->edges[i].u, rv = p->edges[i].v;
+        while (parent[ru] != ru)
+            ru = parent[ru] = parent[parent[ru]];
+        while (parent[rv] != rv)
+            rv = parent[rv] = parent[parent[rv]];
+        if (ru == rv)
+            continue;
+        parent[ru] = rv;
+        tree[k++] = p->edges[i];
+        degree[p->edges[i].u]++;
+        degree[p->edges[i].v]++;
+    }
+    int leaves = 0;
+    for (int v = 0; v < p->n; v++)
+        leaves += degree[v] == 1 && !(p->pinned >> v & 1);
+    return leaves;
+}
+
+int kernel_solve_exact(MlstSolver *s, const MlstGraph *g, const MlstExactOptions *opt, Edge *tree, MlstResult *r) {
+    int n = g->n, m = g->m;
+    if (n == 1)
+        return exact_solve(s, g, 0, opt, tree, r); // Nothing to split
+    KernelContext *c = kernel_context(s);
+    if (!c)
+        return MLST_ERROR_NO_MEMORY;
+    Arena *a = &c->arena;
+    memset(r, 0, sizeof(*r));
+    r->stats.enabled = STATS_ENABLED;
+    int *scratch = kernel_alloc(a, 3 * (size_t)n, sizeof(int));
+    if (!scratch)
+        return MLST_ERROR_NO_MEMORY;
+    STAT_TIMER(t);
+    graph_bounds(g, 0, scratch, &r->bounds);
+    STAT_LAP(&r->stats, MLST_PHASE_BOUNDS, t);
+
+    // Step 1: Blocks and cut vertices; a node the search from node 0 cannot reach means no spanning tree
+    Blocks b;
+    int status = find_blocks(a, n, g->edges, m, &b);
+    if (status != MLST_OK)
+        return status;
+    if (b.reached < n) {
+        r->leaves = -1;
+        return MLST_OK;
+    }
+    // Cut vertices are never leaves: that tightens the star bound
+    int cuts = 0;
+    for (int v = 0; v < n; v++)
+        cuts += b.blocks_at[v] >= 2;
+    if (n - cuts < r->bounds.star)
+        r->bounds.star = n - cuts;
+    if (r->bounds.star < r->bounds.upper)
+        r->bounds.upper = r->bounds.star;
+    r->exact.bound = r->bounds.upper;
+
+    // Step 2: Group the edges by block (counting sort keeps the graph's edge order inside a block)
+    int *start = kernel_alloc(a, (size_t)b.count + 1, sizeof(int));
+    int *order = kernel_alloc(a, (size_t)m, sizeof(int));
+    int *local = kernel_alloc(a, (size_t)n, sizeof(int));
+    int *stamp = kernel_alloc(a, (size_t)n, sizeof(int));
+    int *node = kernel_alloc(a, (size_t)n, sizeof(int));
+    Edge *block_edges = kernel_alloc(a, (size_t)m, sizeof(Edge));
+    Edge *piece_tree = kernel_alloc(a, (size_t)n, sizeof(Edge));
+    Edge *lifted = kernel_alloc(a, (size_t)n, sizeof(Edge));
+    unsigned char *pinned = kernel_alloc(a, (size_t)n, 1);           // block node is a cut vertex
+    if (!start || !order || !local || !stamp || !node || !block_edges || !piece_tree || !lifted || !pinned)
+        return MLST_ERROR_NO_MEMORY;
+    memset(start, 0, ((size_t)b.count + 1) * sizeof(int));
+    for (int i = 0; i < m; i++)
+        if (b.block_of[i] >= 0)
+            start[b.block_of[i] + 1]++;
+    for (int k = 0; k < b.count; k++)
+        start[k + 1] += start[k];
+    for (int i = 0; i < m; i++)
+        if (b.block_of[i] >= 0)
+            order[start[b.block_of[i]]++] = i;
+    for (int k = b.count; k > 0; k--)
+        start[k] = start[k - 1];
+    start[0] = 0;
+    for (int v = 0; v < n; v++)
+        stamp[v] = -1;
+
+    // Step 3: Solve every block with its cut vertices pinned, then lift its tree into the result
+    MlstExactOptions plain = *opt;
+    plain.kernelize = 0;
+    plain.on_tree = NULL;
+    plain.on_improve = NULL;
+    double deadline = opt->time_limit > 0 ? mlst_seconds() + opt->time_limit : 0;
+    int leaves = 0, tree_edges = 0, optimal = 1;
+    r->kernel.blocks = b.count;
+    for (int k = 0; k < b.count; k++) {
+        // Local node ids in order of first appearance
+        int bn = 0, bm = 0;
+        for (int j = start[k]; j < start[k + 1]; j++) {
+            Edge e = g->edges[order[j]];
+            for (int t = 0; t < 2; t++) {
+                int v = t ? e.v : e.u;
+                if (stamp[v] != k) {
+                    stamp[v] = k;
+                    local[v] = bn;
+                    node[bn++] = v;
+                }
+            }
+            block_edges[bm].u = local[e.u];
+            block_edges[bm].v = local[e.v];
+            bm++;
+        }
+
+        if (bn == 2) {
+            // A bridge (or parallel edges between two nodes): one edge, forced; its ends are leaves unless cut vertices
+            r->kernel.bridges += bm == 1;
+            if (r->kernel.max_nodes < 2)
+                r->kernel.max_nodes = 2;
+            if (r->kernel.max_edges < bm)
+                r->kernel.max_edges = bm;
+            leaves += (b.blocks_at[node[0]] < 2) + (b.blocks_at[node[1]] < 2);
+            lifted[tree_edges].u = node[0];
+            lifted[tree_edges].v = node[1];
+            tree_edges++;
+            continue;
+        }
+        // Cut vertices are kept out of the chains at any block size; the piece's mask is built
+        // from them once it is small enough for the exact search
+        for (int v = 0; v < bn; v++)
+            pinned[v] = b.blocks_at[node[v]] >= 2;
+        Piece p;
+        status = shorten_chains(a, bn, block_edges, bm, node, pinned, &p);
+        if (status != MLST_OK)
+            return status;
+        if (p.n > r->kernel.max_nodes)
+            r->kernel.max_nodes = p.n;
+        if (p.m > r->kernel.max_edges)
+            r->kernel.max_edges = p.m;
+        r->kernel.contracted += p.contracted;
+        if (p.n > MLST_EXACT_MAX_NODES || (p.m > MLST_EXACT_MAX_EDGES && opt->method != MLST_EXACT_CDS))
+            return MLST_ERROR_TOO_LARGE;
+
+        MlstGraph piece = {p.n, p.m, p.m, p.edges};
+        MlstResult pr;
+        int piece_leaves = -1;
+        double left = deadline > 0 ? deadline - mlst_seconds() : 0;
+        if (deadline == 0 || left > 0) {
+            plain.time_limit = deadline > 0 ? left : 0;
+            status = exact_solve(s, &piece, p.pinned, &plain, piece_tree, &pr);
+            if (status != MLST_OK)
+                return status;
+            r->exact.nodes += pr.exact.nodes;
+            r->exact.pruned += pr.exact.pruned;
+            r->exact.symmetric += pr.exact.symmetric;
+            r->exact.twin_swaps += pr.exact.twin_swaps;
+            r->exact.trees += pr.exact.trees;
+            r->exact.combinations = pr.exact.combinations > LLONG_MAX - r->exact.combinations
+                                        ? LLONG_MAX : r->exact.combinations + pr.exact.combinations;
+            r->exact.checks += pr.exact.checks;
+            stats_add(&r->stats, &pr.stats);
+            piece_leaves = pr.leaves;
+            optimal &= pr.optimal;
+            r->exact.timed_out |= pr.exact.timed_out;
+        }
+        if (piece_leaves < 0) {
+            // Out of time before this block found a tree: take any tree of it
+            piece_leaves = first_tree(a, &p, piece_tree);
+            if (piece_leaves < 0)
+                return MLST_ERROR_NO_MEMORY;
+            optimal = 0;
+            r->exact.timed_out = 1;
+        }
+        int count = lift_tree(a, &p, piece_tree, p.n - 1, lifted + tree_edges);
+        if (count < 0)
+            return MLST_ERROR_NO_MEMORY;
+        tree_edges += count;
+        leaves += piece_leaves;
+    }
+    // More leaves than the upper bound means a block's leaves were miscounted: never report that
+    if (leaves > r->bounds.upper)
+        return MLST_ERROR_INTERNAL;
+    if (tree)
+        memcpy(tree, lifted, (size_t)tree_edges * sizeof(Edge));
+    r->leaves = leaves;
+    r->tree_edges = tree_edges;
+    r->optimal = optimal;
+    return MLST_OK;
+}
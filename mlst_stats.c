@@ -0,0 +1,139 @@
+/*
+Instrumentation report of libmlst (MlstStats in mlst.h)
+
+The counters and phase timers themselves are updated inside the solvers through the STAT_ macros
+of mlst_internal.h, which compile to nothing unless MLST_STATS is defined. This file only keeps the
+clock, the list of improvements and the JSON/text writer the command-line programs share.
+*/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "mlst_internal.h"
+
+static const char *phase_names[MLST_PHASE_COUNT] = {
+    "graph", "forest", "dsu_init", "connect", "leaf_count", "local_search", "bounds", "setup", "search"};
+
+const char *mlst_phase_name(int phase) {
+    return phase >= 0 && phase < MLST_PHASE_COUNT ? phase_names[phase] : "unknown";
+}
+
+int mlst_stats_enabled(void) {
+    return STATS_ENABLED;
+}
+
+double mlst_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void stats_improvement(MlstStats *s, double seconds, int leaves) {
+    if (s->improvements < MLST_STATS_MAX_IMPROVEMENTS) {
+        s->improvement[s->improvements].seconds = seconds;
+        s->improvement[s->improvements].leaves = leaves;
+    }
+    s->improvements++;
+}
+
+void stats_add(MlstStats *a, const MlstStats *b) {
+    a->edges_tried += b->edges_tried;
+    a->cycles += b->cycles;
+    a->dsu_finds += b->dsu_finds;
+    a->dsu_steps += b->dsu_steps;
+    if (b->dsu_longest > a->dsu_longest)
+        a->dsu_longest = b->dsu_longest;
+    a->expand_considered += b->expand_considered;
+    a->expand_accepted += b->expand_accepted;
+    if (b->forest_depth > a->forest_depth)
+        a->forest_depth = b->forest_depth;
+    for (int p = 0; p < MLST_PHASE_COUNT; p++)
+        a->phase[p] += b->phase[p];
+}
+
+// Writes the report as one JSON object
+static void write_json(FILE *f, const MlstResult *r, double load, double output) {
+    const MlstStats *s = &r->stats;
+    fprintf(f, "{\"instrumented\": %s, \"leaves\": %d, \"optimal\": %s,\n", s->enabled ? "true" : "false", r->leaves,
+            r->optimal ? "true" : "false");
+
+    // Phases in pipeline order, the caller's load and output around the library's
+    fprintf(f, " \"phases_s\": {");
+    if (load >= 0)
+        fprintf(f, "\"load\": %.9f, ", load);
+    for (int p = 0; p < MLST_PHASE_COUNT; p++)
+        fprintf(f, "%s\"%s\": %.9f", p ? ", " : "", phase_names[p], s->phase[p]);
+    if (output >= 0)
+        fprintf(f, ", \"output\": %.9f", output);
+    fprintf(f, "},\n");
+
+    const MlstExactStats *e = &r->exact;
+    fprintf(f, " \"exact\": {\"nodes\": %lld, \"pruned\": %lld, \"symmetric\": %lld, \"trees\": %lld, "
+               "\"combinations\": %lld, \"connectivity_checks\": %lld, \"edges_tried\": %lld, \"cycles\": %lld, "
+               "\"timed_out\": %s,\n",
+            e->nodes, e->pruned, e->symmetric, e->trees, e->combinations, e->checks, s->edges_tried, s->cycles,
+            e->timed_out ? "true" : "false");
+    fprintf(f, "  \"improvements\": %lld, \"timeline\": [", s->improvements);
+    int shown = s->improvements < MLST_STATS_MAX_IMPROVEMENTS ? (int)s->improvements : MLST_STATS_MAX_IMPROVEMENTS;
+    for (int i = 0; i < shown; i++)
+        fprintf(f, "%s{\"s\": %.9f, \"leaves\": %d}", i ? ", " : "", s->improvement[i].seconds,
+                s->improvement[i].leaves);
+    fprintf(f, "]},\n");
+
+    const MlstApproxStats *a = &r->approx;
+    fprintf(f, " \"approx\": {\"dsu_finds\": %lld, \"dsu_steps\": %lld, \"dsu_longest\": %d, "
+               "\"expand_considered\": %lld, \"expand_accepted\": %lld, \"forest_depth\": %d, "
+               "\"forest_vertices\": %d, \"forest_edges\": %d, \"forest_leaves\": %d, "
+               "\"ls_evaluated\": %lld, \"ls_swaps\": %lld}\n}\n",
+            s->dsu_finds, s->dsu_steps, s->dsu_longest, s->expand_considered, s->expand_accepted, s->forest_depth,
+            a->forest_vertices, a->forest_edges, a->forest_leaves, a->ls_evaluated, a->ls_swaps);
+}
+
+// Writes the report as indented text, leaving out what was not measured
+static void write_text(FILE *f, const MlstResult *r, double load, double output) {
+    const MlstStats *s = &r->stats;
+    fprintf(f, "Statistics%s:\n", s->enabled ? "" : " (counters and timers compiled out; rebuild with make STATS=1)");
+    fprintf(f, "  Phases:");
+    const char *sep = " ";
+    if (load >= 0) {
+        fprintf(f, "%sload %.6f s", sep, load);
+        sep = ", ";
+    }
+    for (int p = 0; p < MLST_PHASE_COUNT; p++) {
+        if (s->phase[p] > 0) {
+            fprintf(f, "%s%s %.6f s", sep, phase_names[p], s->phase[p]);
+            sep = ", ";
+        }
+    }
+    if (output >= 0)
+        fprintf(f, "%soutput %.6f s", sep, output);
+    fprintf(f, "\n");
+
+    const MlstExactStats *e = &r->exact;
+    if (e->nodes || e->trees || e->combinations || s->edges_tried) {
+        fprintf(f, "  Exact search: %lld nodes, %lld pruned, %lld cut by symmetry, %lld trees, %lld connectivity checks\n",
+                e->nodes, e->pruned, e->symmetric, e->trees, e->checks + s->edges_tried);
+        if (s->edges_tried > 0)
+            fprintf(f, "  Edges tried: %lld, %lld rejected for closing a cycle\n", s->edges_tried, s->cycles);
+    }
+    if (s->improvements > 0) {
+        fprintf(f, "  Incumbent: %lld improvements:", s->improvements);
+        int shown = s->improvements < MLST_STATS_MAX_IMPROVEMENTS ? (int)s->improvements : MLST_STATS_MAX_IMPROVEMENTS;
+        for (int i = 0; i < shown; i++)
+            fprintf(f, " %d@%.6fs", s->improvement[i].leaves, s->improvement[i].seconds);
+        fprintf(f, "%s\n", s->improvements > shown ? " ..." : "");
+    }
+    if (s->dsu_finds > 0) {
+        fprintf(f, "  Union-find: %lld finds, %lld steps (%.2f per find, longest %d)\n", s->dsu_finds, s->dsu_steps,
+                (double)s->dsu_steps / s->dsu_finds, s->dsu_longest);
+        fprintf(f, "  Expansion: %lld neighbours considered, %lld accepted, forest depth %d\n", s->expand_considered,
+                s->expand_accepted, s->forest_depth);
+    }
+}
+
+void mlst_write_stats(FILE *f, const MlstResult *r, double load, double output, int json) {
+    if (json)
+        write_json(f, r, load, output);
+    else
+        write_text(f, r, load, output);
+}